@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "AllocStats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef SPINCLUDE_ALLOC_STATS
+
+namespace
+{
+  // Keeps the size in front of each block, 16 keeps malloc's alignment
+  const size_t HEADER_SIZE = 16;
+
+  std::atomic<uint64_t> g_allocations(0);
+  std::atomic<uint64_t> g_frees(0);
+  std::atomic<uint64_t> g_bytes(0);
+  std::atomic<uint64_t> g_liveBytes(0);
+  std::atomic<uint64_t> g_peakLiveBytes(0);
+
+  void* counted_alloc(size_t size)
+  {
+    char* block = static_cast<char*>(malloc(size + HEADER_SIZE));
+    if (!block)
+    {
+      return nullptr;
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    const uint64_t live = g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = g_peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+    return block + HEADER_SIZE;
+  }
+
+  void counted_free(void* ptr)
+  {
+    if (!ptr)
+    {
+      return;
+    }
+    char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+    free(block);
+  }
+
+  void* counted_new(size_t size)
+  {
+    void* ptr = counted_alloc(size ? size : 1);
+    if (!ptr)
+    {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+}
+
+void* operator new(size_t size)
+{
+  return counted_new(size);
+}
+
+void* operator new[](size_t size)
+{
+  return counted_new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return counted_alloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return counted_alloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  counted_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  counted_free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* ptr, size_t) noexcept
+{
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+  counted_free(ptr);
+}
+#endif
+
+bool AllocStats::isEnabled()
+{
+  return true;
+}
+
+void AllocStats::read(Counters& counters)
+{
+  counters.allocations = g_allocations.load(std::memory_order_relaxed);
+  counters.frees = g_frees.load(std::memory_order_relaxed);
+  counters.bytes = g_bytes.load(std::memory_order_relaxed);
+  counters.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+  counters.peakLiveBytes = g_peakLiveBytes.load(std::memory_order_relaxed);
+}
+
+void AllocStats::resetPeak()
+{
+  g_peakLiveBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocStats::isEnabled()
+{
+  return false;
+}
+
+void AllocStats::read(Counters& counters)
+{
+  counters = Counters();
+}
+
+void AllocStats::resetPeak()
+{
+}
+
+#endif
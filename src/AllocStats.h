@@ -0,0 +1,61 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_ALLOCSTATS_H_
+#define SRC_ALLOCSTATS_H_
+
+#include <stdint.h>
+
+/**
+ * Heap accounting through global operator new/delete
+ * Only compiled in with -DSPINCLUDE_ALLOC_STATS (make ALLOC_STATS=1), every
+ * allocation then pays for a few relaxed atomics and a 16 byte header
+ */
+namespace AllocStats
+{
+  struct Counters
+  {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;          // total ever allocated
+    uint64_t liveBytes;
+    uint64_t peakLiveBytes;  // since the last resetPeak()
+  };
+
+  /**
+   * @return true if the counting operator new is compiled in
+   */
+  bool isEnabled();
+
+  /**
+   * Current counters, all 0 when not enabled
+   */
+  void read(Counters& counters);
+
+  /**
+   * Restart peak tracking from the current live bytes
+   */
+  void resetPeak();
+}
+
+#endif /* SRC_ALLOCSTATS_H_ */
@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "BatchRunner.h"
+#include "PathMatcher.h"
+#include "ProjectParser.h"
+#include "TarjanSolver.h"
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+  /// Excludes of one project, glob entries are compiled into a matcher
+  struct ProjectExcludes
+  {
+    set<string> dirs;
+    set<string> files;
+    PathMatcher paths;
+  };
+
+  void split_excludes(const ConfigData& cfgData, ProjectExcludes& output)
+  {
+    ProjectParser::splitExcludes(cfgData.excludedDirs, output.dirs, output.paths);
+    ProjectParser::splitExcludes(cfgData.excludedFiles, output.files, output.paths);
+  }
+
+  /**
+   * Call fn(index) for [0, count) on jobCount threads, items are taken
+   * one at a time since projects differ a lot in size
+   */
+  void run_pool(size_t count, unsigned jobCount, const std::function<void(size_t)>& fn)
+  {
+    std::atomic<size_t> nextIndex(0);
+    auto worker = [&]()
+    {
+      for (size_t index = nextIndex++; index < count; index = nextIndex++)
+      {
+        fn(index);
+      }
+    };
+
+    const size_t threadCount = std::min<size_t>(jobCount, count);
+    vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+      threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  void run_project(const ConfigData& cfgData, const ProjectExcludes& excludes,
+                   const set<string>& dirHeaders, bool scanSources,
+                   ProjectParser::ScanCache& scanCache, BatchRunner::Result& result)
+  {
+    // Shared header list is used as is unless the project adds files
+    set<string> ownExcludedFiles;
+    const set<string>* excludedFiles = &dirHeaders;
+    if (!excludes.files.empty())
+    {
+      ownExcludedFiles = dirHeaders;
+      ownExcludedFiles.insert(excludes.files.begin(), excludes.files.end());
+      excludedFiles = &ownExcludedFiles;
+    }
+
+    Graph headerFileGraph, detailHeaderFileGraph;
+    ProjectParser::HeaderLocationMap headerPathMap;
+    result.parseCode = ProjectParser::parse(cfgData.projDirs, *excludedFiles, headerFileGraph,
+                                            detailHeaderFileGraph, headerPathMap, scanSources,
+                                            nullptr,
+                                            excludes.paths.empty() ? nullptr : &excludes.paths,
+                                            &scanCache);
+    if (result.parseCode < 0)
+    {
+      LOG_ERROR("Critical error code " << result.parseCode << " while parsing " << result.name);
+      return;
+    }
+
+    CompactGraph graph;
+    graph.assign(headerFileGraph);
+    for (unsigned id = 0; id < graph.size(); ++id)
+    {
+      result.sourceCount += ProjectParser::isSourceFile(graph.name(id));
+    }
+    result.headerCount = graph.size() - result.sourceCount;
+
+    TarjanSolver solver(graph);
+    set<set<string> > solution;
+    SccNameCollector collector(solver, solution);
+    result.isSolved = solver.solve(collector);
+    if (!result.isSolved)
+    {
+      LOG_ERROR("Cannot solve " << result.name);
+      return;
+    }
+    CycleBaseline::fromSolution(solution, result.cycles);
+  }
+}
+
+size_t BatchRunner::run(const ConfigFile::SectionList& sections, unsigned jobCount,
+                        bool scanSources, vector<Result>& results)
+{
+  if (jobCount == 0)
+  {
+    jobCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  vector<ProjectExcludes> excludes(sections.size());
+  for (size_t i = 0; i < sections.size(); ++i)
+  {
+    split_excludes(sections[i].second, excludes[i]);
+  }
+
+  // Each exclude dir is indexed once, however many projects name it.
+  // Slots exist before the workers start, each one only fills its own
+  map<string, set<string> > dirHeaders;
+  for (const auto& projectExcludes : excludes)
+  {
+    for (const string& dir : projectExcludes.dirs)
+    {
+      dirHeaders[dir];
+    }
+  }
+  vector<std::pair<const string, set<string> >*> dirSlots;
+  for (auto& dirEntry : dirHeaders)
+  {
+    dirSlots.push_back(&dirEntry);
+  }
+  {
+    Trace::Scope scope("exclude index", "phase");
+    run_pool(dirSlots.size(), jobCount, [&dirSlots](size_t index)
+    {
+      if (0 != ProjectParser::generateHeaderList({dirSlots[index]->first}, dirSlots[index]->second))
+      {
+        LOG_WARN("Error generating excluded files from " << dirSlots[index]->first
+                 << ", ignoring it");
+        dirSlots[index]->second.clear();
+      }
+    });
+  }
+
+  // Projects usually share their exclude dirs, merge each distinct set once
+  map<set<string>, set<string> > mergedHeaders;
+  for (const auto& projectExcludes : excludes)
+  {
+    auto mergedIt = mergedHeaders.find(projectExcludes.dirs);
+    if (mergedIt == mergedHeaders.end())
+    {
+      set<string>& merged = mergedHeaders[projectExcludes.dirs];
+      for (const string& dir : projectExcludes.dirs)
+      {
+        const set<string>& headers = dirHeaders[dir];
+        merged.insert(headers.begin(), headers.end());
+      }
+    }
+  }
+  LOG_DEBUG("Indexed " << dirHeaders.size() << " exclude dirs for " << sections.size()
+            << " projects");
+
+  results.assign(sections.size(), Result());
+  ProjectParser::ScanCache scanCache;
+  std::atomic<size_t> failCount(0);
+  run_pool(sections.size(), jobCount, [&](size_t index)
+  {
+    const auto begin = std::chrono::steady_clock::now();
+    Result& result = results[index];
+    result.name = sections[index].first;
+    {
+      Trace::Scope scope("project", "batch", result.name.c_str());
+      run_project(sections[index].second, excludes[index],
+                  mergedHeaders.find(excludes[index].dirs)->second, scanSources, scanCache,
+                  result);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                   - begin).count();
+    if (!result.isOk())
+    {
+      ++failCount;
+    }
+  });
+  LOG_DEBUG("File scans: " << scanCache.getHitCount() << " shared, "
+            << scanCache.getMissCount() << " read");
+
+  return failCount;
+}
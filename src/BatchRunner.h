@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_BATCHRUNNER_H_
+#define SRC_BATCHRUNNER_H_
+
+#include "ConfigFile.h"
+#include "CycleBaseline.h"
+
+/**
+ * Evaluates many projects of one manifest in a single process, projects
+ * run on a pool of threads sharing the exclude dir index & file scans
+ */
+namespace BatchRunner
+{
+  struct Result
+  {
+    string name;
+    int parseCode;          // ProjectParser::parse return value
+    bool isSolved;
+    size_t headerCount;
+    size_t sourceCount;
+    CycleBaseline::CycleList cycles;
+    double seconds;
+
+    Result(): parseCode(0), isSolved(false), headerCount(0), sourceCount(0), seconds(0) {}
+    bool isOk() const { return parseCode >= 0 && isSolved; }
+  };
+
+  /**
+   * Evaluate every section, results are in section order
+   * @param jobCount    number of threads, 0 for one per core
+   * @return number of failed projects
+   */
+  size_t run(const ConfigFile::SectionList& sections, unsigned jobCount, bool scanSources,
+             vector<Result>& results);
+};
+
+#endif /* SRC_BATCHRUNNER_H_ */
@@ -26,8 +26,9 @@
 #include <dirent.h>
 #include <unistd.h>
 #include <string.h>
-#include <libgen.h>
+#include <limits.h>
 #include <errno.h>
+#include <thread>
 
 static bool g_isDebugMode = false;
 static bool g_isVerboseMode = false;
@@ -66,24 +67,82 @@ bool Common::isFileExist(const string& filePath)
   return S_ISREG(path_stat.st_mode);
 }
 
-const string& Common::getBaseName(const string& path)
+size_t Common::getFileSize(const string& filePath)
 {
-  static string retVal;
-  static char file_path[PATH_MAX];
-  strcpy(file_path, path.c_str());
-  retVal = basename(file_path);
-  return retVal;
+  struct stat path_stat;
+  return (stat(filePath.c_str(), &path_stat) == 0) ? path_stat.st_size : 0;
+}
+
+/**
+ * Path without trailing slashes, a root of slashes stays "/"
+ */
+static string_view trim_trailing_slashes(string_view path)
+{
+  const size_t last = path.find_last_not_of('/');
+  if (string_view::npos == last)
+  {
+    return path.empty() ? path : path.substr(0, 1);
+  }
+  return path.substr(0, last + 1);
+}
+
+string_view Common::getBaseName(string_view path)
+{
+  path = trim_trailing_slashes(path);
+  if (path.empty())
+  {
+    return ".";
+  }
+  else if (path == "/")
+  {
+    return path;
+  }
+
+  const size_t slash = path.rfind('/');
+  return (string_view::npos == slash) ? path : path.substr(slash + 1);
+}
+
+string_view Common::getDirName(string_view path)
+{
+  path = trim_trailing_slashes(path);
+  const size_t slash = path.rfind('/');
+  if (string_view::npos == slash)
+  {
+    return ".";
+  }
+
+  // Slashes between dir & base name go too, unless they're the root
+  const string_view dir = trim_trailing_slashes(path.substr(0, slash + 1));
+  return dir.empty() ? "/" : dir;
 }
 
-const string& Common::getRealPath(const string& path)
+string_view Common::getExtension(string_view path)
 {
-  static string retVal;
-  static char file_path[PATH_MAX];
-  if (nullptr != realpath(path.c_str(), file_path))
+  const string_view baseName = getBaseName(path);
+  const size_t dot = baseName.rfind('.');
+  if (string_view::npos == dot || 0 == dot)
   {
-    retVal = file_path;
+    return string_view();
   }
-  else
+  return baseName.substr(dot);
+}
+
+bool Common::canonicalize(const string& path, string& output)
+{
+  char resolved[PATH_MAX];
+  if (nullptr == realpath(path.c_str(), resolved))
+  {
+    return false;
+  }
+
+  output = resolved;
+  return true;
+}
+
+string Common::getRealPath(const string& path)
+{
+  string retVal;
+  if (!canonicalize(path, retVal))
   {
     LOG_DEBUG("Realpath for " << path << ": " << strerror(errno));
     retVal = path;
@@ -91,13 +150,87 @@ const string& Common::getRealPath(const string& path)
   return retVal;
 }
 
-const string& Common::getDirName(const string& path)
+static bool find_files(const string& dir, const char* suffix, size_t suffixSize,
+                       vector<string>& paths)
 {
-  static string retVal;
-  static char file_path[PATH_MAX];
-  strcpy(file_path, path.c_str());
-  retVal = dirname(file_path);
-  return retVal;
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+  {
+    LOG_ERROR("Cannot open " << dir << ": " << strerror(errno));
+    return false;
+  }
+
+  struct dirent* entry;
+  while ((entry = readdir(d)) != nullptr)
+  {
+    const char* name = entry->d_name;
+    if (0 == strcmp(name, ".") || 0 == strcmp(name, ".."))
+    {
+      continue;
+    }
+
+    const string path = dir + "/" + name;
+    unsigned char type = entry->d_type;
+    if (type == DT_UNKNOWN)
+    {
+      struct stat sb;
+      if (0 == lstat(path.c_str(), &sb))
+      {
+        type = S_ISDIR(sb.st_mode) ? DT_DIR : (S_ISREG(sb.st_mode) ? DT_REG : DT_UNKNOWN);
+      }
+    }
+
+    const size_t nameSize = strlen(name);
+    if (type == DT_DIR)
+    {
+      find_files(path, suffix, suffixSize, paths);
+    }
+    else if (type == DT_REG && nameSize > suffixSize
+             && 0 == strcmp(name + nameSize - suffixSize, suffix))
+    {
+      paths.push_back(path);
+    }
+  }
+  closedir(d);
+  return true;
+}
+
+bool Common::findFiles(const string& dir, const char* suffix, vector<string>& paths)
+{
+  const size_t firstNew = paths.size();
+  if (!find_files(dir, suffix, strlen(suffix), paths))
+  {
+    return false;
+  }
+  std::sort(paths.begin() + firstNew, paths.end());
+  return true;
+}
+
+void Common::parallelFor(size_t count, size_t minChunk,
+                         const std::function<void(size_t, size_t)>& fn)
+{
+  const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  const size_t chunkCount = std::min(threadCount, count / std::max<size_t>(minChunk, 1));
+  if (chunkCount <= 1)
+  {
+    fn(0, count);
+    return;
+  }
+
+  const size_t chunk = (count + chunkCount - 1) / chunkCount;
+  vector<std::thread> threads;
+  for (size_t begin = 0; begin < count; begin += chunk)
+  {
+    const size_t end = std::min(count, begin + chunk);
+    threads.push_back(std::thread([&fn, begin, end]()
+    {
+      fn(begin, end);
+    }));
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
 }
 
 void Common::printSeparatorFd(unsigned level, FILE* fd)
@@ -106,9 +239,28 @@ void Common::printSeparatorFd(unsigned level, FILE* fd)
   static const size_t SEPARATOR_LEN = 80;
 
   level = (level>sizeof(levelChars))? sizeof(levelChars) - 1 : level-1; // don't go over limit
+  Logger::flush(); // queued log lines go first
   fprintf(fd, "%s\n", string(SEPARATOR_LEN, levelChars[level]).c_str());
 }
 
+void Common::printSignal(const char* what, int signo)
+{
+  // Only write(2) is safe here, format the number by hand
+  char number[16];
+  size_t pos = sizeof(number);
+  unsigned value = (signo < 0) ? 0 : (unsigned) signo;
+  number[--pos] = '\n';
+  do
+  {
+    number[--pos] = (char) ('0' + value % 10);
+    value /= 10;
+  } while (value > 0 && pos > 0);
+
+  ssize_t ignored = write(STDERR_FILENO, what, strlen(what));
+  ignored = write(STDERR_FILENO, number + pos, sizeof(number) - pos);
+  (void) ignored;
+}
+
 void Common::printSeparator(unsigned level, bool isVerboseModeOnly)
 {
   if (isVerboseModeOnly && !Common::isVerboseMode())
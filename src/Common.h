@@ -27,40 +27,25 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <string_view>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include "Logger.h"
 
 using std::map;
 using std::set;
 using std::vector;
 using std::string;
+using std::string_view;
 using std::shared_ptr;
 using std::cout;
 using std::endl;
 using std::stringstream;
 
-// print out error message to stderr
-#define LOG_ERROR(msg) \
-    do {if (!Common::isDebugMode()) std::cerr << "[ERROR] " << msg << std::endl;\
-        else std::cerr << __FILE__ << ":" << __LINE__ << "-(" \
-        <<__func__ << ") [ERROR] " << msg << std::endl;\
-    } while(0)
-
-#define LOG_WARN(msg) \
-    do {if (!Common::isDebugMode()) std::cerr << "[WARNING] " << msg << std::endl;\
-        else std::cerr << __FILE__ << ":" << __LINE__ << "-(" \
-        <<__func__ << ") [WARNING] " << msg << std::endl;\
-    } while(0)
-
-#define LOG_DEBUG(msg) \
-    do {if (Common::isDebugMode()) std::cerr << __FILE__ << ":" \
-        << __LINE__ << "-(" <<__func__ << ") [debug] " << msg << std::endl;\
-        else if (Common::isVerboseMode()) std::cout << "[verbose] " << msg << std::endl;\
-    } while(0)
-
 namespace Common
 {
 /**
@@ -84,17 +69,54 @@ bool isDirExist(const string& dirPath);
 bool isFileExist(const string& filePath);
 
 /**
- * Wrappers
+ * Size of file in bytes, 0 if it can't be stat'ed
+ */
+size_t getFileSize(const string& filePath);
+
+/**
+ * Path parts as views into path, same results as basename(3) & dirname(3)
+ * but no copies, no syscalls and safe from any thread
+ * Extension keeps its dot, empty if there's none or it's a dot file
  */
-const string& getBaseName(const string& path);
-const string& getDirName(const string& path);
-const string& getRealPath(const string& path);
+string_view getBaseName(string_view path);
+string_view getDirName(string_view path);
+string_view getExtension(string_view path);
+
+/**
+ * Thread safe realpath(3)
+ * @return false if path can't be resolved, output is left alone then
+ */
+bool canonicalize(const string& path, string& output);
+
+/**
+ * Canonical path, path itself if it can't be resolved
+ */
+string getRealPath(const string& path);
+
+/**
+ * Regular files under dir ending in suffix, recursively, appended sorted
+ * Symlinked dirs aren't followed
+ * @return false if dir can't be read
+ */
+bool findFiles(const string& dir, const char* suffix, vector<string>& paths);
+
+/**
+ * Split [0, count) into chunks of at least minChunk items and run fn(begin, end)
+ * on each chunk, one thread per chunk up to the number of cores
+ * Runs inline when there's only 1 chunk
+ */
+void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& fn);
 
 /**
  * Print out separator, levels can be 1,2
  */
 void printSeparatorFd(unsigned level, FILE* fd);
 void printSeparator(unsigned level = 1, bool isVerboseModeOnly = false);
+
+/**
+ * Write what followed by signo to stderr, async-signal-safe for handlers
+ */
+void printSignal(const char* what, int signo);
 }
 
 #endif /* SRC_COMMON_H_ */
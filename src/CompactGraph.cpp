@@ -0,0 +1,256 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "CompactGraph.h"
+#include <string.h>
+
+CompactGraph::CompactGraph()
+{
+  Graph empty;
+  assign(empty);
+}
+
+CompactGraph::CompactGraph(const Graph& graph)
+{
+  assign(graph);
+}
+
+CompactGraph::~CompactGraph()
+{
+}
+
+void CompactGraph::assign(const Graph& graph)
+{
+  // Graph is sorted by id, only dangling child ids need sorting in
+  vector<string> names;
+  names.reserve(graph.size());
+  for (const Node& node : graph)
+  {
+    names.push_back(node.id);
+  }
+
+  vector<string> danglingNames;
+  for (const Node& node : graph)
+  {
+    for (const string& childId : node.childNodes)
+    {
+      if (graph.end() == graph.find(Node(childId)))
+      {
+        LOG_DEBUG("Created non-existent node " << childId);
+        danglingNames.push_back(childId);
+      }
+    }
+  }
+
+  if (!danglingNames.empty())
+  {
+    std::sort(danglingNames.begin(), danglingNames.end());
+    danglingNames.erase(std::unique(danglingNames.begin(), danglingNames.end()),
+                        danglingNames.end());
+    vector<string> merged;
+    merged.reserve(names.size() + danglingNames.size());
+    std::merge(names.begin(), names.end(), danglingNames.begin(), danglingNames.end(),
+               std::back_inserter(merged));
+    names.swap(merged);
+  }
+
+  // Intern names into one blob
+  mNameStorage.clear();
+  mNameOffsetStorage.clear();
+  mNameOffsetStorage.reserve(names.size());
+  for (const string& name : names)
+  {
+    mNameOffsetStorage.push_back(mNameStorage.size());
+    mNameStorage.insert(mNameStorage.end(), name.begin(), name.end());
+    mNameStorage.push_back('\0');
+  }
+  mNodeCount = names.size();
+
+  // Now lay out child lists, both names and child sets are sorted
+  // so each child list comes out sorted by id
+  mEdgeOffsetStorage.assign(1, 0);
+  mEdgeOffsetStorage.reserve(mNodeCount + 1);
+  mEdgeStorage.clear();
+  mEdgeLineStorage.clear();
+  auto nodeIt = graph.begin();
+  for (const string& name : names)
+  {
+    if (nodeIt != graph.end() && nodeIt->id == name)
+    {
+      for (const string& childId : nodeIt->childNodes)
+      {
+        auto found = std::lower_bound(names.begin(), names.end(), childId);
+        auto lineIt = nodeIt->childLines.find(childId);
+        mEdgeStorage.push_back(found - names.begin());
+        mEdgeLineStorage.push_back(lineIt == nodeIt->childLines.end() ? 0 : lineIt->second);
+      }
+      ++nodeIt;
+    }
+    mEdgeOffsetStorage.push_back(mEdgeStorage.size());
+  }
+
+  mParentOffsetStorage.clear();
+  mParentStorage.clear();
+  attachStorage_();
+}
+
+void CompactGraph::assign(vector<char>& names, vector<unsigned>& nameOffsets,
+                          vector<unsigned>& edgeOffsets, vector<unsigned>& edges)
+{
+  mNameStorage.clear();
+  mNameOffsetStorage.clear();
+  mEdgeOffsetStorage.clear();
+  mEdgeStorage.clear();
+  mNameStorage.swap(names);
+  mNameOffsetStorage.swap(nameOffsets);
+  mEdgeOffsetStorage.swap(edgeOffsets);
+  mEdgeStorage.swap(edges);
+  mEdgeLineStorage.assign(mEdgeStorage.size(), 0);
+  mNodeCount = mNameOffsetStorage.size();
+
+  mParentOffsetStorage.clear();
+  mParentStorage.clear();
+  attachStorage_();
+}
+
+void CompactGraph::attachStorage_()
+{
+  static const char emptyName = '\0';
+  mNames = mNameStorage.empty() ? &emptyName : &mNameStorage[0];
+  mNameOffsets = mNameOffsetStorage.data();
+  mEdgeOffsets = mEdgeOffsetStorage.data();
+  mEdges = mEdgeStorage.data();
+  mEdgeLines = mEdgeLineStorage.data();
+  mParentOffsets = mParentOffsetStorage.empty() ? nullptr : mParentOffsetStorage.data();
+  mParents = mParentStorage.data();
+  mEdgeCount = mEdgeStorage.size();
+  resetEncoded_();
+}
+
+void CompactGraph::attach(size_t nodeCount, const char* names, const unsigned* nameOffsets,
+                          const unsigned* edgeOffsets, const unsigned* edges,
+                          const unsigned* edgeLines, const unsigned* parentOffsets,
+                          const unsigned* parents)
+{
+  // Drop owned storage, views point at the caller's arrays from now on
+  mNameStorage.clear();
+  mNameOffsetStorage.clear();
+  mEdgeOffsetStorage.clear();
+  mEdgeStorage.clear();
+  mEdgeLineStorage.clear();
+  mParentOffsetStorage.clear();
+  mParentStorage.clear();
+
+  mNodeCount = nodeCount;
+  mNames = names;
+  mNameOffsets = nameOffsets;
+  mEdgeOffsets = edgeOffsets;
+  mEdges = edges;
+  mEdgeLines = edgeLines;
+  mParentOffsets = parentOffsets;
+  mParents = parents;
+  mEdgeCount = edgeOffsets ? edgeOffsets[nodeCount] : 0;
+  resetEncoded_();
+}
+
+void CompactGraph::attachEncoded(size_t nodeCount, size_t edgeCount, const char* names,
+                                 const unsigned* nameOffsets,
+                                 const unsigned* edgeByteOffsets, const uint8_t* edgeBytes,
+                                 const unsigned* lineByteOffsets, const uint8_t* lineBytes,
+                                 const unsigned* parentByteOffsets, const uint8_t* parentBytes)
+{
+  attach(nodeCount, names, nameOffsets, nullptr, nullptr, nullptr);
+  mEdgeCount = edgeCount;
+  mIsEncoded = true;
+  mEdgeByteOffsets = edgeByteOffsets;
+  mEdgeBytes = edgeBytes;
+  mLineByteOffsets = lineByteOffsets;
+  mLineBytes = lineBytes;
+  mParentByteOffsets = parentByteOffsets;
+  mParentBytes = parentBytes;
+}
+
+void CompactGraph::resetEncoded_()
+{
+  mIsEncoded = false;
+  mEdgeByteOffsets = mLineByteOffsets = mParentByteOffsets = nullptr;
+  mEdgeBytes = mLineBytes = mParentBytes = nullptr;
+}
+
+bool CompactGraph::findId(const string& name, unsigned& id) const
+{
+  // Names are sorted, so binary search the offset table
+  size_t low = 0, high = mNodeCount;
+  while (low < high)
+  {
+    const size_t mid = low + (high - low) / 2;
+    const int cmp = strcmp(this->name(mid), name.c_str());
+    if (cmp == 0)
+    {
+      id = mid;
+      return true;
+    }
+    else if (cmp < 0)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+
+  return false;
+}
+
+void CompactGraph::generateParents()
+{
+  if (hasParents())
+  {
+    return;
+  }
+
+  // Counting sort of edges by child id
+  mParentOffsetStorage.assign(mNodeCount + 1, 0);
+  for (size_t i = 0; i < edgeCount(); ++i)
+  {
+    ++mParentOffsetStorage[mEdges[i] + 1];
+  }
+  for (size_t id = 0; id < mNodeCount; ++id)
+  {
+    mParentOffsetStorage[id + 1] += mParentOffsetStorage[id];
+  }
+
+  mParentStorage.resize(edgeCount());
+  vector<unsigned> fillPos(mParentOffsetStorage.begin(), mParentOffsetStorage.end() - 1);
+  for (unsigned id = 0; id < mNodeCount; ++id)
+  {
+    for (const unsigned* child = childBegin(id); child != childEnd(id); ++child)
+    {
+      mParentStorage[fillPos[*child]++] = id;
+    }
+  }
+
+  mParentOffsets = mParentOffsetStorage.data();
+  mParents = mParentStorage.data();
+}
@@ -0,0 +1,238 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_COMPACTGRAPH_H_
+#define SRC_COMPACTGRAPH_H_
+
+#include "DataStructure.h"
+#include <cstdint>
+
+/**
+ * Forward walk over one id or line list of a CompactGraph
+ * Lists are plain arrays, or LEB128 varints when the graph is encoded,
+ * where sorted id lists store the gap to the previous id
+ */
+class EdgeCursor
+{
+public:
+  EdgeCursor(const unsigned* begin, const unsigned* end):
+      mPlain(begin), mPlainEnd(end), mBytes(nullptr), mBytesEnd(nullptr),
+      mLast(0), mIsEncoded(false), mIsDelta(false) {}
+  EdgeCursor(const uint8_t* begin, const uint8_t* end, bool isDelta):
+      mPlain(nullptr), mPlainEnd(nullptr), mBytes(begin), mBytesEnd(end),
+      mLast(0), mIsEncoded(true), mIsDelta(isDelta) {}
+
+  /**
+   * Read the next value
+   * @return false at end of list
+   */
+  bool next(unsigned& value)
+  {
+    if (!mIsEncoded)
+    {
+      if (mPlain == mPlainEnd)
+      {
+        return false;
+      }
+      value = *mPlain++;
+      return true;
+    }
+
+    if (mBytes == mBytesEnd)
+    {
+      return false;
+    }
+    unsigned decoded = 0;
+    for (unsigned shift = 0; ; shift += 7)
+    {
+      const uint8_t byte = *mBytes++;
+      decoded |= (unsigned) (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+      {
+        break;
+      }
+    }
+    value = mIsDelta ? mLast + decoded : decoded;
+    mLast = value;
+    return true;
+  }
+
+private:
+  const unsigned* mPlain;
+  const unsigned* mPlainEnd;
+  const uint8_t* mBytes;
+  const uint8_t* mBytesEnd;
+  unsigned mLast;
+  bool mIsEncoded;
+  bool mIsDelta;
+};
+
+/**
+ * Interned, index based copy of a Graph
+ * Node ids are mapped to [0, size()) in sorted name order and child lists
+ * are stored back to back (CSR), so analysis passes walk plain arrays
+ * instead of chasing set<string> lookups
+ */
+class CompactGraph
+{
+public:
+  CompactGraph();
+  CompactGraph(const Graph& graph);
+  virtual ~CompactGraph();
+
+  /**
+   * Rebuild from graph, child ids that don't have their own node
+   * are added as leaf nodes, same as TarjanSolver does
+   */
+  void assign(const Graph& graph);
+
+  /**
+   * Take over prebuilt arrays, same layout as attach(), inputs are left empty
+   * Names must be sorted, child lists sorted and unique. Lines are unknown
+   */
+  void assign(vector<char>& names, vector<unsigned>& nameOffsets,
+              vector<unsigned>& edgeOffsets, vector<unsigned>& edges);
+
+  size_t size() const { return mNodeCount; }
+  size_t edgeCount() const { return mEdgeCount; }
+
+  /**
+   * Name of node id, null terminated
+   */
+  const char* name(unsigned id) const { return mNames + mNameOffsets[id]; }
+
+  /**
+   * Look up id of name
+   * @return true if found
+   */
+  bool findId(const string& name, unsigned& id) const;
+
+  /**
+   * Child ids of node id, sorted ascending, then the include line of each
+   * Parent ids are only valid after generateParents() or when attached
+   * These work on both plain and encoded graphs
+   */
+  EdgeCursor children(unsigned id) const
+  {
+    return mIsEncoded ? EdgeCursor(mEdgeBytes + mEdgeByteOffsets[id], mEdgeBytes + mEdgeByteOffsets[id + 1], true)
+                      : EdgeCursor(childBegin(id), childEnd(id));
+  }
+  EdgeCursor childLines(unsigned id) const
+  {
+    return mIsEncoded ? EdgeCursor(mLineBytes + mLineByteOffsets[id], mLineBytes + mLineByteOffsets[id + 1], false)
+                      : EdgeCursor(childLineBegin(id), childLineBegin(id) + (childEnd(id) - childBegin(id)));
+  }
+  EdgeCursor parents(unsigned id) const
+  {
+    return mIsEncoded ? EdgeCursor(mParentBytes + mParentByteOffsets[id], mParentBytes + mParentByteOffsets[id + 1], true)
+                      : EdgeCursor(parentBegin(id), parentEnd(id));
+  }
+
+  /**
+   * Encoded graphs only have cursors, the array accessors below are
+   * for plain graphs
+   */
+  bool isEncoded() const { return mIsEncoded; }
+
+  /**
+   * Child ids of node id, sorted ascending
+   */
+  const unsigned* childBegin(unsigned id) const { return mEdges + mEdgeOffsets[id]; }
+  const unsigned* childEnd(unsigned id) const { return mEdges + mEdgeOffsets[id + 1]; }
+
+  /**
+   * Include line of each child, parallel to childBegin(), 0 if unknown
+   */
+  const unsigned* childLineBegin(unsigned id) const { return mEdgeLines + mEdgeOffsets[id]; }
+
+  /**
+   * Parent ids of node id, only valid after generateParents()
+   * or when parents are attached
+   */
+  void generateParents();
+  bool hasParents() const { return mParentOffsets != nullptr || mParentByteOffsets != nullptr; }
+  const unsigned* parentBegin(unsigned id) const { return mParents + mParentOffsets[id]; }
+  const unsigned* parentEnd(unsigned id) const { return mParents + mParentOffsets[id + 1]; }
+
+  /**
+   * Use external arrays, e.g. a mapped snapshot, instead of owned storage
+   * Arrays have the same layout as the accessors and must outlive the graph
+   * @param names       null terminated names back to back, sorted
+   * @param nameOffsets nodeCount offsets into names
+   * @param edgeOffsets nodeCount + 1 offsets into edges and edgeLines
+   * @param parentOffsets optional, nodeCount + 1 offsets into parents
+   */
+  void attach(size_t nodeCount, const char* names, const unsigned* nameOffsets,
+              const unsigned* edgeOffsets, const unsigned* edges, const unsigned* edgeLines,
+              const unsigned* parentOffsets = nullptr, const unsigned* parents = nullptr);
+
+  /**
+   * Same as attach(), with varint lists, each list is indexed by
+   * nodeCount + 1 byte offsets into its bytes
+   */
+  void attachEncoded(size_t nodeCount, size_t edgeCount, const char* names, const unsigned* nameOffsets,
+                     const unsigned* edgeByteOffsets, const uint8_t* edgeBytes,
+                     const unsigned* lineByteOffsets, const uint8_t* lineBytes,
+                     const unsigned* parentByteOffsets, const uint8_t* parentBytes);
+
+private:
+  CompactGraph(const CompactGraph&) = delete;
+  CompactGraph& operator=(const CompactGraph&) = delete;
+
+  void attachStorage_();
+  void resetEncoded_();
+
+private:
+  // Views used by all accessors
+  size_t mNodeCount;
+  size_t mEdgeCount;
+  const char* mNames;
+  const unsigned* mNameOffsets;
+  const unsigned* mEdgeOffsets;
+  const unsigned* mEdges;
+  const unsigned* mEdgeLines;
+  const unsigned* mParentOffsets;
+  const unsigned* mParents;
+
+  // Encoded views, used instead of the plain ones when mIsEncoded
+  bool mIsEncoded;
+  const unsigned* mEdgeByteOffsets;
+  const uint8_t* mEdgeBytes;
+  const unsigned* mLineByteOffsets;
+  const uint8_t* mLineBytes;
+  const unsigned* mParentByteOffsets;
+  const uint8_t* mParentBytes;
+
+  // Owned storage backing the views
+  vector<char> mNameStorage;
+  vector<unsigned> mNameOffsetStorage;
+  vector<unsigned> mEdgeOffsetStorage;
+  vector<unsigned> mEdgeStorage;
+  vector<unsigned> mEdgeLineStorage;
+
+  // Reverse edges, built on demand
+  vector<unsigned> mParentOffsetStorage;
+  vector<unsigned> mParentStorage;
+};
+
+#endif /* SRC_COMPACTGRAPH_H_ */
@@ -0,0 +1,165 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Condensation.h"
+#include "SccStream.h"
+
+static const unsigned UNVISITED = ~0u;
+
+Condensation::Condensation(const CompactGraph& graph): mGraph(graph)
+{
+  isSolved = false;
+}
+
+Condensation::~Condensation()
+{
+}
+
+bool Condensation::solve()
+{
+  if (!isSolved)
+  {
+    generateComponents_();
+    generateDagEdges_();
+    isSolved = true;
+  }
+
+  return isSolved;
+}
+
+/**
+ * Lays out streamed sets as components
+ */
+class ComponentCollector: public SccVisitor
+{
+public:
+  ComponentCollector(vector<unsigned>& componentOf, vector<unsigned>& memberOffsets,
+                     vector<unsigned>& members):
+      mComponentOf(componentOf), mMemberOffsets(memberOffsets), mMembers(members) {}
+
+  void visitScc(const unsigned* ids, size_t count)
+  {
+    const unsigned comp = mMemberOffsets.size() - 1;
+    for (size_t i = 0; i < count; ++i)
+    {
+      mComponentOf[ids[i]] = comp;
+    }
+    mMembers.insert(mMembers.end(), ids, ids + count);
+    mMemberOffsets.push_back(mMembers.size());
+  }
+
+private:
+  vector<unsigned>& mComponentOf;
+  vector<unsigned>& mMemberOffsets;
+  vector<unsigned>& mMembers;
+};
+
+void Condensation::generateComponents_()
+{
+  mComponentOf.assign(mGraph.size(), 0);
+  mMemberOffsets.assign(1, 0);
+  mMembers.clear();
+  mMembers.reserve(mGraph.size());
+
+  ComponentCollector collector(mComponentOf, mMemberOffsets, mMembers);
+  SccStream::solve(mGraph, collector);
+}
+
+void Condensation::generateDagEdges_()
+{
+  const size_t compCount = componentCount();
+  vector<unsigned> lastSeen(compCount, UNVISITED);
+
+  mChildOffsets.assign(1, 0);
+  mChildren.clear();
+  mHeights.assign(compCount, 0);
+  mCyclic.assign(compCount, false);
+
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    mCyclic[comp] = memberCount(comp) > 1;
+    lastSeen[comp] = comp; // skip edges inside the component
+
+    for (const unsigned* member = memberBegin(comp); member != memberEnd(comp); ++member)
+    {
+      EdgeCursor children = mGraph.children(*member);
+      unsigned child;
+      while (children.next(child))
+      {
+        const unsigned childComp = mComponentOf[child];
+        if (child == *member)
+        {
+          mCyclic[comp] = true;
+        }
+
+        if (lastSeen[childComp] != comp)
+        {
+          // Children are always finalized first, so their height is known
+          lastSeen[childComp] = comp;
+          mChildren.push_back(childComp);
+          mHeights[comp] = std::max(mHeights[comp], mHeights[childComp] + 1);
+        }
+      }
+    }
+    mChildOffsets.push_back(mChildren.size());
+  }
+
+  // Parents always have higher ids, so walking down finalizes depths in order
+  mDepths.assign(compCount, 0);
+  for (unsigned comp = compCount; comp-- > 0;)
+  {
+    for (const unsigned* child = childBegin(comp); child != childEnd(comp); ++child)
+    {
+      mDepths[*child] = std::max(mDepths[*child], mDepths[comp] + 1);
+    }
+  }
+}
+
+void Condensation::getLevels(bool byDepth, vector<unsigned>& levelOffsets,
+                             vector<unsigned>& levelComps) const
+{
+  const vector<unsigned>& levelOf = byDepth ? mDepths : mHeights;
+  const size_t compCount = componentCount();
+
+  // Counting sort by level
+  levelOffsets.assign(1, 0);
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    if (levelOf[comp] + 2 > levelOffsets.size())
+    {
+      levelOffsets.resize(levelOf[comp] + 2, 0);
+    }
+    ++levelOffsets[levelOf[comp] + 1];
+  }
+  for (size_t level = 1; level < levelOffsets.size(); ++level)
+  {
+    levelOffsets[level] += levelOffsets[level - 1];
+  }
+
+  levelComps.resize(compCount);
+  vector<unsigned> fillPos(levelOffsets.begin(), levelOffsets.end() - 1);
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    levelComps[fillPos[levelOf[comp]]++] = comp;
+  }
+}
@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_CONDENSATION_H_
+#define SRC_CONDENSATION_H_
+
+#include "CompactGraph.h"
+
+/**
+ * Strongly connected components of a CompactGraph collapsed into a DAG
+ * Components are numbered in the order Tarjan finalizes them, so every
+ * DAG edge goes from a higher component id to a lower one, i.e.
+ * ascending id is a reverse topological order
+ */
+class Condensation
+{
+public:
+  Condensation(const CompactGraph& graph);
+  virtual ~Condensation();
+
+  /**
+   * Find components and build DAG edges
+   * @return true on success
+   */
+  bool solve();
+
+  size_t componentCount() const { return mMemberOffsets.size() - 1; }
+  unsigned componentOf(unsigned node) const { return mComponentOf[node]; }
+
+  /**
+   * Node ids inside component
+   */
+  const unsigned* memberBegin(unsigned comp) const { return mMembers.data() + mMemberOffsets[comp]; }
+  const unsigned* memberEnd(unsigned comp) const { return mMembers.data() + mMemberOffsets[comp + 1]; }
+  size_t memberCount(unsigned comp) const { return mMemberOffsets[comp + 1] - mMemberOffsets[comp]; }
+
+  /**
+   * Component is a circle: more than 1 member or a node including itself
+   */
+  bool isCyclic(unsigned comp) const { return mCyclic[comp]; }
+
+  /**
+   * DAG child components, no duplicates and no self edge
+   */
+  const unsigned* childBegin(unsigned comp) const { return mChildren.data() + mChildOffsets[comp]; }
+  const unsigned* childEnd(unsigned comp) const { return mChildren.data() + mChildOffsets[comp + 1]; }
+
+  /**
+   * Longest DAG path from comp down to a sink, components of equal height
+   * never depend on each other
+   */
+  unsigned height(unsigned comp) const { return mHeights[comp]; }
+
+  /**
+   * Longest DAG path from a source down to comp
+   */
+  unsigned depth(unsigned comp) const { return mDepths[comp]; }
+
+  /**
+   * Bucket components by height (sinks first) or by depth (sources first),
+   * components in one level can be processed in parallel once all lower
+   * levels are done
+   * @param levelOffsets Output: level i is levelComps[levelOffsets[i], levelOffsets[i+1])
+   */
+  void getLevels(bool byDepth, vector<unsigned>& levelOffsets, vector<unsigned>& levelComps) const;
+
+  const CompactGraph& graph() const { return mGraph; }
+
+private:
+  void generateComponents_();
+  void generateDagEdges_();
+
+private:
+  const CompactGraph& mGraph;
+  bool isSolved;
+
+  vector<unsigned> mComponentOf;    // node id -> component id
+  vector<unsigned> mMemberOffsets;  // CSR of component -> node ids
+  vector<unsigned> mMembers;
+  vector<unsigned> mChildOffsets;   // CSR of component -> child components
+  vector<unsigned> mChildren;
+  vector<unsigned> mHeights;
+  vector<unsigned> mDepths;
+  vector<bool> mCyclic;
+};
+
+#endif /* SRC_CONDENSATION_H_ */
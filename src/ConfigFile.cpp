@@ -46,10 +46,13 @@ bool ConfigFile::parse()
 
   if (mParseSuccess)
   {
-    const ConfigData defaultData;
-    mData.projDirs = getFromRawData_("PROJECT_DIRS", defaultData.projDirs);
-    mData.excludedDirs = getFromRawData_("EXCLUDE_DIRS", defaultData.excludedDirs);
-    mData.excludedFiles = getFromRawData_("EXCLUDE_FILES", defaultData.excludedFiles);
+    fillData_("", mData);
+    mSections.clear();
+    for (const string& section : mSectionNames)
+    {
+      mSections.push_back(std::make_pair(section, ConfigData()));
+      fillData_(section, mSections.back().second);
+    }
   }
 
   return mParseSuccess;
@@ -60,11 +63,26 @@ const ConfigData& ConfigFile::data() const
   return mData;
 }
 
+const ConfigFile::SectionList& ConfigFile::sections() const
+{
+  return mSections;
+}
+
+void ConfigFile::fillData_(const string& section, ConfigData& output)
+{
+  const ConfigData defaultData;
+  output.projDirs = getFromRawData_(section, "PROJECT_DIRS", defaultData.projDirs);
+  output.excludedDirs = getFromRawData_(section, "EXCLUDE_DIRS", defaultData.excludedDirs);
+  output.excludedFiles = getFromRawData_(section, "EXCLUDE_FILES", defaultData.excludedFiles);
+}
+
 bool ConfigFile::parseRawData_()
 {
   std::ifstream cfgFile(mCfgFilePath);
-  string line;
+  string line, section;
   int lineNumber = 0;
+  mParsedRawData.clear();
+  mSectionNames.clear();
   while (std::getline(cfgFile, line))
   {
     // First rm all spaces
@@ -84,6 +102,29 @@ bool ConfigFile::parseRawData_()
       continue;
     }
 
+    // [name] starts a section
+    if (line[0] == '[')
+    {
+      section = line.substr(1, line.size() - 1);
+      if (line[line.size() - 1] != ']' || section.size() < 2
+          || string::npos != section.find('/'))
+      {
+        LOG_ERROR("Error Parsing " << mCfgFilePath << " line " << lineNumber
+            << " : bad section name");
+        return false;
+      }
+      section.erase(section.size() - 1);
+      if (mParsedRawData.end() != mParsedRawData.find(section))
+      {
+        LOG_ERROR("Error Parsing " << mCfgFilePath << " line " << lineNumber
+            << " : duplicate section " << section);
+        return false;
+      }
+      mParsedRawData[section];
+      mSectionNames.push_back(section);
+      continue;
+    }
+
     // Make sure there's = in line
     auto foundEq = line.find('=');
     if (foundEq == string::npos)
@@ -110,17 +151,23 @@ bool ConfigFile::parseRawData_()
     }
 
     // Finally add to map
-    mParsedRawData[key] = valueSet;
+    mParsedRawData[section][key] = valueSet;
   }
 
   return true;
 }
 
-const set<string>& ConfigFile::getFromRawData_(const string& key, const set<string>& defaultVals)
+const set<string>& ConfigFile::getFromRawData_(const string& section, const string& key,
+    const set<string>& defaultVals)
 {
-  if (mParsedRawData.end() != mParsedRawData.find(key))
+  for (const string& name : {section, string()})
   {
-    return mParsedRawData[key];
+    const auto& rawData = mParsedRawData[name];
+    const auto valuesIt = rawData.find(key);
+    if (rawData.end() != valuesIt)
+    {
+      return valuesIt->second;
+    }
   }
   return defaultVals;
 }
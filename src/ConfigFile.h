@@ -38,6 +38,8 @@ struct ConfigData
 
 /**
  * Project cfg file parser
+ * A batch manifest adds [name] sections, one per project, keys before the
+ * first section are defaults for every section
  */
 class ConfigFile
 {
@@ -56,6 +58,14 @@ public:
    */
   const ConfigData& data() const;
 
+  /// Named sections in file order
+  typedef vector<std::pair<string, ConfigData> > SectionList;
+
+  /**
+   * Get parsed data of each section, empty if file has none
+   */
+  const SectionList& sections() const;
+
 private:
   /**
    * populate mParsedRawData
@@ -63,17 +73,21 @@ private:
   bool parseRawData_();
 
   /**
-   * get data from mParsedRawData
+   * get data of section from mParsedRawData, top level values are
+   * defaults of named sections
    */
-  const set<string>& getFromRawData_(const string& key,
+  const set<string>& getFromRawData_(const string& section, const string& key,
                                     const set<string>& defaultVals);
+  void fillData_(const string& section, ConfigData& output);
 
 private:
   bool mParseSuccess;
   string mCfgFilePath;
   ConfigData mData;
+  SectionList mSections;
 
-  map<string, set<string>> mParsedRawData; // map[cfg item] = set<values>
+  map<string, map<string, set<string>>> mParsedRawData; // map[section][cfg item] = set<values>
+  vector<string> mSectionNames;
 };
 
 #endif /* SRC_CONFIGFILE_H_ */
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "CycleBaseline.h"
+#include <fstream>
+#include <unordered_map>
+
+static const string BASELINE_HEADER = "# spinclude cycle baseline v1";
+
+void CycleBaseline::fromSolution(const set<set<string> >& solution, CycleList& cycles)
+{
+  // Both levels of set<set<string>> are sorted already
+  cycles.clear();
+  for (const auto& oneSet : solution)
+  {
+    if (oneSet.size() > 1)
+    {
+      cycles.push_back(vector<string>(oneSet.begin(), oneSet.end()));
+    }
+  }
+}
+
+bool CycleBaseline::save(const string& filePath, const CycleList& cycles)
+{
+  std::ofstream file(filePath);
+  file << BASELINE_HEADER << "\n";
+  for (const auto& cycle : cycles)
+  {
+    for (size_t i = 0; i < cycle.size(); ++i)
+    {
+      file << (i ? "\t" : "") << cycle[i];
+    }
+    file << "\n";
+  }
+  file.close();
+  return !file.fail();
+}
+
+bool CycleBaseline::load(const string& filePath, CycleList& cycles)
+{
+  cycles.clear();
+  std::ifstream file(filePath);
+  string line;
+  if (!std::getline(file, line) || line != BASELINE_HEADER)
+  {
+    LOG_ERROR(filePath << " is not a cycle baseline");
+    return false;
+  }
+
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+
+    vector<string> cycle;
+    std::istringstream lineSS(line);
+    string member;
+    while (std::getline(lineSS, member, '\t'))
+    {
+      cycle.push_back(member);
+    }
+
+    // Tolerate hand edited files
+    std::sort(cycle.begin(), cycle.end());
+    cycles.push_back(cycle);
+  }
+  std::sort(cycles.begin(), cycles.end());
+
+  return true;
+}
+
+void CycleBaseline::diff(const CycleList& baseline, const CycleList& current, Diff& result)
+{
+  static const size_t NOT_FOUND = ~size_t(0);
+  result = Diff();
+
+  // Intern baseline members: name -> baseline circle
+  std::unordered_map<string, size_t> baselineCycleOf;
+  for (size_t i = 0; i < baseline.size(); ++i)
+  {
+    for (const string& member : baseline[i])
+    {
+      baselineCycleOf[member] = i;
+    }
+  }
+
+  vector<bool> isStillCyclic(baseline.size(), false);
+  for (size_t i = 0; i < current.size(); ++i)
+  {
+    size_t touched = NOT_FOUND;
+    bool isKnown = true, isTouched = false;
+    for (const string& member : current[i])
+    {
+      const auto found = baselineCycleOf.find(member);
+      if (found == baselineCycleOf.end())
+      {
+        isKnown = false;
+        continue;
+      }
+
+      isTouched = true;
+      isStillCyclic[found->second] = true;
+      if (touched != NOT_FOUND && touched != found->second)
+      {
+        // merges 2 known circles
+        isKnown = false;
+      }
+      touched = found->second;
+    }
+
+    if (isKnown)
+    {
+      ++result.knownCount;
+    }
+    else if (isTouched)
+    {
+      result.grownCycles.push_back(i);
+      result.grownFrom.push_back(touched);
+    }
+    else
+    {
+      result.newCycles.push_back(i);
+    }
+  }
+
+  result.fixedCount = std::count(isStillCyclic.begin(), isStillCyclic.end(), false);
+}
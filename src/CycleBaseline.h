@@ -0,0 +1,67 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_CYCLEBASELINE_H_
+#define SRC_CYCLEBASELINE_H_
+
+#include "Common.h"
+
+/**
+ * Stored set of known circles, used to only report regressions
+ * Circles are kept canonical: members sorted, circles sorted
+ */
+namespace CycleBaseline
+{
+  typedef vector<vector<string> > CycleList;
+
+  struct Diff
+  {
+    vector<size_t> newCycles;     // index in current, no member was in a circle before
+    vector<size_t> grownCycles;   // index in current, extends or merges known circles
+    vector<size_t> grownFrom;     // index in baseline of 1 circle each grown one touches
+    size_t knownCount;            // circles same as or smaller than a known one
+    size_t fixedCount;            // known circles with no member in a circle anymore
+
+    Diff(): knownCount(0), fixedCount(0) {}
+    bool hasRegression() const { return !newCycles.empty() || !grownCycles.empty(); }
+  };
+
+  /**
+   * Canonical list from solver output, circles of 1 node are dropped
+   */
+  void fromSolution(const set<set<string> >& solution, CycleList& cycles);
+
+  /**
+   * Text file, 1 circle per line, members separated by tab
+   * @return true on success
+   */
+  bool save(const string& filePath, const CycleList& cycles);
+  bool load(const string& filePath, CycleList& cycles);
+
+  /**
+   * Classify current circles against baseline, linear in total members
+   */
+  void diff(const CycleList& baseline, const CycleList& current, Diff& result);
+};
+
+#endif /* SRC_CYCLEBASELINE_H_ */
@@ -33,6 +33,7 @@ struct Node
 {
   string id; // unique id for the node, can be name or number, etc.
   set<string> childNodes; // set of other node ids that this node can go to
+  map<string, unsigned> childLines; // optional, line where child is included
 
   Node(string _id): id(_id) {}
   const string& toString() const;
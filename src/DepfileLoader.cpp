@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "DepfileLoader.h"
+#include "Trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+  // Depfiles are small, several go to each thread
+  const size_t MIN_CHUNK_FILES = 64;
+
+  bool is_blank(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+  }
+
+  /**
+   * Backslash newline, with an optional \r, joins lines
+   * @return its size at pos, 0 if there's none
+   */
+  size_t continuation_size(const char* pos, const char* end)
+  {
+    if (pos < end && *pos == '\\')
+    {
+      if (pos + 1 < end && pos[1] == '\n')
+      {
+        return 2;
+      }
+      if (pos + 2 < end && pos[1] == '\r' && pos[2] == '\n')
+      {
+        return 3;
+      }
+    }
+    return 0;
+  }
+
+  bool read_file(const string& path, string& content)
+  {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      LOG_DEBUG("Cannot open " << path << ": " << strerror(errno));
+      return false;
+    }
+
+    content.clear();
+    char buffer[16 << 10];
+    ssize_t readSize;
+    while ((readSize = read(fd, buffer, sizeof(buffer))) != 0)
+    {
+      if (readSize < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        LOG_DEBUG("Cannot read " << path << ": " << strerror(errno));
+        close(fd);
+        return false;
+      }
+      content.append(buffer, readSize);
+    }
+    close(fd);
+    return true;
+  }
+
+}
+
+bool DepfileLoader::findDepfiles(const string& dir, vector<string>& paths)
+{
+  return Common::findFiles(dir, ".d", paths);
+}
+
+void DepfileLoader::parse(const char* data, size_t size, GraphBuilder::Part& part)
+{
+  const char* pos = data;
+  const char* const end = data + size;
+  bool isTarget = true;   // before the rule's colon
+  bool hasSource = false;
+  unsigned sourceId = 0;
+  string token;
+
+  while (pos < end)
+  {
+    // Separators: blanks and joined lines, a plain newline ends the rule
+    size_t skip = continuation_size(pos, end);
+    if (skip > 0 || is_blank(*pos))
+    {
+      pos += std::max<size_t>(skip, 1);
+      continue;
+    }
+    if (*pos == '\n')
+    {
+      isTarget = true;
+      hasSource = false;
+      ++pos;
+      continue;
+    }
+    if (*pos == '#')
+    {
+      const char* lineEnd = (const char*) memchr(pos, '\n', end - pos);
+      pos = lineEnd ? lineEnd : end;
+      continue;
+    }
+
+    token.clear();
+    bool isRuleColon = false;
+    while (pos < end && !is_blank(*pos) && *pos != '\n' && 0 == continuation_size(pos, end))
+    {
+      const char c = *pos;
+      if ((c == '\\' && pos + 1 < end && (pos[1] == ' ' || pos[1] == '#'))
+          || (c == '$' && pos + 1 < end && pos[1] == '$'))
+      {
+        // Escaped space & #, $$ is $, other backslashes are part of the name
+        token += pos[1];
+        pos += 2;
+        continue;
+      }
+      else if (c == ':' && isTarget
+               && (pos + 1 == end || is_blank(pos[1]) || pos[1] == '\n'
+                   || continuation_size(pos + 1, end) > 0))
+      {
+        isRuleColon = true;
+        ++pos;
+        break;
+      }
+      token += c;
+      ++pos;
+    }
+
+    if (isTarget)
+    {
+      // Targets are the object files, not part of the graph
+      isTarget = !isRuleColon;
+      continue;
+    }
+    if (token.empty())
+    {
+      continue;
+    }
+
+    const unsigned id = part.intern(GraphBuilder::Token{token.data(), (unsigned) token.size()}, true);
+    if (!hasSource)
+    {
+      sourceId = id;
+      hasSource = true;
+    }
+    else if (id != sourceId)
+    {
+      part.addEdge(sourceId, id);
+    }
+  }
+}
+
+int DepfileLoader::load(const vector<string>& paths, CompactGraph& graph)
+{
+  vector<GraphBuilder::Part> parts;
+  std::mutex partMutex;
+  std::atomic<int> badFileCount(0);
+  Common::parallelFor(paths.size(), MIN_CHUNK_FILES, [&](size_t begin, size_t end)
+  {
+    Trace::Scope scope("load depfiles", "worker");
+    GraphBuilder::Part part;
+    string content;
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (read_file(paths[i], content))
+      {
+        parse(content.data(), content.size(), part);
+      }
+      else
+      {
+        ++badFileCount;
+      }
+    }
+    std::lock_guard<std::mutex> lock(partMutex);
+    parts.push_back(std::move(part));
+  });
+
+  if (badFileCount > 0)
+  {
+    LOG_WARN("Skipped " << badFileCount << " unreadable depfile(s)");
+  }
+  return GraphBuilder::build(parts, graph) ? badFileCount.load() : -1;
+}
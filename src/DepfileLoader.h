@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_DEPFILELOADER_H_
+#define SRC_DEPFILELOADER_H_
+
+#include "GraphBuilder.h"
+
+/**
+ * Reads Make style depfiles written by the compiler (-MD, -MMD) into a
+ * CompactGraph named by full paths, without scanning any source
+ * Each rule's first prerequisite is the translation unit, it gets an edge
+ * to every other prerequisite. A depfile lists all headers a translation
+ * unit pulled in, not who included whom, so headers are leaves and there
+ * are no circles to find, impact, fan-out & closure queries are exact
+ */
+namespace DepfileLoader
+{
+  /**
+   * Files ending in .d under dir, recursively, sorted
+   * @return false if dir can't be read
+   */
+  bool findDepfiles(const string& dir, vector<string>& paths);
+
+  /**
+   * Parse one depfile, handles line continuations, escaped spaces & #,
+   * $$, comments and -MP phony rules
+   */
+  void parse(const char* data, size_t size, GraphBuilder::Part& part);
+
+  /**
+   * Parse depfiles on all cores into graph, duplicates are merged
+   * @return number of depfiles that couldn't be read, <0 on error
+   */
+  int load(const vector<string>& paths, CompactGraph& graph);
+};
+
+#endif /* SRC_DEPFILELOADER_H_ */
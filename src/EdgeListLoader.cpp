@@ -0,0 +1,327 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "EdgeListLoader.h"
+#include "GraphBuilder.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <cstring>
+#include <cstdint>
+#include <mutex>
+
+namespace
+{
+  /// Bytes per parser thread at least, smaller inputs are parsed inline
+  const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+  // Nodes without edges take no line, so a problem line may declare more
+  // nodes than the input has bytes, but not unboundedly more
+  const unsigned long MIN_DIMACS_NODE_LIMIT = 1 << 16;
+  const unsigned long MAX_DIMACS_NODES_PER_BYTE = 16;
+
+  typedef GraphBuilder::Token Token;
+
+  bool isBlank(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+  }
+
+  /**
+   * Next whitespace separated token of [pos, lineEnd), pos moves past it
+   * @return false at end of line
+   */
+  bool nextToken(const char*& pos, const char* lineEnd, Token& token)
+  {
+    while (pos < lineEnd && isBlank(*pos))
+    {
+      ++pos;
+    }
+    if (pos == lineEnd)
+    {
+      return false;
+    }
+
+    token.data = pos;
+    while (pos < lineEnd && !isBlank(*pos))
+    {
+      ++pos;
+    }
+    token.size = pos - token.data;
+    return true;
+  }
+
+  const char* findLineEnd(const char* pos, const char* end)
+  {
+    const char* lineEnd = (const char*) memchr(pos, '\n', end - pos);
+    return lineEnd ? lineEnd : end;
+  }
+
+  bool isUnsigned(const Token& token)
+  {
+    for (unsigned i = 0; i < token.size; ++i)
+    {
+      if (token.data[i] < '0' || token.data[i] > '9')
+      {
+        return false;
+      }
+    }
+    return token.size > 0;
+  }
+
+  /**
+   * Rest of a DIMACS problem line after its p, {type} {nodes} {edges}
+   * with a known graph problem type and numeric counts
+   * @return false if it's something else, e.g. an adjacency line of node p
+   */
+  bool parseProblemLine(const char* pos, const char* lineEnd, unsigned long& nodeCount)
+  {
+    static const char* const TYPES[] = {"sp", "max", "min", "asn", "edge", "col"};
+    Token type, nodes, edges, extra;
+    if (!nextToken(pos, lineEnd, type) || !nextToken(pos, lineEnd, nodes)
+        || !nextToken(pos, lineEnd, edges) || nextToken(pos, lineEnd, extra)
+        || !isUnsigned(nodes) || !isUnsigned(edges)
+        || std::none_of(std::begin(TYPES), std::end(TYPES),
+                        [&type](const char* name) { return type.is(name); }))
+    {
+      return false;
+    }
+    nodeCount = strtoul(string(nodes.data, nodes.size).c_str(), nullptr, 10);
+    return true;
+  }
+
+  /**
+   * Parse lines starting in [begin, end) of data
+   * A line crossing end belongs to this chunk, the next chunk skips it
+   */
+  void parseChunk(const char* data, size_t size, size_t begin, size_t end,
+                  EdgeListLoader::Format format, GraphBuilder::Part& part, size_t& badLineCount)
+  {
+    const char* const dataEnd = data + size;
+    const char* pos = data + begin;
+    if (begin > 0 && data[begin - 1] != '\n')
+    {
+      pos = findLineEnd(pos, dataEnd);
+      if (pos == dataEnd)
+      {
+        return;
+      }
+      ++pos;
+    }
+
+    auto intern = [&](const Token& token) { return part.intern(token); };
+
+    for (; pos < data + end; ++pos)
+    {
+      const char* lineEnd = findLineEnd(pos, dataEnd);
+      Token token, from, to;
+      if (!nextToken(pos, lineEnd, token))
+      {
+        pos = lineEnd;
+        continue;
+      }
+
+      switch (format)
+      {
+      case EdgeListLoader::FORMAT_SNAP:
+        if (token.data[0] == '#')
+        {
+          break;
+        }
+        // a lone node or the first 2 columns of an edge
+        // fall through
+      case EdgeListLoader::FORMAT_ADJACENCY:
+      {
+        const unsigned fromId = intern(token);
+        while (nextToken(pos, lineEnd, to))
+        {
+          part.addEdge(fromId, intern(to));
+          if (format == EdgeListLoader::FORMAT_SNAP)
+          {
+            break;
+          }
+        }
+        break;
+      }
+      case EdgeListLoader::FORMAT_DIMACS:
+        if ((token.is("a") || token.is("e"))
+            && nextToken(pos, lineEnd, from) && nextToken(pos, lineEnd, to))
+        {
+          const unsigned fromId = intern(from), toId = intern(to);
+          part.addEdge(fromId, toId);
+          if (token.is("e"))
+          {
+            part.addEdge(toId, fromId);
+          }
+        }
+        else if (!token.is("c") && !token.is("p"))
+        {
+          ++badLineCount;
+        }
+        break;
+      default:
+        break;
+      }
+
+      pos = lineEnd;
+    }
+  }
+
+  /**
+   * Node count of the DIMACS problem line, p {type} {nodes} {edges}
+   * @return false if there's no problem line before the first edge
+   */
+  bool getDimacsNodeCount(const char* data, size_t size, unsigned long& nodeCount)
+  {
+    const char* const dataEnd = data + size;
+    for (const char* pos = data; pos < dataEnd; ++pos)
+    {
+      const char* lineEnd = findLineEnd(pos, dataEnd);
+      Token token;
+      if (nextToken(pos, lineEnd, token))
+      {
+        if (token.is("p"))
+        {
+          return parseProblemLine(pos, lineEnd, nodeCount);
+        }
+        else if (!token.is("c"))
+        {
+          return false;
+        }
+      }
+      pos = lineEnd;
+    }
+    return false;
+  }
+}
+
+bool EdgeListLoader::parseFormat(const string& name, Format& format)
+{
+  static const map<string, Format> FORMAT_NAMES =
+  {
+    {"auto", FORMAT_AUTO}, {"adj", FORMAT_ADJACENCY}, {"snap", FORMAT_SNAP}, {"dimacs", FORMAT_DIMACS}
+  };
+
+  const auto formatIt = FORMAT_NAMES.find(name);
+  if (formatIt == FORMAT_NAMES.end())
+  {
+    return false;
+  }
+  format = formatIt->second;
+  return true;
+}
+
+EdgeListLoader::Format EdgeListLoader::detectFormat(const char* data, size_t size)
+{
+  const char* const dataEnd = data + size;
+  for (const char* pos = data; pos < dataEnd; ++pos)
+  {
+    const char* lineEnd = findLineEnd(pos, dataEnd);
+    Token token;
+    if (nextToken(pos, lineEnd, token))
+    {
+      if (token.data[0] == '#')
+      {
+        return FORMAT_SNAP;
+      }
+      else if (token.is("p"))
+      {
+        // Anything but a real problem line is an adjacency line of node p
+        unsigned long nodeCount;
+        return parseProblemLine(pos, lineEnd, nodeCount) ? FORMAT_DIMACS : FORMAT_ADJACENCY;
+      }
+      else if (!token.is("c"))
+      {
+        return FORMAT_ADJACENCY;
+      }
+    }
+    pos = lineEnd;
+  }
+  return FORMAT_ADJACENCY;
+}
+
+bool EdgeListLoader::load(const string& filePath, CompactGraph& graph, Format format)
+{
+  MappedFile file;
+  if (!file.open(filePath, true))
+  {
+    return false;
+  }
+  return load(file.data(), file.size(), graph, format);
+}
+
+bool EdgeListLoader::load(const char* data, size_t size, CompactGraph& graph, Format format)
+{
+  if (format == FORMAT_AUTO)
+  {
+    format = detectFormat(data, size);
+  }
+
+  // DIMACS nodes without edges exist too, they're named 1..n
+  vector<string> dimacsNames;
+  GraphBuilder::Part dimacsPart;
+  if (format == FORMAT_DIMACS)
+  {
+    unsigned long nodeCount = 0;
+    if (!getDimacsNodeCount(data, size, nodeCount))
+    {
+      LOG_WARN("No DIMACS problem line, only nodes with edges are loaded");
+    }
+    const unsigned long nodeLimit = std::max(MIN_DIMACS_NODE_LIMIT, MAX_DIMACS_NODES_PER_BYTE * size);
+    if (nodeCount > UINT32_MAX || nodeCount > nodeLimit)
+    {
+      LOG_ERROR("Malformed DIMACS problem line, " << nodeCount << " nodes in " << size << " bytes");
+      return false;
+    }
+    dimacsNames.resize(nodeCount);
+    for (unsigned long i = 0; i < nodeCount; ++i)
+    {
+      dimacsNames[i] = std::to_string(i + 1);
+      dimacsPart.intern(Token{dimacsNames[i].data(), (unsigned) dimacsNames[i].size()});
+    }
+  }
+
+  // Tokenize and intern locally, one part per thread
+  vector<GraphBuilder::Part> parts;
+  size_t badLineCount = 0;
+  std::mutex partMutex;
+  Common::parallelFor(size, MIN_CHUNK_BYTES, [&](size_t begin, size_t end)
+  {
+    Trace::Scope scope("parse edges", "worker");
+    GraphBuilder::Part part;
+    size_t partBadLineCount = 0;
+    parseChunk(data, size, begin, end, format, part, partBadLineCount);
+    std::lock_guard<std::mutex> lock(partMutex);
+    parts.push_back(std::move(part));
+    badLineCount += partBadLineCount;
+  });
+  if (dimacsPart.nameCount() > 0)
+  {
+    parts.push_back(std::move(dimacsPart));
+  }
+
+  if (badLineCount > 0)
+  {
+    LOG_WARN("Skipped " << badLineCount << " malformed line(s)");
+  }
+  return GraphBuilder::build(parts, graph);
+}
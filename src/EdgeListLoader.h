@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_EDGELISTLOADER_H_
+#define SRC_EDGELISTLOADER_H_
+
+#include "CompactGraph.h"
+
+/**
+ * Fast loader of plain text graphs straight into a CompactGraph
+ * The file is mapped, split at line boundaries and tokenized by all cores,
+ * names are interned without building a Graph first
+ */
+namespace EdgeListLoader
+{
+  enum Format
+  {
+    FORMAT_AUTO = 0,
+    FORMAT_ADJACENCY,   ///< node child1 child2 ... per line
+    FORMAT_SNAP,        ///< from to per line, # comments and extra columns ignored
+    FORMAT_DIMACS       ///< c, p, a and e lines, e lines are undirected
+  };
+
+  /**
+   * Format from its option name: auto, adj, snap or dimacs
+   * @return true if name is known
+   */
+  bool parseFormat(const string& name, Format& format);
+
+  /**
+   * Guess format from the first lines of data
+   * SNAP files start with # comments, DIMACS files with c lines and a
+   * p {sp|max|min|asn|edge|col} {nodes} {edges} problem line, anything
+   * else is read as adjacency lines
+   */
+  Format detectFormat(const char* data, size_t size);
+
+  /**
+   * Load filePath, or an in memory buffer, into graph
+   * Nodes are named by their tokens, DIMACS nodes 1..n all exist
+   * @return true on success, lines that don't fit format are skipped,
+   * false if a DIMACS problem line declares more nodes than the input could hold
+   */
+  bool load(const string& filePath, CompactGraph& graph, Format format = FORMAT_AUTO);
+  bool load(const char* data, size_t size, CompactGraph& graph, Format format = FORMAT_AUTO);
+};
+
+#endif /* SRC_EDGELISTLOADER_H_ */
@@ -0,0 +1,196 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "FanoutReport.h"
+#include "Trace.h"
+
+// Fewer components than this per thread aren't worth a thread spawn
+static const size_t PARALLEL_MIN_CHUNK = 256;
+
+FanoutReport::FanoutReport(const Condensation& dag, const vector<bool>& isSource,
+                           const vector<uint64_t>& nodeBytes, size_t memoryBudget):
+    mDag(dag), mIsSource(isSource), mNodeBytes(nodeBytes), mMemoryBudget(memoryBudget)
+{
+  isSolved = false;
+}
+
+FanoutReport::~FanoutReport()
+{
+}
+
+bool FanoutReport::solve()
+{
+  if (isSolved)
+  {
+    return isSolved;
+  }
+
+  const CompactGraph& graph = mDag.graph();
+  const size_t compCount = mDag.componentCount();
+  if (mIsSource.size() != graph.size() || mNodeBytes.size() != graph.size())
+  {
+    LOG_ERROR("Node info doesn't match graph size " << graph.size());
+    return false;
+  }
+
+  // Columns and component sizes
+  mColumnComps.clear();
+  mCompBytes.assign(compCount, 0);
+  for (unsigned node = 0; node < graph.size(); ++node)
+  {
+    mCompBytes[mDag.componentOf(node)] += mNodeBytes[node];
+    if (mIsSource[node])
+    {
+      mColumnComps.push_back(mDag.componentOf(node));
+    }
+  }
+
+  // Reverse the DAG edges
+  mParentOffsets.assign(compCount + 1, 0);
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    for (const unsigned* child = mDag.childBegin(comp); child != mDag.childEnd(comp); ++child)
+    {
+      ++mParentOffsets[*child + 1];
+    }
+  }
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    mParentOffsets[comp + 1] += mParentOffsets[comp];
+  }
+  mParents.resize(mParentOffsets[compCount]);
+  vector<unsigned> fillPos(mParentOffsets.begin(), mParentOffsets.end() - 1);
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    for (const unsigned* child = mDag.childBegin(comp); child != mDag.childEnd(comp); ++child)
+    {
+      mParents[fillPos[*child]++] = comp;
+    }
+  }
+  mDag.getLevels(true, mLevelOffsets, mLevelComps);
+
+  // Pick the widest column block that fits the budget
+  const size_t totalWords = (mColumnComps.size() + 63) / 64;
+  const size_t budgetWords = mMemoryBudget / (sizeof(uint64_t) * std::max<size_t>(compCount, 1));
+  const size_t blockWords = std::max<size_t>(1, std::min(totalWords, budgetWords));
+
+  mCompTuCount.assign(compCount, 0);
+  mCompRebuildBytes.assign(compCount, 0);
+  for (size_t firstWord = 0; firstWord < totalWords; firstWord += blockWords)
+  {
+    solveBlock_(firstWord * 64, std::min(blockWords, totalWords - firstWord));
+  }
+  mRows.clear();
+  mRows.shrink_to_fit();
+
+  // Scores for everything that isn't a translation unit
+  mScores.clear();
+  for (unsigned node = 0; node < graph.size(); ++node)
+  {
+    if (!mIsSource[node])
+    {
+      Score score;
+      score.node = node;
+      score.tuCount = mCompTuCount[mDag.componentOf(node)];
+      score.rebuildBytes = mCompRebuildBytes[mDag.componentOf(node)];
+      mScores.push_back(score);
+    }
+  }
+  std::stable_sort(mScores.begin(), mScores.end(), [](const Score& a, const Score& b)
+  {
+    return a.tuCount != b.tuCount ? a.tuCount > b.tuCount : a.rebuildBytes > b.rebuildBytes;
+  });
+
+  isSolved = true;
+  return isSolved;
+}
+
+void FanoutReport::solveBlock_(size_t firstColumn, size_t wordCount)
+{
+  const size_t compCount = mDag.componentCount();
+  const size_t columnCount = std::min(mColumnComps.size() - firstColumn, wordCount * 64);
+  mRows.assign(compCount * wordCount, 0);
+
+  // Seed each translation unit's own bit
+  for (size_t column = 0; column < columnCount; ++column)
+  {
+    mRows[mColumnComps[firstColumn + column] * wordCount + column / 64] |=
+        uint64_t(1) << (column % 64);
+  }
+
+  // Union parent rows, parents always sit on a lower depth level
+  for (size_t level = 0; level + 1 < mLevelOffsets.size(); ++level)
+  {
+    const unsigned* levelBegin = mLevelComps.data() + mLevelOffsets[level];
+    Common::parallelFor(mLevelOffsets[level + 1] - mLevelOffsets[level], PARALLEL_MIN_CHUNK,
+        [this, levelBegin, wordCount](size_t begin, size_t end)
+        {
+          Trace::Scope scope("fanout level", "worker");
+          for (const unsigned* comp = levelBegin + begin; comp != levelBegin + end; ++comp)
+          {
+            uint64_t* row = mRows.data() + *comp * wordCount;
+            for (unsigned i = mParentOffsets[*comp]; i < mParentOffsets[*comp + 1]; ++i)
+            {
+              const uint64_t* parentRow = mRows.data() + mParents[i] * wordCount;
+              for (size_t word = 0; word < wordCount; ++word)
+              {
+                row[word] |= parentRow[word];
+              }
+            }
+          }
+        });
+  }
+
+  // Bytes each translation unit of the block parses
+  vector<uint64_t> tuBytes(wordCount * 64, 0);
+  for (unsigned comp = 0; comp < compCount; ++comp)
+  {
+    const uint64_t* row = mRows.data() + comp * wordCount;
+    for (size_t word = 0; word < wordCount; ++word)
+    {
+      for (uint64_t bits = row[word]; bits; bits &= bits - 1)
+      {
+        tuBytes[word * 64 + __builtin_ctzll(bits)] += mCompBytes[comp];
+      }
+    }
+  }
+
+  // Then each component's share of those
+  Common::parallelFor(compCount, PARALLEL_MIN_CHUNK,
+      [this, wordCount, &tuBytes](size_t begin, size_t end)
+      {
+        Trace::Scope scope("fanout bytes", "worker");
+        for (size_t comp = begin; comp < end; ++comp)
+        {
+          const uint64_t* row = mRows.data() + comp * wordCount;
+          for (size_t word = 0; word < wordCount; ++word)
+          {
+            mCompTuCount[comp] += __builtin_popcountll(row[word]);
+            for (uint64_t bits = row[word]; bits; bits &= bits - 1)
+            {
+              mCompRebuildBytes[comp] += tuBytes[word * 64 + __builtin_ctzll(bits)];
+            }
+          }
+        }
+      });
+}
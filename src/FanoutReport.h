@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_FANOUTREPORT_H_
+#define SRC_FANOUTREPORT_H_
+
+#include "Condensation.h"
+#include <stdint.h>
+
+/**
+ * Rebuild fan-out of every node: how many translation units pull it in
+ * transitively, and how many bytes those translation units parse in total
+ *
+ * Sets of reaching translation units are unioned down the condensation DAG
+ * as bitsets, one depth level at a time in parallel. To keep memory bounded
+ * the translation units are processed in column blocks that fit the budget
+ */
+class FanoutReport
+{
+public:
+  static const size_t DEFAULT_MEMORY_BUDGET = 256u << 20;
+
+  struct Score
+  {
+    unsigned node;
+    size_t tuCount;          // translation units including node
+    uint64_t rebuildBytes;   // bytes those translation units parse
+
+    Score(): node(0), tuCount(0), rebuildBytes(0) {}
+  };
+
+  /**
+   * @param isSource  node id -> node is a translation unit
+   * @param nodeBytes node id -> file size
+   */
+  FanoutReport(const Condensation& dag, const vector<bool>& isSource,
+               const vector<uint64_t>& nodeBytes, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+  virtual ~FanoutReport();
+
+  /**
+   * Run the DP, dag must be solved
+   * @return true on success
+   */
+  bool solve();
+
+  /**
+   * Scores of all non translation unit nodes, highest fan-out first
+   */
+  const vector<Score>& getScores() const { return mScores; }
+
+private:
+  void solveBlock_(size_t firstColumn, size_t wordCount);
+
+private:
+  const Condensation& mDag;
+  const vector<bool>& mIsSource;
+  const vector<uint64_t>& mNodeBytes;
+  size_t mMemoryBudget;
+  bool isSolved;
+
+  vector<unsigned> mColumnComps;   // translation unit column -> component
+  vector<uint64_t> mCompBytes;     // component -> bytes of its members
+  vector<unsigned> mParentOffsets; // CSR of component -> parent components
+  vector<unsigned> mParents;
+  vector<unsigned> mLevelOffsets;  // components by depth, sources first
+  vector<unsigned> mLevelComps;
+
+  vector<size_t> mCompTuCount;
+  vector<uint64_t> mCompRebuildBytes;
+  vector<uint64_t> mRows;          // scratch for one column block
+
+  vector<Score> mScores;
+};
+
+#endif /* SRC_FANOUTREPORT_H_ */
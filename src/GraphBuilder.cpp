@@ -0,0 +1,309 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "GraphBuilder.h"
+#include "Trace.h"
+#include <cstdint>
+
+namespace
+{
+  const size_t MIN_SORT_CHUNK = 4096;
+  const size_t NAME_BLOCK_SIZE = 64 << 10;
+
+  uint64_t getHash(const char* data, size_t size)
+  {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+      hash = (hash ^ (unsigned char) data[i]) * 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  typedef GraphBuilder::Token Token;
+
+  /**
+   * Merge 2 sorted runs of unique names, dropping duplicates
+   */
+  void mergeNames(const vector<Token>& left, const vector<Token>& right, vector<Token>& output)
+  {
+    output.clear();
+    output.reserve(left.size() + right.size());
+    std::set_union(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(output));
+  }
+}
+
+GraphBuilder::Part::Part(): mSlots(1024), mMask(1023), mBlockPos(nullptr), mBlockLeft(0)
+{
+}
+
+unsigned GraphBuilder::Part::intern(const Token& name, bool isCopied)
+{
+  // Names up to 8 bytes, e.g. numeric ids, are kept in the slot itself
+  // so a lookup touches the table only, not the input
+  const uint64_t key = getKey_(name);
+  for (size_t i = getHash_(key, name) & mMask; ; i = (i + 1) & mMask)
+  {
+    Slot& slot = mSlots[i];
+    if (slot.id == 0)
+    {
+      mNames.push_back(isCopied ? Token{copy_(name), name.size} : name);
+      slot.key = key;
+      slot.size = name.size;
+      slot.id = mNames.size();
+      if (mNames.size() * 2 > mSlots.size())
+      {
+        grow_();
+      }
+      return mNames.size() - 1;
+    }
+    if (slot.key == key && slot.size == name.size
+        && (name.size <= sizeof(key) || mNames[slot.id - 1] == name))
+    {
+      return slot.id - 1;
+    }
+  }
+}
+
+uint64_t GraphBuilder::Part::getKey_(const Token& token)
+{
+  uint64_t key = 0;
+  if (token.size <= sizeof(key))
+  {
+    memcpy(&key, token.data, token.size);
+    return key;
+  }
+  return getHash(token.data, token.size);
+}
+
+uint64_t GraphBuilder::Part::getHash_(uint64_t key, const Token& token)
+{
+  return token.size <= sizeof(key) ? getHash((const char*) &key, sizeof(key)) : key;
+}
+
+void GraphBuilder::Part::grow_()
+{
+  vector<Slot> slots(mSlots.size() * 2);
+  mMask = slots.size() - 1;
+  for (const Slot& slot : mSlots)
+  {
+    if (slot.id != 0)
+    {
+      size_t i = getHash_(slot.key, mNames[slot.id - 1]) & mMask;
+      while (slots[i].id != 0)
+      {
+        i = (i + 1) & mMask;
+      }
+      slots[i] = slot;
+    }
+  }
+  mSlots.swap(slots);
+}
+
+const char* GraphBuilder::Part::copy_(const Token& token)
+{
+  if (token.size > mBlockLeft)
+  {
+    const size_t blockSize = std::max<size_t>(NAME_BLOCK_SIZE, token.size);
+    mBlocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+    mBlockPos = mBlocks.back().get();
+    mBlockLeft = blockSize;
+  }
+
+  char* copy = mBlockPos;
+  memcpy(copy, token.data, token.size);
+  mBlockPos += token.size;
+  mBlockLeft -= token.size;
+  return copy;
+}
+
+bool GraphBuilder::build(vector<Part>& parts, CompactGraph& graph)
+{
+  // Sort local names, then merge them pairwise into the global name list
+  vector<vector<unsigned> > sortedIds(parts.size());
+  vector<vector<Token> > runs(parts.size());
+  Common::parallelFor(parts.size(), 1, [&](size_t begin, size_t end)
+  {
+    Trace::Scope scope("sort names", "worker");
+    for (size_t i = begin; i < end; ++i)
+    {
+      const vector<Token>& partNames = parts[i].mNames;
+      sortedIds[i].resize(partNames.size());
+      for (unsigned localId = 0; localId < partNames.size(); ++localId)
+      {
+        sortedIds[i][localId] = localId;
+      }
+      std::sort(sortedIds[i].begin(), sortedIds[i].end(), [&](unsigned left, unsigned right)
+      {
+        return partNames[left] < partNames[right];
+      });
+      runs[i].reserve(partNames.size());
+      for (const unsigned localId : sortedIds[i])
+      {
+        runs[i].push_back(partNames[localId]);
+      }
+    }
+  });
+
+  while (runs.size() > 1)
+  {
+    vector<vector<Token> > mergedRuns((runs.size() + 1) / 2);
+    Common::parallelFor(mergedRuns.size(), 1, [&](size_t begin, size_t end)
+    {
+      Trace::Scope scope("merge names", "worker");
+      for (size_t i = begin; i < end; ++i)
+      {
+        if (2 * i + 1 < runs.size())
+        {
+          mergeNames(runs[2 * i], runs[2 * i + 1], mergedRuns[i]);
+        }
+        else
+        {
+          mergedRuns[i].swap(runs[2 * i]);
+        }
+      }
+    });
+    runs.swap(mergedRuns);
+  }
+  vector<Token> names;
+  if (!runs.empty())
+  {
+    names.swap(runs[0]);
+  }
+
+  size_t edgeCount = 0;
+  for (const Part& part : parts)
+  {
+    edgeCount += part.edgeCount();
+  }
+  if (names.size() >= UINT32_MAX || edgeCount >= UINT32_MAX)
+  {
+    LOG_ERROR("Graph of " << names.size() << " nodes, " << edgeCount << " edges is too big");
+    return false;
+  }
+
+  // Both lists are sorted, so global ids are found by galloping forward
+  vector<vector<unsigned> > globalIds(parts.size());
+  Common::parallelFor(parts.size(), 1, [&](size_t begin, size_t end)
+  {
+    Trace::Scope scope("map ids", "worker");
+    for (size_t i = begin; i < end; ++i)
+    {
+      const Part& part = parts[i];
+      globalIds[i].resize(part.mNames.size());
+      auto globalIt = names.begin();
+      for (const unsigned localId : sortedIds[i])
+      {
+        const Token& name = part.mNames[localId];
+        size_t step = 1;
+        auto boundIt = globalIt;
+        while (names.end() - boundIt > (ptrdiff_t) step && *(boundIt + step) < name)
+        {
+          boundIt += step;
+          step *= 2;
+        }
+        const auto limitIt = names.end() - boundIt > (ptrdiff_t) step ? boundIt + step + 1 : names.end();
+        globalIt = std::lower_bound(boundIt, limitIt, name);
+        globalIds[i][localId] = globalIt - names.begin();
+      }
+      vector<unsigned>().swap(sortedIds[i]);
+    }
+  });
+
+  // Counting sort of edges by source, then sort and dedup each child list
+  const size_t nodeCount = names.size();
+  vector<unsigned> edgeOffsets(nodeCount + 1, 0);
+  for (size_t part = 0; part < parts.size(); ++part)
+  {
+    const vector<unsigned>& partEdges = parts[part].mEdges;
+    for (size_t i = 0; i < partEdges.size(); i += 2)
+    {
+      ++edgeOffsets[globalIds[part][partEdges[i]] + 1];
+    }
+  }
+  for (size_t id = 0; id < nodeCount; ++id)
+  {
+    edgeOffsets[id + 1] += edgeOffsets[id];
+  }
+
+  vector<unsigned> edges(edgeCount);
+  {
+    vector<unsigned> fillPos(edgeOffsets.begin(), edgeOffsets.end() - 1);
+    for (size_t part = 0; part < parts.size(); ++part)
+    {
+      vector<unsigned>& partEdges = parts[part].mEdges;
+      for (size_t i = 0; i < partEdges.size(); i += 2)
+      {
+        edges[fillPos[globalIds[part][partEdges[i]]]++] = globalIds[part][partEdges[i + 1]];
+      }
+      vector<unsigned>().swap(partEdges);
+    }
+  }
+
+  vector<unsigned> uniqueCounts(nodeCount);
+  Common::parallelFor(nodeCount, MIN_SORT_CHUNK, [&](size_t begin, size_t end)
+  {
+    Trace::Scope scope("sort edges", "worker");
+    for (size_t id = begin; id < end; ++id)
+    {
+      unsigned* childBegin = edges.data() + edgeOffsets[id];
+      unsigned* childEnd = edges.data() + edgeOffsets[id + 1];
+      std::sort(childBegin, childEnd);
+      uniqueCounts[id] = std::unique(childBegin, childEnd) - childBegin;
+    }
+  });
+
+  size_t writePos = 0;
+  for (size_t id = 0; id < nodeCount; ++id)
+  {
+    const unsigned readPos = edgeOffsets[id];
+    std::copy(edges.begin() + readPos, edges.begin() + readPos + uniqueCounts[id],
+              edges.begin() + writePos);
+    edgeOffsets[id] = writePos;
+    writePos += uniqueCounts[id];
+  }
+  edgeOffsets[nodeCount] = writePos;
+  edges.resize(writePos);
+
+  // Intern names into one blob
+  vector<char> nameBlob;
+  vector<unsigned> nameOffsets;
+  nameOffsets.reserve(nodeCount);
+  for (const Token& name : names)
+  {
+    nameOffsets.push_back(nameBlob.size());
+    nameBlob.insert(nameBlob.end(), name.data, name.data + name.size);
+    nameBlob.push_back('\0');
+  }
+  parts.clear();
+
+  if (nameBlob.size() >= UINT32_MAX)
+  {
+    LOG_ERROR("Names of " << nodeCount << " nodes are too long");
+    return false;
+  }
+
+  graph.assign(nameBlob, nameOffsets, edgeOffsets, edges);
+  return true;
+}
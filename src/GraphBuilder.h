@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_GRAPHBUILDER_H_
+#define SRC_GRAPHBUILDER_H_
+
+#include "CompactGraph.h"
+#include <cstring>
+
+/**
+ * Builds a CompactGraph straight from names & edges collected by many
+ * threads, without a Graph in between. Each thread interns into its own
+ * Part with local ids, build() merges the sorted names of all parts and
+ * maps their edges to global ids
+ */
+class GraphBuilder
+{
+public:
+  /**
+   * Name as a span, not null terminated
+   */
+  struct Token
+  {
+    const char* data;
+    unsigned size;
+
+    bool operator==(const Token& other) const
+    {
+      return size == other.size && 0 == memcmp(data, other.data, size);
+    }
+
+    // Same order as strcmp, so ids come out sorted like CompactGraph expects
+    bool operator<(const Token& other) const
+    {
+      const int cmp = memcmp(data, other.data, std::min(size, other.size));
+      return cmp < 0 || (cmp == 0 && size < other.size);
+    }
+
+    bool is(const char* word) const
+    {
+      return size == strlen(word) && 0 == memcmp(data, word, size);
+    }
+  };
+
+  /**
+   * Names & edges of one thread, not thread safe
+   */
+  class Part
+  {
+  public:
+    Part();
+
+    /**
+     * Local id of name, new names get the next id
+     * @param isCopied keep a copy of a new name, otherwise its bytes
+     *                 must stay valid until build()
+     */
+    unsigned intern(const Token& name, bool isCopied = false);
+
+    void addEdge(unsigned from, unsigned to)
+    {
+      mEdges.push_back(from);
+      mEdges.push_back(to);
+    }
+
+    size_t nameCount() const { return mNames.size(); }
+    size_t edgeCount() const { return mEdges.size() / 2; }
+
+  private:
+    friend class GraphBuilder;
+
+    struct Slot
+    {
+      Slot(): key(0), size(0), id(0) {}
+
+      uint64_t key;   ///< name bytes up to 8, hash of longer names
+      uint32_t size;
+      uint32_t id;    ///< id + 1, 0 if empty
+    };
+
+    static uint64_t getKey_(const Token& token);
+    static uint64_t getHash_(uint64_t key, const Token& token);
+    void grow_();
+    const char* copy_(const Token& token);
+
+    vector<Token> mNames;       ///< local id -> name
+    vector<unsigned> mEdges;    ///< local from, to pairs
+    vector<Slot> mSlots;        ///< open addressing name -> id table
+    size_t mMask;
+    vector<std::unique_ptr<char[]> > mBlocks;  ///< copied names
+    char* mBlockPos;
+    size_t mBlockLeft;
+  };
+
+  /**
+   * Merge parts into graph, child lists are sorted and unique
+   * Parts are emptied. Lines are unknown
+   * @return false if graph is too big for 32 bit ids
+   */
+  static bool build(vector<Part>& parts, CompactGraph& graph);
+};
+
+#endif /* SRC_GRAPHBUILDER_H_ */
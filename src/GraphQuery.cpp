@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "GraphQuery.h"
+
+bool GraphQuery::findFile(const CompactGraph& graph, const string& file, unsigned& id)
+{
+  return graph.findId(file, id) || graph.findId(string(Common::getBaseName(file)), id);
+}
+
+void GraphQuery::getDependents(const CompactGraph& graph, const vector<unsigned>& changedIds,
+                               vector<unsigned>& affectedIds)
+{
+  // Multi source walk up the parent edges
+  affectedIds.clear();
+  vector<bool> isVisited(graph.size(), false);
+  vector<unsigned> pending(changedIds);
+
+  while (!pending.empty())
+  {
+    const unsigned node = pending.back();
+    pending.pop_back();
+
+    EdgeCursor parents = graph.parents(node);
+    unsigned parent;
+    while (parents.next(parent))
+    {
+      if (!isVisited[parent])
+      {
+        isVisited[parent] = true;
+        affectedIds.push_back(parent);
+        pending.push_back(parent);
+      }
+    }
+  }
+
+  std::sort(affectedIds.begin(), affectedIds.end());
+}
+
+bool GraphQuery::getShortestChain(const CompactGraph& graph, unsigned from, unsigned to,
+                                  vector<unsigned>& chain)
+{
+  // Breadth first from `from`, each reached node keeps the node it came from
+  chain.clear();
+  static const unsigned NONE = ~0u;
+  vector<unsigned> cameFrom(graph.size(), NONE);
+  vector<unsigned> level(1, from), nextLevel;
+  bool isFound = false;
+  while (!level.empty() && !isFound)
+  {
+    nextLevel.clear();
+    for (const unsigned node : level)
+    {
+      EdgeCursor children = graph.children(node);
+      unsigned child;
+      while (children.next(child))
+      {
+        if (cameFrom[child] == NONE && child != from)
+        {
+          cameFrom[child] = node;
+          nextLevel.push_back(child);
+        }
+        if (child == to)
+        {
+          // A self include or a circle back to `from` still counts
+          cameFrom[child] = node;
+          isFound = true;
+          break;
+        }
+      }
+      if (isFound)
+      {
+        break;
+      }
+    }
+    level.swap(nextLevel);
+  }
+
+  if (!isFound)
+  {
+    return false;
+  }
+
+  chain.push_back(to);
+  for (unsigned node = cameFrom[to]; node != from; node = cameFrom[node])
+  {
+    chain.push_back(node);
+  }
+  chain.push_back(from);
+  std::reverse(chain.begin(), chain.end());
+  return true;
+}
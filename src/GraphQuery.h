@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_GRAPHQUERY_H_
+#define SRC_GRAPHQUERY_H_
+
+#include "CompactGraph.h"
+
+/**
+ * Traversal queries answered straight off a CompactGraph
+ */
+namespace GraphQuery
+{
+  /**
+   * Node id of a queried file, headers are keyed by basename
+   * @return false if file isn't in graph
+   */
+  bool findFile(const CompactGraph& graph, const string& file, unsigned& id);
+
+  /**
+   * Every node that transitively includes one of changedIds
+   * graph must have generateParents() called
+   * @param changedIds  Input: ids of changed nodes
+   * @param affectedIds Output: ids of dependents, sorted, changed ids are
+   *                            only in here if they're part of a circle
+   */
+  void getDependents(const CompactGraph& graph, const vector<unsigned>& changedIds,
+                     vector<unsigned>& affectedIds);
+
+  /**
+   * Fewest includes leading from node from to node to
+   * @param chain Output: from, the headers in between, then to
+   * @return false if to isn't reachable from from
+   */
+  bool getShortestChain(const CompactGraph& graph, unsigned from, unsigned to,
+                        vector<unsigned>& chain);
+};
+
+#endif /* SRC_GRAPHQUERY_H_ */
@@ -0,0 +1,474 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "GraphSnapshot.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdio.h>
+#include <unistd.h>
+
+static_assert(sizeof(unsigned) == sizeof(uint32_t), "snapshot arrays are 32 bit");
+
+namespace
+{
+  const char SNAPSHOT_MAGIC[8] = {'S', 'P', 'I', 'N', 'S', 'N', 'A', 'P'};
+  const uint32_t SNAPSHOT_VERSION = 2;
+  const uint32_t SNAPSHOT_FLAG_VARINT = 1;
+  const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+  const size_t SNAPSHOT_ALIGN = 8;
+
+  /**
+   * With SNAPSHOT_FLAG_VARINT, edge, line and parent lists are varint bytes
+   * and their offsets are byte offsets, see EdgeCursor
+   */
+  enum Section
+  {
+    SEC_NAMES = 0,          // char[], null terminated names
+    SEC_NAME_OFFSETS,       // unsigned[nodeCount]
+    SEC_EDGE_OFFSETS,       // unsigned[nodeCount + 1]
+    SEC_EDGES,              // unsigned[edgeCount] or delta varints
+    SEC_EDGE_LINES,         // unsigned[edgeCount] or varints
+    SEC_LINE_OFFSETS,       // varint only: unsigned[nodeCount + 1], empty otherwise
+    SEC_PARENT_OFFSETS,     // unsigned[nodeCount + 1]
+    SEC_PARENTS,            // unsigned[edgeCount] or delta varints
+    SEC_PATH_OFFSETS,       // unsigned[nodeCount + 1], into path string offsets
+    SEC_PATH_STRING_OFFSETS,// unsigned[pathCount]
+    SEC_PATHS,              // char[], null terminated paths
+    SEC_COUNT
+  };
+
+  struct SnapshotSection
+  {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct SnapshotHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t byteOrder;
+    uint32_t sectionCount;
+    uint64_t nodeCount;
+    uint64_t edgeCount;
+    uint64_t pathCount;
+    SnapshotSection sections[SEC_COUNT];
+  };
+
+  /**
+   * Offsets must be ascending and end at count
+   */
+  bool isValidOffsets(const unsigned* offsets, size_t size, size_t count)
+  {
+    for (size_t i = 1; i < size; ++i)
+    {
+      if (offsets[i] < offsets[i - 1])
+      {
+        return false;
+      }
+    }
+    return size > 0 && offsets[0] == 0 && offsets[size - 1] == count;
+  }
+
+  /**
+   * Every offset must start a string inside a null terminated blob
+   */
+  bool isValidStrings(const unsigned* offsets, size_t count, const char* blob, size_t blobSize)
+  {
+    if (count > 0 && (blobSize == 0 || blob[blobSize - 1] != '\0'))
+    {
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (offsets[i] >= blobSize)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Every list of a varint section must end on a whole value, values
+   * must be below maxValue and there must be count of them in total
+   */
+  bool isValidVarints(const unsigned* offsets, size_t nodeCount, const uint8_t* bytes, size_t size,
+                      bool isDelta, uint64_t maxValue, uint64_t count)
+  {
+    if (!isValidOffsets(offsets, nodeCount + 1, size))
+    {
+      return false;
+    }
+
+    uint64_t total = 0;
+    for (size_t id = 0; id < nodeCount; ++id)
+    {
+      const uint8_t* pos = bytes + offsets[id];
+      const uint8_t* end = bytes + offsets[id + 1];
+      uint32_t last = 0;
+      while (pos < end)
+      {
+        uint64_t decoded = 0;
+        for (unsigned shift = 0; ; shift += 7)
+        {
+          if (pos == end || shift > 28)
+          {
+            return false;
+          }
+          const uint8_t byte = *pos++;
+          decoded |= (uint64_t) (byte & 0x7f) << shift;
+          if (!(byte & 0x80))
+          {
+            break;
+          }
+        }
+        if (decoded > UINT32_MAX)
+        {
+          return false;
+        }
+
+        const uint32_t value = isDelta ? last + (uint32_t) decoded : (uint32_t) decoded;
+        if (value >= maxValue)
+        {
+          return false;
+        }
+        last = value;
+        ++total;
+      }
+    }
+    return total == count;
+  }
+
+  /**
+   * Append a list as LEB128 varints, as the gap to the previous value if isDelta
+   * Gaps wrap around on unsorted lists, that still decodes right
+   */
+  void appendVarints(EdgeCursor cursor, bool isDelta, vector<uint8_t>& bytes)
+  {
+    unsigned value, last = 0;
+    while (cursor.next(value))
+    {
+      unsigned encoded = isDelta ? value - last : value;
+      last = value;
+      while (encoded >= 0x80)
+      {
+        bytes.push_back((encoded & 0x7f) | 0x80);
+        encoded >>= 7;
+      }
+      bytes.push_back(encoded);
+    }
+  }
+
+  void appendValues(EdgeCursor cursor, vector<unsigned>& values)
+  {
+    unsigned value;
+    while (cursor.next(value))
+    {
+      values.push_back(value);
+    }
+  }
+
+  bool isValidIds(const unsigned* ids, size_t count, size_t nodeCount)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (ids[i] >= nodeCount)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+GraphSnapshot::GraphSnapshot(): mPathOffsets(nullptr), mPathStringOffsets(nullptr), mPaths(nullptr)
+{
+}
+
+GraphSnapshot::~GraphSnapshot()
+{
+  close();
+}
+
+bool GraphSnapshot::write(const string& filePath, CompactGraph& graph,
+                          const ProjectParser::HeaderLocationMap& locationMap, bool compress)
+{
+  graph.generateParents();
+  const unsigned nodeCount = graph.size();
+  const unsigned edgeCount = graph.edgeCount();
+
+  // Flatten the graph back to arrays, views may not be contiguous
+  // if the graph was attached from pieces
+  vector<char> names;
+  vector<unsigned> nameOffsets, edgeOffsets(1, 0), edges, edgeLines;
+  vector<unsigned> parentOffsets(1, 0), parents, lineOffsets;
+  vector<uint8_t> edgeBytes, lineBytes, parentBytes;
+  if (compress)
+  {
+    lineOffsets.push_back(0);
+  }
+  vector<unsigned> pathOffsets(1, 0), pathStringOffsets;
+  vector<char> paths;
+  for (unsigned id = 0; id < nodeCount; ++id)
+  {
+    const char* name = graph.name(id);
+    nameOffsets.push_back(names.size());
+    names.insert(names.end(), name, name + strlen(name) + 1);
+
+    if (compress)
+    {
+      appendVarints(graph.children(id), true, edgeBytes);
+      appendVarints(graph.childLines(id), false, lineBytes);
+      appendVarints(graph.parents(id), true, parentBytes);
+      edgeOffsets.push_back(edgeBytes.size());
+      lineOffsets.push_back(lineBytes.size());
+      parentOffsets.push_back(parentBytes.size());
+    }
+    else
+    {
+      appendValues(graph.children(id), edges);
+      appendValues(graph.childLines(id), edgeLines);
+      appendValues(graph.parents(id), parents);
+      edgeOffsets.push_back(edges.size());
+      parentOffsets.push_back(parents.size());
+    }
+
+    const auto pathSetIt = locationMap.find(name);
+    if (pathSetIt != locationMap.end())
+    {
+      for (const string& path : pathSetIt->second)
+      {
+        pathStringOffsets.push_back(paths.size());
+        paths.insert(paths.end(), path.begin(), path.end());
+        paths.push_back('\0');
+      }
+    }
+    pathOffsets.push_back(pathStringOffsets.size());
+  }
+
+  if (std::max(edgeBytes.size(), std::max(lineBytes.size(), parentBytes.size())) >= UINT32_MAX)
+  {
+    LOG_ERROR("Graph is too big for a compressed snapshot");
+    return false;
+  }
+
+  const std::pair<const void*, size_t> sectionData[SEC_COUNT] =
+  {
+    {names.data(), names.size()},
+    {nameOffsets.data(), nameOffsets.size() * sizeof(unsigned)},
+    {edgeOffsets.data(), edgeOffsets.size() * sizeof(unsigned)},
+    compress ? std::make_pair((const void*) edgeBytes.data(), edgeBytes.size())
+             : std::make_pair((const void*) edges.data(), edges.size() * sizeof(unsigned)),
+    compress ? std::make_pair((const void*) lineBytes.data(), lineBytes.size())
+             : std::make_pair((const void*) edgeLines.data(), edgeLines.size() * sizeof(unsigned)),
+    {lineOffsets.data(), lineOffsets.size() * sizeof(unsigned)},
+    {parentOffsets.data(), parentOffsets.size() * sizeof(unsigned)},
+    compress ? std::make_pair((const void*) parentBytes.data(), parentBytes.size())
+             : std::make_pair((const void*) parents.data(), parents.size() * sizeof(unsigned)),
+    {pathOffsets.data(), pathOffsets.size() * sizeof(unsigned)},
+    {pathStringOffsets.data(), pathStringOffsets.size() * sizeof(unsigned)},
+    {paths.data(), paths.size()}
+  };
+
+  SnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.flags = compress ? SNAPSHOT_FLAG_VARINT : 0;
+  header.byteOrder = SNAPSHOT_BYTE_ORDER;
+  header.sectionCount = SEC_COUNT;
+  header.nodeCount = nodeCount;
+  header.edgeCount = edgeCount;
+  header.pathCount = pathStringOffsets.size();
+  uint64_t offset = sizeof(header);
+  for (size_t i = 0; i < SEC_COUNT; ++i)
+  {
+    offset = (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+    header.sections[i].offset = offset;
+    header.sections[i].size = sectionData[i].second;
+    offset += sectionData[i].second;
+  }
+
+  // Write aside and rename, a reader never maps a half written file
+  const string tmpPath = filePath + ".tmp";
+  std::ofstream file(tmpPath, std::ofstream::binary | std::ofstream::trunc);
+  file.write((const char*) &header, sizeof(header));
+  uint64_t written = sizeof(header);
+  const char padding[SNAPSHOT_ALIGN] = {0};
+  for (size_t i = 0; i < SEC_COUNT; ++i)
+  {
+    file.write(padding, header.sections[i].offset - written);
+    file.write((const char*) sectionData[i].first, sectionData[i].second);
+    written = header.sections[i].offset + sectionData[i].second;
+  }
+  file.close();
+
+  if (file.fail() || 0 != rename(tmpPath.c_str(), filePath.c_str()))
+  {
+    LOG_ERROR("Cannot write snapshot " << filePath);
+    unlink(tmpPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool GraphSnapshot::isSnapshot(const string& filePath)
+{
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  std::ifstream file(filePath, std::ifstream::binary);
+  file.read(magic, sizeof(magic));
+  return file.good() && 0 == memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic));
+}
+
+bool GraphSnapshot::open(const string& filePath)
+{
+  close();
+
+  if (!mFile.open(filePath))
+  {
+    return false;
+  }
+
+  const size_t fileSize = mFile.size();
+  if (fileSize < sizeof(SnapshotHeader))
+  {
+    LOG_ERROR("Snapshot " << filePath << " is truncated");
+    close();
+    return false;
+  }
+
+  const char* base = mFile.data();
+  const SnapshotHeader& header = *(const SnapshotHeader*) base;
+  if (0 != memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)))
+  {
+    LOG_ERROR(filePath << " is not a snapshot");
+    close();
+    return false;
+  }
+  if (header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER
+      || header.sectionCount != SEC_COUNT || (header.flags & ~SNAPSHOT_FLAG_VARINT) != 0)
+  {
+    LOG_ERROR("Unsupported snapshot version " << header.version << " in " << filePath);
+    close();
+    return false;
+  }
+
+  // Sections must lie inside the file, be aligned and have the right size
+  const uint64_t nodeCount = header.nodeCount;
+  const uint64_t edgeCount = header.edgeCount;
+  const uint64_t pathCount = header.pathCount;
+  const bool isEncoded = header.flags & SNAPSHOT_FLAG_VARINT;
+  const uint64_t ANY_SIZE = UINT64_MAX;
+  const uint64_t listCount = isEncoded ? ANY_SIZE : edgeCount;
+  const uint64_t expectedCount[SEC_COUNT] =
+  {
+    ANY_SIZE, nodeCount, nodeCount + 1, listCount, listCount, isEncoded ? nodeCount + 1 : 0,
+    nodeCount + 1, listCount, nodeCount + 1, pathCount, ANY_SIZE
+  };
+  bool isValid = nodeCount < UINT32_MAX && edgeCount < UINT32_MAX && pathCount < UINT32_MAX;
+  for (size_t i = 0; isValid && i < SEC_COUNT; ++i)
+  {
+    const SnapshotSection& section = header.sections[i];
+    isValid = section.offset % SNAPSHOT_ALIGN == 0
+        && section.offset <= fileSize && section.size <= fileSize - section.offset
+        && (expectedCount[i] == ANY_SIZE || section.size == expectedCount[i] * sizeof(unsigned));
+  }
+
+  auto sectionPtr = [&](Section i) { return base + header.sections[i].offset; };
+  auto arrayPtr = [&](Section i) { return (const unsigned*) sectionPtr(i); };
+  auto bytePtr = [&](Section i) { return (const uint8_t*) sectionPtr(i); };
+  auto sectionSize = [&](Section i) { return header.sections[i].size; };
+  if (isValid && isEncoded)
+  {
+    isValid = isValidVarints(arrayPtr(SEC_EDGE_OFFSETS), nodeCount, bytePtr(SEC_EDGES),
+                             sectionSize(SEC_EDGES), true, nodeCount, edgeCount)
+        && isValidVarints(arrayPtr(SEC_LINE_OFFSETS), nodeCount, bytePtr(SEC_EDGE_LINES),
+                          sectionSize(SEC_EDGE_LINES), false, ANY_SIZE, edgeCount)
+        && isValidVarints(arrayPtr(SEC_PARENT_OFFSETS), nodeCount, bytePtr(SEC_PARENTS),
+                          sectionSize(SEC_PARENTS), true, nodeCount, edgeCount);
+  }
+  else if (isValid)
+  {
+    isValid = isValidOffsets(arrayPtr(SEC_EDGE_OFFSETS), nodeCount + 1, edgeCount)
+        && isValidOffsets(arrayPtr(SEC_PARENT_OFFSETS), nodeCount + 1, edgeCount)
+        && isValidIds(arrayPtr(SEC_EDGES), edgeCount, nodeCount)
+        && isValidIds(arrayPtr(SEC_PARENTS), edgeCount, nodeCount);
+  }
+  if (isValid)
+  {
+    isValid = isValidOffsets(arrayPtr(SEC_PATH_OFFSETS), nodeCount + 1, pathCount)
+        && isValidStrings(arrayPtr(SEC_NAME_OFFSETS), nodeCount,
+                          sectionPtr(SEC_NAMES), header.sections[SEC_NAMES].size)
+        && isValidStrings(arrayPtr(SEC_PATH_STRING_OFFSETS), pathCount,
+                          sectionPtr(SEC_PATHS), header.sections[SEC_PATHS].size);
+  }
+  if (!isValid)
+  {
+    LOG_ERROR("Snapshot " << filePath << " is corrupted");
+    close();
+    return false;
+  }
+
+  if (isEncoded)
+  {
+    mGraph.attachEncoded(nodeCount, edgeCount, sectionPtr(SEC_NAMES), arrayPtr(SEC_NAME_OFFSETS),
+                         arrayPtr(SEC_EDGE_OFFSETS), bytePtr(SEC_EDGES),
+                         arrayPtr(SEC_LINE_OFFSETS), bytePtr(SEC_EDGE_LINES),
+                         arrayPtr(SEC_PARENT_OFFSETS), bytePtr(SEC_PARENTS));
+  }
+  else
+  {
+    mGraph.attach(nodeCount, sectionPtr(SEC_NAMES), arrayPtr(SEC_NAME_OFFSETS),
+                  arrayPtr(SEC_EDGE_OFFSETS), arrayPtr(SEC_EDGES), arrayPtr(SEC_EDGE_LINES),
+                  arrayPtr(SEC_PARENT_OFFSETS), arrayPtr(SEC_PARENTS));
+  }
+  mPathOffsets = arrayPtr(SEC_PATH_OFFSETS);
+  mPathStringOffsets = arrayPtr(SEC_PATH_STRING_OFFSETS);
+  mPaths = sectionPtr(SEC_PATHS);
+  return true;
+}
+
+void GraphSnapshot::close()
+{
+  mFile.close();
+  Graph empty;
+  mGraph.assign(empty);
+  mPathOffsets = mPathStringOffsets = nullptr;
+  mPaths = nullptr;
+}
+
+void GraphSnapshot::getLocationMap(ProjectParser::HeaderLocationMap& locationMap) const
+{
+  locationMap.clear();
+  for (unsigned id = 0; id < mGraph.size(); ++id)
+  {
+    for (size_t i = 0; i < pathCount(id); ++i)
+    {
+      locationMap[mGraph.name(id)].insert(path(id, i));
+    }
+  }
+}
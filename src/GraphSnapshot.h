@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_GRAPHSNAPSHOT_H_
+#define SRC_GRAPHSNAPSHOT_H_
+
+#include "CompactGraph.h"
+#include "MappedFile.h"
+#include "ProjectParser.h"
+
+/**
+ * Versioned binary dump of a parsed CompactGraph plus header paths
+ * Every section is a plain array in native byte order, aligned to 8 bytes,
+ * so open() maps the file and attaches the graph to it without parsing
+ * Compressed snapshots keep adjacency lists as delta + varint bytes
+ */
+class GraphSnapshot
+{
+public:
+  GraphSnapshot();
+  virtual ~GraphSnapshot();
+
+  /**
+   * Write graph and the paths of its nodes from locationMap to filePath
+   * Parents are generated and stored too if graph doesn't have them yet
+   * @param compress store edge, line and parent lists as varints, the
+   *                 mapped graph is then walked with cursors only
+   * @return true on success
+   */
+  static bool write(const string& filePath, CompactGraph& graph,
+                    const ProjectParser::HeaderLocationMap& locationMap, bool compress = false);
+
+  /**
+   * Check magic of filePath, doesn't validate the rest
+   */
+  static bool isSnapshot(const string& filePath);
+
+  /**
+   * Map filePath read only and validate its sections
+   * @return true on success, graph() is valid until close or destruction
+   */
+  bool open(const string& filePath);
+  void close();
+
+  /**
+   * Graph attached to the mapped file, parents are always available
+   */
+  CompactGraph& graph() { return mGraph; }
+  const CompactGraph& graph() const { return mGraph; }
+
+  /**
+   * Full paths of node id, empty for source files which are keyed by path
+   */
+  size_t pathCount(unsigned id) const { return mPathOffsets[id + 1] - mPathOffsets[id]; }
+  const char* path(unsigned id, size_t i) const
+  {
+    return mPaths + mPathStringOffsets[mPathOffsets[id] + i];
+  }
+
+  /**
+   * Rebuild the parser's location map from stored paths
+   */
+  void getLocationMap(ProjectParser::HeaderLocationMap& locationMap) const;
+
+private:
+  GraphSnapshot(const GraphSnapshot&) = delete;
+  GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+private:
+  MappedFile mFile;
+  CompactGraph mGraph;
+  const unsigned* mPathOffsets;
+  const unsigned* mPathStringOffsets;
+  const char* mPaths;
+};
+
+#endif /* SRC_GRAPHSNAPSHOT_H_ */
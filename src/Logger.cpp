@@ -0,0 +1,431 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <signal.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /**
+   * Single producer single consumer byte ring
+   * Records are [uint32 size][uint8 stream][size bytes], always pushed whole,
+   * so whatever the consumer pops is a run of whole records
+   */
+  class LogRing
+  {
+  public:
+    static const size_t CAPACITY = 1 << 16;
+    static const size_t HEADER_SIZE = sizeof(uint32_t) + 1;
+
+    LogRing(): isClosed(false), mHead(0), mTail(0) {}
+
+    /**
+     * @return false if there's no room, nothing is pushed then
+     */
+    bool push(Logger::Stream stream, const char* data, size_t size)
+    {
+      const size_t tail = mTail.load(std::memory_order_relaxed);
+      const size_t head = mHead.load(std::memory_order_acquire);
+      if (CAPACITY - (tail - head) < HEADER_SIZE + size)
+      {
+        return false;
+      }
+
+      char header[HEADER_SIZE];
+      const uint32_t recordSize = size;
+      memcpy(header, &recordSize, sizeof(recordSize));
+      header[sizeof(recordSize)] = (char) stream;
+      copyIn_(tail, header, HEADER_SIZE);
+      copyIn_(tail + HEADER_SIZE, data, size);
+      mTail.store(tail + HEADER_SIZE + size, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Append everything pushed so far to output
+     */
+    void pop(std::string& output)
+    {
+      const size_t head = mHead.load(std::memory_order_relaxed);
+      const size_t tail = mTail.load(std::memory_order_acquire);
+      const size_t offset = head & (CAPACITY - 1);
+      const size_t size = tail - head;
+      const size_t first = std::min(size, CAPACITY - offset);
+      output.append(mBuffer + offset, first);
+      output.append(mBuffer, size - first);
+      mHead.store(tail, std::memory_order_release);
+    }
+
+    bool isEmpty() const
+    {
+      return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+    }
+
+    /// Set when the owning thread exits, the ring goes once drained
+    std::atomic<bool> isClosed;
+
+  private:
+    void copyIn_(size_t pos, const char* data, size_t size)
+    {
+      const size_t offset = pos & (CAPACITY - 1);
+      const size_t first = std::min(size, CAPACITY - offset);
+      memcpy(mBuffer + offset, data, first);
+      memcpy(mBuffer, data + first, size - first);
+    }
+
+    // Head and tail on their own cache lines, they're written by different threads
+    char mPad0[64];
+    std::atomic<size_t> mHead;
+    char mPad1[64];
+    std::atomic<size_t> mTail;
+    char mPad2[64];
+    char mBuffer[CAPACITY];
+  };
+
+  /// Set once the writer is destroyed, late messages are written inline
+  std::atomic<bool> g_isWriterGone(false);
+
+  /**
+   * Background thread draining every ring
+   */
+  class Writer
+  {
+  public:
+    static Writer& instance()
+    {
+      static Writer writer;
+      return writer;
+    }
+
+    ~Writer()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+      }
+      mWakeCv.notify_one();
+      if (mThread.joinable())
+      {
+        mThread.join();
+      }
+      g_isWriterGone = true;
+    }
+
+    std::shared_ptr<LogRing> registerRing()
+    {
+      std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+      std::lock_guard<std::mutex> lock(mMutex);
+      mRings.push_back(ring);
+      if (!mThread.joinable())
+      {
+        mThread = std::thread(&Writer::run_, this);
+      }
+      return ring;
+    }
+
+    void wake()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsWakeRequested = true;
+      }
+      mWakeCv.notify_one();
+    }
+
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (!mThread.joinable())
+      {
+        fflush(mOut);
+        fflush(mErr);
+        return;
+      }
+
+      const uint64_t target = ++mFlushRequests;
+      mWakeCv.notify_one();
+      mFlushedCv.wait(lock, [&]() { return mFlushedUpTo >= target; });
+    }
+
+    /**
+     * Write without queueing, for messages bigger than a ring
+     */
+    void writeDirect(Logger::Stream stream, const char* msg, size_t size)
+    {
+      FILE* file;
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        file = (stream == Logger::STREAM_OUT) ? mOut : mErr;
+      }
+      fwrite(msg, 1, size, file);
+      fflush(file);
+    }
+
+    void setOutput(FILE* out, FILE* err)
+    {
+      flush();
+      std::lock_guard<std::mutex> lock(mMutex);
+      mOut = out ? out : stdout;
+      mErr = err ? err : stderr;
+    }
+
+  private:
+    Writer(): mIsStopping(false), mIsWakeRequested(false), mFlushRequests(0), mFlushedUpTo(0),
+        mOut(stdout), mErr(stderr) {}
+
+    void run_()
+    {
+      // Signals go to the other threads, a closed pipe just fails the write
+      sigset_t signals;
+      sigfillset(&signals);
+      pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+      static const auto MAX_LATENCY = std::chrono::milliseconds(20);
+      std::string records;
+      std::unique_lock<std::mutex> lock(mMutex);
+      while (true)
+      {
+        mWakeCv.wait_for(lock, MAX_LATENCY, [&]()
+        {
+          return mIsStopping || mIsWakeRequested || mFlushRequests > mFlushedUpTo;
+        });
+        mIsWakeRequested = false;
+        const uint64_t flushRequests = mFlushRequests;
+        const bool isStopping = mIsStopping;
+        const std::vector<std::shared_ptr<LogRing> > rings(mRings);
+        FILE* out = mOut;
+        FILE* err = mErr;
+        lock.unlock();
+
+        for (const auto& ring : rings)
+        {
+          records.clear();
+          ring->pop(records);
+          write_(records, out, err);
+        }
+
+        lock.lock();
+        mRings.erase(std::remove_if(mRings.begin(), mRings.end(), [](const std::shared_ptr<LogRing>& ring)
+        {
+          return ring->isClosed && ring->isEmpty();
+        }), mRings.end());
+        mFlushedUpTo = flushRequests;
+        mFlushedCv.notify_all();
+        if (isStopping)
+        {
+          break;
+        }
+      }
+    }
+
+    /**
+     * Write records of one ring, one fwrite per run of the same stream
+     */
+    static void write_(const std::string& records, FILE* out, FILE* err)
+    {
+      size_t runBegin = 0, pos = 0;
+      char runStream = 0;
+      std::string run;
+      while (pos < records.size())
+      {
+        uint32_t size;
+        memcpy(&size, records.data() + pos, sizeof(size));
+        const char stream = records[pos + sizeof(size)];
+        if (stream != runStream && !run.empty())
+        {
+          FILE* file = (runStream == Logger::STREAM_OUT) ? out : err;
+          fwrite(run.data(), 1, run.size(), file);
+          fflush(file);
+          run.clear();
+        }
+        runStream = stream;
+        runBegin = pos + LogRing::HEADER_SIZE;
+        run.append(records, runBegin, size);
+        pos = runBegin + size;
+      }
+
+      if (!run.empty())
+      {
+        FILE* file = (runStream == Logger::STREAM_OUT) ? out : err;
+        fwrite(run.data(), 1, run.size(), file);
+        fflush(file);
+      }
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mWakeCv;
+    std::condition_variable mFlushedCv;
+    std::vector<std::shared_ptr<LogRing> > mRings;
+    std::thread mThread;
+    bool mIsStopping;
+    bool mIsWakeRequested;
+    uint64_t mFlushRequests;
+    uint64_t mFlushedUpTo;
+    FILE* mOut;
+    FILE* mErr;
+  };
+
+  /**
+   * Ring of the current thread, closed when the thread exits
+   */
+  struct RingHolder
+  {
+    ~RingHolder()
+    {
+      if (ring)
+      {
+        ring->isClosed = true;
+      }
+    }
+
+    std::shared_ptr<LogRing> ring;
+  };
+
+  /**
+   * Formats into a reused string, no allocation once it's grown
+   */
+  class LineBuffer: public std::streambuf
+  {
+  public:
+    std::string text;
+
+  protected:
+    int_type overflow(int_type c)
+    {
+      if (c != traits_type::eof())
+      {
+        text.push_back((char) c);
+      }
+      return c;
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size)
+    {
+      text.append(data, size);
+      return size;
+    }
+  };
+
+  struct LineStream
+  {
+    LineStream(): stream(&buffer), isInUse(false) {}
+
+    LineBuffer buffer;
+    std::ostream stream;
+    bool isInUse;
+  };
+
+  thread_local RingHolder t_ring;
+  thread_local LineStream t_line;
+}
+
+void Logger::write(Stream stream, const char* msg, size_t size)
+{
+  if (g_isWriterGone)
+  {
+    fwrite(msg, 1, size, stream == STREAM_OUT ? stdout : stderr);
+    return;
+  }
+
+  Writer& writer = Writer::instance();
+  if (!t_ring.ring)
+  {
+    t_ring.ring = writer.registerRing();
+  }
+
+  LogRing& ring = *t_ring.ring;
+  if (size + LogRing::HEADER_SIZE > LogRing::CAPACITY)
+  {
+    // Too big to queue, keep order with this thread's queued lines
+    while (!ring.isEmpty())
+    {
+      writer.wake();
+      std::this_thread::yield();
+    }
+    writer.writeDirect(stream, msg, size);
+    return;
+  }
+
+  while (!ring.push(stream, msg, size))
+  {
+    writer.wake();
+    std::this_thread::yield();
+  }
+}
+
+void Logger::flush()
+{
+  if (!g_isWriterGone)
+  {
+    Writer::instance().flush();
+  }
+}
+
+void Logger::setOutput(FILE* out, FILE* err)
+{
+  if (!g_isWriterGone)
+  {
+    Writer::instance().setOutput(out, err);
+  }
+}
+
+Logger::Line::Line(Stream stream): mStreamId(stream), mOwnedStream(nullptr)
+{
+  if (t_line.isInUse)
+  {
+    mOwnedStream = new std::ostringstream;
+    mStream = mOwnedStream;
+  }
+  else
+  {
+    t_line.isInUse = true;
+    t_line.buffer.text.clear();
+    t_line.stream.clear();
+    mStream = &t_line.stream;
+  }
+}
+
+Logger::Line::~Line()
+{
+  if (mOwnedStream)
+  {
+    const std::string text = mOwnedStream->str();
+    write(mStreamId, text.data(), text.size());
+    delete mOwnedStream;
+  }
+  else
+  {
+    write(mStreamId, t_line.buffer.text.data(), t_line.buffer.text.size());
+    t_line.isInUse = false;
+  }
+}
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_LOGGER_H_
+#define SRC_LOGGER_H_
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+/**
+ * Levels compiled in, build with -DSPINCLUDE_LOG_LEVEL=n (make LOG_LEVEL=n)
+ *   0 errors only, 1 warnings too, 2 debug and verbose messages too
+ * Messages above the level are type checked but never evaluated
+ */
+#ifndef SPINCLUDE_LOG_LEVEL
+#define SPINCLUDE_LOG_LEVEL 2
+#endif
+
+/**
+ * Asynchronous logger
+ * Each thread formats into its own lock free ring buffer, a background
+ * writer drains all rings and writes them out in batches
+ * Lines of one thread keep their order, lines of different threads don't
+ */
+namespace Logger
+{
+  enum Stream
+  {
+    STREAM_OUT = 1,
+    STREAM_ERR = 2
+  };
+
+  /**
+   * Queue a formatted message, msg may be any size
+   */
+  void write(Stream stream, const char* msg, size_t size);
+
+  /**
+   * Block until every message queued so far, by any thread, is written
+   * Call before printing straight to stdout/stderr so lines don't cross
+   */
+  void flush();
+
+  /**
+   * Redirect output, mostly for tests, null restores stdout/stderr
+   * Pending messages are flushed to the old files first
+   */
+  void setOutput(FILE* out, FILE* err);
+
+  /**
+   * One message being formatted, queued on destruction
+   */
+  class Line
+  {
+  public:
+    Line(Stream stream);
+    ~Line();
+
+    std::ostream& stream() { return *mStream; }
+
+  private:
+    Line(const Line&) = delete;
+    Line& operator=(const Line&) = delete;
+
+    Stream mStreamId;
+    std::ostream* mStream;
+    std::ostringstream* mOwnedStream; // when nested in another line's message
+  };
+}
+
+#define LOG_LINE_(streamId, msg) \
+    do {Logger::Line logLine_(streamId); logLine_.stream() << msg << '\n';} while(0)
+
+#define LOG_DISABLED_(msg) \
+    do {if (false) {std::ostringstream logLine_; logLine_ << msg;}} while(0)
+
+// print out error message to stderr
+#define LOG_ERROR(msg) \
+    do {if (!Common::isDebugMode()) LOG_LINE_(Logger::STREAM_ERR, "[ERROR] " << msg);\
+        else LOG_LINE_(Logger::STREAM_ERR, __FILE__ << ":" << __LINE__ << "-(" \
+        <<__func__ << ") [ERROR] " << msg);\
+    } while(0)
+
+#if SPINCLUDE_LOG_LEVEL >= 1
+#define LOG_WARN(msg) \
+    do {if (!Common::isDebugMode()) LOG_LINE_(Logger::STREAM_ERR, "[WARNING] " << msg);\
+        else LOG_LINE_(Logger::STREAM_ERR, __FILE__ << ":" << __LINE__ << "-(" \
+        <<__func__ << ") [WARNING] " << msg);\
+    } while(0)
+#else
+#define LOG_WARN(msg) LOG_DISABLED_(msg)
+#endif
+
+#if SPINCLUDE_LOG_LEVEL >= 2
+#define LOG_DEBUG(msg) \
+    do {if (Common::isDebugMode()) LOG_LINE_(Logger::STREAM_ERR, __FILE__ << ":" \
+        << __LINE__ << "-(" <<__func__ << ") [debug] " << msg);\
+        else if (Common::isVerboseMode()) LOG_LINE_(Logger::STREAM_OUT, "[verbose] " << msg);\
+    } while(0)
+#else
+#define LOG_DEBUG(msg) LOG_DISABLED_(msg)
+#endif
+
+#endif /* SRC_LOGGER_H_ */
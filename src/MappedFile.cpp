@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(): mData(nullptr), mSize(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool MappedFile::open(const string& filePath, bool readAhead)
+{
+  close();
+
+  int fd = ::open(filePath.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    LOG_ERROR("Cannot open " << filePath);
+    return false;
+  }
+
+  struct stat fileStat;
+  if (0 != fstat(fd, &fileStat))
+  {
+    LOG_ERROR("Cannot stat " << filePath);
+    ::close(fd);
+    return false;
+  }
+
+  // mmap rejects 0 length, an empty file is just empty
+  bool retVal = true;
+  if (fileStat.st_size > 0)
+  {
+    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == data)
+    {
+      LOG_ERROR("Cannot map " << filePath);
+      retVal = false;
+    }
+    else
+    {
+      mData = data;
+      mSize = fileStat.st_size;
+      if (readAhead)
+      {
+        madvise(mData, mSize, MADV_WILLNEED);
+      }
+    }
+  }
+
+  ::close(fd);
+  return retVal;
+}
+
+void MappedFile::close()
+{
+  if (mData)
+  {
+    munmap(mData, mSize);
+  }
+  mData = nullptr;
+  mSize = 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_MAPPEDFILE_H_
+#define SRC_MAPPEDFILE_H_
+
+#include "Common.h"
+
+/**
+ * Read only view of a whole file, mapped with mmap
+ * Empty files are valid and have data() == nullptr
+ */
+class MappedFile
+{
+public:
+  MappedFile();
+  virtual ~MappedFile();
+
+  /**
+   * Map filePath, unmapping whatever was mapped before
+   * @param readAhead ask the kernel to start reading the whole file in,
+   *                  for callers that are going to scan all of it
+   * @return true on success
+   */
+  bool open(const string& filePath, bool readAhead = false);
+  void close();
+
+  const char* data() const { return (const char*) mData; }
+  size_t size() const { return mSize; }
+
+private:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+  void* mData;
+  size_t mSize;
+};
+
+#endif /* SRC_MAPPEDFILE_H_ */
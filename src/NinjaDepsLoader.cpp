@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "NinjaDepsLoader.h"
+#include "MappedFile.h"
+#include "ProjectParser.h"
+#include <climits>
+
+namespace
+{
+  const char SIGNATURE[] = "# ninjadeps\n";
+  const size_t SIGNATURE_SIZE = sizeof(SIGNATURE) - 1;
+
+  // Version 4 has a 64 bit mtime, version 3 a 32 bit one
+  const uint32_t OLDEST_VERSION = 3;
+  const uint32_t CURRENT_VERSION = 4;
+
+  const uint32_t DEPS_RECORD_BIT = 0x80000000u;
+  const uint32_t MAX_RECORD_SIZE = (1u << 19) - 1;
+  const unsigned NO_ID = UINT_MAX;
+
+  uint32_t read_u32(const char* pos)
+  {
+    uint32_t retVal;
+    memcpy(&retVal, pos, sizeof(retVal));
+    return retVal;
+  }
+
+  struct DepsRecord
+  {
+    const char* inputs;
+    uint32_t inputCount;
+  };
+}
+
+bool NinjaDepsLoader::parse(const char* data, size_t size, GraphBuilder::Part& part)
+{
+  if (size < SIGNATURE_SIZE + 4 || 0 != memcmp(data, SIGNATURE, SIGNATURE_SIZE))
+  {
+    LOG_ERROR("Not a ninja deps log");
+    return false;
+  }
+  const uint32_t version = read_u32(data + SIGNATURE_SIZE);
+  if (version < OLDEST_VERSION || version > CURRENT_VERSION)
+  {
+    LOG_ERROR("Unsupported ninja deps log version " << version);
+    return false;
+  }
+  const size_t depsHeaderSize = (version < 4) ? 8 : 12;
+
+  // First pass checks records and keeps the last deps of each output
+  vector<GraphBuilder::Token> paths;
+  vector<DepsRecord> deps;
+  const char* pos = data + SIGNATURE_SIZE + 4;
+  const char* const end = data + size;
+  bool isCorrupt = false;
+  while (end - pos >= 4)
+  {
+    uint32_t recordSize = read_u32(pos);
+    const bool isDeps = (recordSize & DEPS_RECORD_BIT) != 0;
+    recordSize &= ~DEPS_RECORD_BIT;
+    if (recordSize > MAX_RECORD_SIZE || recordSize % 4 != 0 || recordSize < 4
+        || (size_t) (end - pos - 4) < recordSize)
+    {
+      isCorrupt = true;
+      break;
+    }
+    const char* record = pos + 4;
+
+    if (isDeps)
+    {
+      const uint32_t outId = read_u32(record);
+      if (recordSize < depsHeaderSize || outId >= paths.size())
+      {
+        isCorrupt = true;
+        break;
+      }
+      const uint32_t inputCount = (recordSize - depsHeaderSize) / 4;
+      const char* inputs = record + depsHeaderSize;
+      for (uint32_t i = 0; i < inputCount; ++i)
+      {
+        if (read_u32(inputs + i * 4) >= paths.size())
+        {
+          isCorrupt = true;
+          break;
+        }
+      }
+      if (isCorrupt)
+      {
+        break;
+      }
+      deps.resize(std::max<size_t>(deps.size(), outId + 1), DepsRecord{nullptr, 0});
+      deps[outId] = DepsRecord{inputs, inputCount};
+    }
+    else
+    {
+      // Path padded with nulls to 4 bytes, then the checksum ~id
+      const uint32_t checksum = read_u32(record + recordSize - 4);
+      if (checksum != ~(uint32_t) paths.size())
+      {
+        isCorrupt = true;
+        break;
+      }
+      unsigned pathSize = recordSize - 4;
+      while (pathSize > 0 && record[pathSize - 1] == '\0')
+      {
+        --pathSize;
+      }
+      paths.push_back(GraphBuilder::Token{record, pathSize});
+    }
+    pos = record + recordSize;
+  }
+
+  if (isCorrupt || pos != end)
+  {
+    LOG_WARN("Ninja deps log is truncated or corrupt after byte " << (pos - data)
+             << ", ignoring the rest");
+  }
+
+  // Only paths that end up in an edge are interned
+  vector<unsigned> ids(paths.size(), NO_ID);
+  auto intern = [&](uint32_t pathId)
+  {
+    if (ids[pathId] == NO_ID)
+    {
+      ids[pathId] = part.intern(paths[pathId]);
+    }
+    return ids[pathId];
+  };
+
+  for (size_t outId = 0; outId < deps.size(); ++outId)
+  {
+    const DepsRecord& record = deps[outId];
+    if (record.inputCount == 0)
+    {
+      continue;
+    }
+
+    uint32_t first = 0;
+    uint32_t fromPath = outId;
+    const uint32_t firstInput = read_u32(record.inputs);
+    if (ProjectParser::isSourceFile(string(paths[firstInput].data, paths[firstInput].size)))
+    {
+      fromPath = firstInput;
+      first = 1;
+    }
+
+    const unsigned from = intern(fromPath);
+    for (uint32_t i = first; i < record.inputCount; ++i)
+    {
+      const unsigned to = intern(read_u32(record.inputs + i * 4));
+      if (to != from)
+      {
+        part.addEdge(from, to);
+      }
+    }
+  }
+  return true;
+}
+
+bool NinjaDepsLoader::load(const string& path, CompactGraph& graph)
+{
+  const string filePath = Common::isDirExist(path) ? path + "/.ninja_deps" : path;
+  MappedFile file;
+  if (!file.open(filePath, true))
+  {
+    return false;
+  }
+
+  // One thread, the log is a chain of records that must be walked in order
+  vector<GraphBuilder::Part> parts(1);
+  return parse(file.data(), file.size(), parts[0]) && GraphBuilder::build(parts, graph);
+}
@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_NINJADEPSLOADER_H_
+#define SRC_NINJADEPSLOADER_H_
+
+#include "GraphBuilder.h"
+
+/**
+ * Reads the binary .ninja_deps log ninja keeps for deps = gcc / msvc
+ * rules: path records name nodes by id, deps records list the inputs the
+ * compiler reported for an output, later records replace earlier ones
+ * Like depfiles it holds all headers of a translation unit but not who
+ * included whom, so headers are leaves and there are no circles to find
+ */
+namespace NinjaDepsLoader
+{
+  /**
+   * Parse a deps log, a truncated or corrupt tail is dropped like ninja
+   * does. Names point into data, it must stay valid until build()
+   * Inputs hang off the output's first input when that's a source file,
+   * off the output itself otherwise (msvc doesn't list the source)
+   * @return false if data isn't a deps log of a supported version
+   */
+  bool parse(const char* data, size_t size, GraphBuilder::Part& part);
+
+  /**
+   * Map path, a build dir means its .ninja_deps, and parse it into graph
+   * @return true on success
+   */
+  bool load(const string& path, CompactGraph& graph);
+};
+
+#endif /* SRC_NINJADEPSLOADER_H_ */
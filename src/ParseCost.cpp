@@ -0,0 +1,510 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "ParseCost.h"
+#include "GraphQuery.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <mutex>
+
+namespace
+{
+  // Traces are a few MB each, a handful per thread is enough
+  const size_t MIN_CHUNK_FILES = 4;
+
+  // Trace events are shallow, deeper input is rejected, not recursed into
+  const unsigned MAX_DEPTH = 64;
+
+  /**
+   * Just enough of JSON to pull the fields of trace events out, values
+   * that aren't asked for are skipped without being copied
+   */
+  class JsonReader
+  {
+  public:
+    JsonReader(const char* data, size_t size): mPos(data), mEnd(data + size), mDepth(0) {}
+
+    /**
+     * Consume c if it's next after blanks
+     */
+    bool accept(char c)
+    {
+      skipBlanks_();
+      if (mPos < mEnd && *mPos == c)
+      {
+        ++mPos;
+        return true;
+      }
+      return false;
+    }
+
+    /**
+     * fn(key) is called for each member and must read its value
+     */
+    template<typename Fn>
+    bool readObject(Fn fn)
+    {
+      if (mDepth >= MAX_DEPTH || !accept('{'))
+      {
+        return false;
+      }
+      ++mDepth;
+      bool retVal = accept('}');
+      if (!retVal)
+      {
+        string key;
+        do
+        {
+          if (!readString(&key) || !accept(':') || !fn(key))
+          {
+            return false;
+          }
+        } while (accept(','));
+        retVal = accept('}');
+      }
+      --mDepth;
+      return retVal;
+    }
+
+    /**
+     * fn() is called for each element and must read it
+     */
+    template<typename Fn>
+    bool readArray(Fn fn)
+    {
+      if (mDepth >= MAX_DEPTH || !accept('['))
+      {
+        return false;
+      }
+      ++mDepth;
+      bool retVal = accept(']');
+      if (!retVal)
+      {
+        do
+        {
+          if (!fn())
+          {
+            return false;
+          }
+        } while (accept(','));
+        retVal = accept(']');
+      }
+      --mDepth;
+      return retVal;
+    }
+
+    /**
+     * @param output unescaped string, nullptr to skip it
+     */
+    bool readString(string* output);
+    bool readNumber(double& output);
+    bool skipValue();
+
+  private:
+    void skipBlanks_()
+    {
+      while (mPos < mEnd && (*mPos == ' ' || *mPos == '\n' || *mPos == '\r' || *mPos == '\t'))
+      {
+        ++mPos;
+      }
+    }
+
+    bool readHex_(unsigned& output);
+    static void appendUtf8_(unsigned codePoint, string& output);
+
+    const char* mPos;
+    const char* const mEnd;
+    unsigned mDepth;
+  };
+
+  bool JsonReader::readHex_(unsigned& output)
+  {
+    if (mEnd - mPos < 4)
+    {
+      return false;
+    }
+    output = 0;
+    for (int i = 0; i < 4; ++i, ++mPos)
+    {
+      const char c = *mPos;
+      const unsigned digit = (c >= '0' && c <= '9') ? c - '0'
+          : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+          : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : 16;
+      if (digit > 15)
+      {
+        return false;
+      }
+      output = output * 16 + digit;
+    }
+    return true;
+  }
+
+  void JsonReader::appendUtf8_(unsigned codePoint, string& output)
+  {
+    if (codePoint < 0x80)
+    {
+      output += (char) codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+      output += (char) (0xC0 | (codePoint >> 6));
+      output += (char) (0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+      output += (char) (0xE0 | (codePoint >> 12));
+      output += (char) (0x80 | ((codePoint >> 6) & 0x3F));
+      output += (char) (0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+      output += (char) (0xF0 | (codePoint >> 18));
+      output += (char) (0x80 | ((codePoint >> 12) & 0x3F));
+      output += (char) (0x80 | ((codePoint >> 6) & 0x3F));
+      output += (char) (0x80 | (codePoint & 0x3F));
+    }
+  }
+
+  bool JsonReader::readString(string* output)
+  {
+    if (!accept('"'))
+    {
+      return false;
+    }
+    if (output)
+    {
+      output->clear();
+    }
+
+    while (mPos < mEnd)
+    {
+      // Copy the run up to the next quote or escape at once
+      const char* runEnd = mPos;
+      while (runEnd < mEnd && *runEnd != '"' && *runEnd != '\\')
+      {
+        ++runEnd;
+      }
+      if (output)
+      {
+        output->append(mPos, runEnd - mPos);
+      }
+      mPos = runEnd;
+      if (mPos == mEnd)
+      {
+        break;
+      }
+      if (*mPos++ == '"')
+      {
+        return true;
+      }
+
+      if (mPos == mEnd)
+      {
+        break;
+      }
+      const char escaped = *mPos++;
+      char c;
+      switch (escaped)
+      {
+      case 'b': c = '\b'; break;
+      case 'f': c = '\f'; break;
+      case 'n': c = '\n'; break;
+      case 'r': c = '\r'; break;
+      case 't': c = '\t'; break;
+      case 'u':
+      {
+        unsigned codePoint, low;
+        if (!readHex_(codePoint))
+        {
+          return false;
+        }
+        // Surrogate pair
+        if (codePoint >= 0xD800 && codePoint < 0xDC00 && mEnd - mPos >= 6
+            && mPos[0] == '\\' && mPos[1] == 'u')
+        {
+          mPos += 2;
+          if (!readHex_(low) || low < 0xDC00 || low > 0xDFFF)
+          {
+            return false;
+          }
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+        if (output)
+        {
+          appendUtf8_(codePoint, *output);
+        }
+        continue;
+      }
+      default: c = escaped; break;
+      }
+      if (output)
+      {
+        *output += c;
+      }
+    }
+    return false;
+  }
+
+  bool JsonReader::readNumber(double& output)
+  {
+    skipBlanks_();
+    char buffer[64];
+    size_t size = 0;
+    while (mPos < mEnd && size + 1 < sizeof(buffer)
+           && (isdigit((unsigned char) *mPos) || *mPos == '-' || *mPos == '+' || *mPos == '.'
+               || *mPos == 'e' || *mPos == 'E'))
+    {
+      buffer[size++] = *mPos++;
+    }
+    buffer[size] = '\0';
+
+    char* end;
+    output = strtod(buffer, &end);
+    return size > 0 && end == buffer + size;
+  }
+
+  bool JsonReader::skipValue()
+  {
+    skipBlanks_();
+    if (mPos == mEnd)
+    {
+      return false;
+    }
+
+    switch (*mPos)
+    {
+    case '{':
+      return readObject([this](const string&) { return skipValue(); });
+    case '[':
+      return readArray([this]() { return skipValue(); });
+    case '"':
+      return readString(nullptr);
+    default:
+    {
+      // Number, true, false or null
+      const char* begin = mPos;
+      while (mPos < mEnd && *mPos != ',' && *mPos != '}' && *mPos != ']'
+             && *mPos != ' ' && *mPos != '\n' && *mPos != '\r' && *mPos != '\t')
+      {
+        ++mPos;
+      }
+      return mPos != begin;
+    }
+    }
+  }
+
+  /**
+   * One header entered, times in microseconds
+   */
+  struct Span
+  {
+    double begin;
+    double end;
+    double childTime;   ///< of headers it included directly
+    string path;
+  };
+
+  struct Event
+  {
+    Event(): ts(0), dur(0) {}
+
+    string name;
+    string phase;
+    double ts;
+    double dur;
+    string detail;
+  };
+
+  bool read_event(JsonReader& reader, Event& event)
+  {
+    event.name.clear();
+    event.phase.clear();
+    event.detail.clear();
+    event.ts = event.dur = 0;
+    return reader.readObject([&](const string& key)
+    {
+      if (key == "name")
+      {
+        return reader.readString(&event.name);
+      }
+      else if (key == "ph")
+      {
+        return reader.readString(&event.phase);
+      }
+      else if (key == "ts")
+      {
+        return reader.readNumber(event.ts);
+      }
+      else if (key == "dur")
+      {
+        return reader.readNumber(event.dur);
+      }
+      else if (key == "args")
+      {
+        return reader.readObject([&](const string& argKey)
+        {
+          return (argKey == "detail") ? reader.readString(&event.detail) : reader.skipValue();
+        });
+      }
+      return reader.skipValue();
+    });
+  }
+
+  uint64_t to_us(double time)
+  {
+    return (time > 0) ? (uint64_t) llround(time) : 0;
+  }
+}
+
+bool ParseCost::parse(const char* data, size_t size, CostMap& costs)
+{
+  JsonReader reader(data, size);
+  vector<Span> spans;
+  vector<Span> openSpans;   // async begin events waiting for their end
+  bool isTrace = false;
+  Event event;
+
+  const bool isParsed = reader.readObject([&](const string& key)
+  {
+    if (key != "traceEvents")
+    {
+      return reader.skipValue();
+    }
+
+    isTrace = true;
+    return reader.readArray([&]()
+    {
+      if (!read_event(reader, event))
+      {
+        return false;
+      }
+      if (event.name != "Source")
+      {
+        return true;
+      }
+
+      if (event.phase == "X")
+      {
+        spans.push_back(Span{event.ts, event.ts + event.dur, 0, event.detail});
+      }
+      else if (event.phase == "b")
+      {
+        openSpans.push_back(Span{event.ts, event.ts, 0, event.detail});
+      }
+      else if (event.phase == "e" && !openSpans.empty())
+      {
+        // Includes nest, the last header entered is the one left
+        openSpans.back().end = event.ts;
+        spans.push_back(std::move(openSpans.back()));
+        openSpans.pop_back();
+      }
+      return true;
+    });
+  });
+
+  if (!isParsed || !isTrace)
+  {
+    return false;
+  }
+
+  // Outer spans first, then each span's parent is the innermost open one
+  std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b)
+  {
+    return a.begin < b.begin || (a.begin == b.begin && a.end > b.end);
+  });
+  vector<size_t> parents;
+  for (size_t i = 0; i < spans.size(); ++i)
+  {
+    while (!parents.empty() && spans[parents.back()].end <= spans[i].begin)
+    {
+      parents.pop_back();
+    }
+    if (!parents.empty())
+    {
+      spans[parents.back()].childTime += spans[i].end - spans[i].begin;
+    }
+    parents.push_back(i);
+  }
+
+  for (const Span& span : spans)
+  {
+    Cost& cost = costs[span.path];
+    cost.inclusiveUs += to_us(span.end - span.begin);
+    cost.exclusiveUs += to_us(span.end - span.begin - span.childTime);
+    ++cost.parseCount;
+  }
+  return true;
+}
+
+size_t ParseCost::load(const vector<string>& paths, CostMap& costs)
+{
+  std::mutex costMutex;
+  size_t badFileCount = 0;
+  Common::parallelFor(paths.size(), MIN_CHUNK_FILES, [&](size_t begin, size_t end)
+  {
+    Trace::Scope scope("load time traces", "worker");
+    CostMap localCosts;
+    size_t localBadCount = 0;
+    MappedFile file;
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (!file.open(paths[i], true) || !parse(file.data(), file.size(), localCosts))
+      {
+        LOG_DEBUG("Not a time trace " << paths[i]);
+        ++localBadCount;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(costMutex);
+    badFileCount += localBadCount;
+    for (const auto& pathCost : localCosts)
+    {
+      costs[pathCost.first].add(pathCost.second);
+    }
+  });
+
+  return badFileCount;
+}
+
+size_t ParseCost::getNodeCosts(const CompactGraph& graph, const CostMap& costs,
+                               vector<Cost>& nodeCosts)
+{
+  size_t retVal = 0;
+  nodeCosts.assign(graph.size(), Cost());
+  for (const auto& pathCost : costs)
+  {
+    unsigned id;
+    if (GraphQuery::findFile(graph, pathCost.first, id))
+    {
+      nodeCosts[id].add(pathCost.second);
+    }
+    else
+    {
+      ++retVal;
+    }
+  }
+  return retVal;
+}
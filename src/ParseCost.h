@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_PARSECOST_H_
+#define SRC_PARSECOST_H_
+
+#include "CompactGraph.h"
+
+/**
+ * Header parse times from clang -ftime-trace JSON files, one per TU
+ * Every "Source" event is one header entered by the preprocessor,
+ * inclusive time is its whole span, exclusive time leaves out the
+ * headers it included in turn
+ */
+namespace ParseCost
+{
+  struct Cost
+  {
+    Cost(): inclusiveUs(0), exclusiveUs(0), parseCount(0) {}
+
+    void add(const Cost& other)
+    {
+      inclusiveUs += other.inclusiveUs;
+      exclusiveUs += other.exclusiveUs;
+      parseCount += other.parseCount;
+    }
+
+    uint64_t inclusiveUs;
+    uint64_t exclusiveUs;
+    unsigned parseCount;   ///< times the header was entered, over all TUs
+  };
+
+  typedef map<string, Cost> CostMap;
+
+  /**
+   * Add the header costs of one trace to costs
+   * Both the complete ("X") and the async begin/end ("b"/"e") events
+   * written by different clang versions are read
+   * @return false if data isn't a trace
+   */
+  bool parse(const char* data, size_t size, CostMap& costs);
+
+  /**
+   * Parse trace files on all cores into costs
+   * @return number of files that couldn't be read or aren't traces
+   */
+  size_t load(const vector<string>& paths, CostMap& costs);
+
+  /**
+   * Node weights of graph, trace paths are matched like queries are:
+   * by name, then by basename, so headers sharing a basename add up
+   * @return number of trace headers not in graph
+   */
+  size_t getNodeCosts(const CompactGraph& graph, const CostMap& costs, vector<Cost>& nodeCosts);
+};
+
+#endif /* SRC_PARSECOST_H_ */
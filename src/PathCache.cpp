@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "PathCache.h"
+#include <sys/stat.h>
+
+bool PathCache::identify(const string& path, FileId& id, Kind& kind)
+{
+  struct stat sb;
+  if (0 != stat(path.c_str(), &sb))
+  {
+    return false;
+  }
+
+  id.device = sb.st_dev;
+  id.inode = sb.st_ino;
+  kind = S_ISDIR(sb.st_mode) ? KIND_DIR : S_ISREG(sb.st_mode) ? KIND_FILE : KIND_OTHER;
+  return true;
+}
+
+bool PathCache::markVisited(const FileId& id, const string& path)
+{
+  return mVisited.insert(std::make_pair(id, path)).second;
+}
+
+const string* PathCache::findVisited(const FileId& id) const
+{
+  const auto visitedIt = mVisited.find(id);
+  return (visitedIt == mVisited.end()) ? nullptr : &visitedIt->second;
+}
+
+bool PathCache::canonicalize(const string& path, string& output)
+{
+  auto pathIt = mCanonicalPaths.find(path);
+  if (pathIt == mCanonicalPaths.end())
+  {
+    string canonicalPath;
+    Common::canonicalize(path, canonicalPath);
+    pathIt = mCanonicalPaths.insert(std::make_pair(path, canonicalPath)).first;
+  }
+
+  if (pathIt->second.empty())
+  {
+    return false;
+  }
+  output = pathIt->second;
+  return true;
+}
+
+void PathCache::clear()
+{
+  mVisited.clear();
+  mCanonicalPaths.clear();
+}
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_PATHCACHE_H_
+#define SRC_PATHCACHE_H_
+
+#include "Common.h"
+#include <sys/types.h>
+
+/**
+ * Physical identity of files & dirs met during one traversal, so a tree
+ * reached again through a symlink, hard link or bind mount is taken once
+ * and a symlink cycle ends. Not thread safe, use one per traversal
+ */
+class PathCache
+{
+public:
+  /// (st_dev, st_ino), same for every path of one physical file
+  struct FileId
+  {
+    dev_t device;
+    ino_t inode;
+
+    bool operator<(const FileId& other) const
+    {
+      return (device != other.device) ? device < other.device : inode < other.inode;
+    }
+  };
+
+  enum Kind
+  {
+    KIND_OTHER = 0,
+    KIND_FILE,
+    KIND_DIR
+  };
+
+  /**
+   * stat path, following symlinks
+   * @return false if it can't be stat'ed, e.g. dangling symlink
+   */
+  static bool identify(const string& path, FileId& id, Kind& kind);
+
+  /**
+   * Remember id was reached as path, the first path wins
+   * @return true the first time id is seen
+   */
+  bool markVisited(const FileId& id, const string& path);
+
+  /**
+   * Path id was first visited as, null if it's not visited yet
+   */
+  const string* findVisited(const FileId& id) const;
+
+  /**
+   * Memoized Common::canonicalize
+   * @return false if path can't be resolved
+   */
+  bool canonicalize(const string& path, string& output);
+
+  void clear();
+
+private:
+  map<FileId, string> mVisited;
+  map<string, string> mCanonicalPaths; // empty value if it can't be resolved
+};
+
+#endif /* SRC_PATHCACHE_H_ */
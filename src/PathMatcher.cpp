@@ -0,0 +1,267 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "PathMatcher.h"
+
+/**
+ * Match c against the one char glob item at pos: ? [class] or a literal
+ * @param next Output: position after the item
+ */
+static bool match_char(string_view glob, size_t pos, char c, size_t& next)
+{
+  next = pos + 1;
+  if ('?' == glob[pos])
+  {
+    return true;
+  }
+  else if ('[' != glob[pos])
+  {
+    return glob[pos] == c;
+  }
+
+  // Char class, a [ without its ] is a plain char
+  size_t item = pos + 1;
+  const bool isNegated = (item < glob.size()) && ('!' == glob[item] || '^' == glob[item]);
+  item += isNegated;
+  const size_t close = glob.find(']', item + 1);
+  if (string_view::npos == close)
+  {
+    return '[' == c;
+  }
+
+  bool isMatched = false;
+  for (; item < close; ++item)
+  {
+    if (item + 2 < close && '-' == glob[item + 1])
+    {
+      isMatched |= (glob[item] <= c && c <= glob[item + 2]);
+      item += 2;
+    }
+    else
+    {
+      isMatched |= (glob[item] == c);
+    }
+  }
+  next = close + 1;
+  return isMatched != isNegated;
+}
+
+PathMatcher::PathMatcher(): mNodes(1)
+{
+}
+
+bool PathMatcher::isPattern(const string& entry)
+{
+  return string::npos != entry.find_first_of("*?[");
+}
+
+bool PathMatcher::add(const string& pattern)
+{
+  vector<string> segments;
+  std::istringstream patternStream(pattern);
+  string segment;
+  while (std::getline(patternStream, segment, '/'))
+  {
+    if (!segment.empty() && "." != segment)
+    {
+      segments.push_back(segment);
+    }
+  }
+
+  if (segments.empty())
+  {
+    return false;
+  }
+  else if (string::npos == pattern.find('/'))
+  {
+    // Basename pattern, at any depth
+    segments.insert(segments.begin(), "**");
+  }
+
+  unsigned node = 0;
+  for (const string& item : segments)
+  {
+    node = addChild_(node, item);
+  }
+  mNodes[node].isTerminal = true;
+  return true;
+}
+
+bool PathMatcher::empty() const
+{
+  return 1 == mNodes.size();
+}
+
+void PathMatcher::start(State& output) const
+{
+  output.assign(1, 0);
+  close_(output);
+}
+
+bool PathMatcher::step(const State& state, string_view segment, State& output) const
+{
+  output.clear();
+  for (const unsigned node : state)
+  {
+    const TrieNode& trieNode = mNodes[node];
+    if (trieNode.isAnySegments)
+    {
+      output.push_back(node);
+    }
+
+    const auto literalIt = trieNode.literals.find(segment);
+    if (literalIt != trieNode.literals.end())
+    {
+      output.push_back(literalIt->second);
+    }
+    for (const auto& glob : trieNode.globs)
+    {
+      if (matchSegment_(glob.first, segment))
+      {
+        output.push_back(glob.second);
+      }
+    }
+  }
+  close_(output);
+
+  for (const unsigned node : output)
+  {
+    if (mNodes[node].isTerminal)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PathMatcher::match(string_view path) const
+{
+  State state, next;
+  start(state);
+  bool isMatched = false;
+  while (!path.empty())
+  {
+    const size_t slash = path.find('/');
+    const string_view segment = path.substr(0, slash);
+    path = (string_view::npos == slash) ? string_view() : path.substr(slash + 1);
+    if (segment.empty() || "." == segment)
+    {
+      continue;
+    }
+
+    isMatched = step(state, segment, next);
+    if (isMatched || next.empty())
+    {
+      // A matched dir takes everything under it along
+      break;
+    }
+    state.swap(next);
+  }
+  return isMatched;
+}
+
+unsigned PathMatcher::addChild_(unsigned parent, const string& segment)
+{
+  const unsigned newNode = mNodes.size();
+  if ("**" == segment)
+  {
+    if (mNodes[parent].anySegments < 0)
+    {
+      mNodes[parent].anySegments = newNode;
+      mNodes.push_back(TrieNode());
+      mNodes.back().isAnySegments = true;
+    }
+    return mNodes[parent].anySegments;
+  }
+  else if (!isPattern(segment))
+  {
+    const auto inserted = mNodes[parent].literals.insert(std::make_pair(segment, newNode));
+    if (inserted.second)
+    {
+      mNodes.push_back(TrieNode());
+    }
+    return inserted.first->second;
+  }
+
+  for (const auto& glob : mNodes[parent].globs)
+  {
+    if (glob.first == segment)
+    {
+      return glob.second;
+    }
+  }
+  mNodes[parent].globs.push_back(std::make_pair(segment, newNode));
+  mNodes.push_back(TrieNode());
+  return newNode;
+}
+
+void PathMatcher::close_(State& state) const
+{
+  // ** may take no segment at all, so it's active as soon as its parent is
+  for (size_t index = 0; index < state.size(); ++index)
+  {
+    const int anySegments = mNodes[state[index]].anySegments;
+    if (anySegments >= 0 && state.end() == std::find(state.begin(), state.end(), anySegments))
+    {
+      state.push_back(anySegments);
+    }
+  }
+  std::sort(state.begin(), state.end());
+  state.erase(std::unique(state.begin(), state.end()), state.end());
+}
+
+bool PathMatcher::matchSegment_(string_view glob, string_view segment)
+{
+  // Greedy match, back to the last * on a mismatch
+  size_t globPos = 0, segmentPos = 0;
+  size_t starPos = string_view::npos, starSegmentPos = 0;
+  while (segmentPos < segment.size())
+  {
+    size_t next = 0;
+    if (globPos < glob.size() && '*' == glob[globPos])
+    {
+      starPos = globPos++;
+      starSegmentPos = segmentPos;
+    }
+    else if (globPos < glob.size() && match_char(glob, globPos, segment[segmentPos], next))
+    {
+      globPos = next;
+      ++segmentPos;
+    }
+    else if (string_view::npos != starPos)
+    {
+      globPos = starPos + 1;
+      segmentPos = ++starSegmentPos;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  while (globPos < glob.size() && '*' == glob[globPos])
+  {
+    ++globPos;
+  }
+  return globPos == glob.size();
+}
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_PATHMATCHER_H_
+#define SRC_PATHMATCHER_H_
+
+#include "Common.h"
+
+/**
+ * Glob patterns compiled into one trie of path segments, matched a segment
+ * at a time so a traversal can drop a whole subtree before opening it
+ *   *  ?  [a-z] [!x]  match inside one segment
+ *   **              matches any number of segments, none included
+ * A pattern without '/' matches the basename at any depth, others match
+ * from the start of the path
+ */
+class PathMatcher
+{
+public:
+  /// Active trie nodes after some segments, empty once nothing can match
+  typedef vector<unsigned> State;
+
+  PathMatcher();
+
+  /**
+   * Check if entry is a glob pattern rather than a plain name
+   */
+  static bool isPattern(const string& entry);
+
+  /**
+   * Compile pattern in
+   * @return false if pattern is empty
+   */
+  bool add(const string& pattern);
+
+  bool empty() const;
+
+  /**
+   * State before the first segment
+   */
+  void start(State& output) const;
+
+  /**
+   * Advance state by one segment of a path
+   * @return true if path up to segment matches a pattern
+   */
+  bool step(const State& state, string_view segment, State& output) const;
+
+  /**
+   * Match a whole relative path, same as stepping through its segments
+   */
+  bool match(string_view path) const;
+
+private:
+  struct TrieNode
+  {
+    map<string, unsigned, std::less<> > literals;  // segments without wildcards
+    vector<std::pair<string, unsigned> > globs;     // other segments but **
+    int anySegments;                                // ** child, -1 if none
+    bool isAnySegments;                             // node is a **, takes any segment
+    bool isTerminal;
+
+    TrieNode(): anySegments(-1), isAnySegments(false), isTerminal(false) {}
+  };
+
+  unsigned addChild_(unsigned parent, const string& segment);
+  void close_(State& state) const;
+  static bool matchSegment_(string_view glob, string_view segment);
+
+  vector<TrieNode> mNodes;
+};
+
+#endif /* SRC_PATHMATCHER_H_ */
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "PerfCounters.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+PerfCounters::PerfCounters()
+{
+  for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+  {
+    mFds[counter] = -1;
+  }
+}
+
+PerfCounters::~PerfCounters()
+{
+  close();
+}
+
+bool PerfCounters::open()
+{
+  static const uint64_t CONFIGS[COUNTER_COUNT] =
+  {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+
+  close();
+  int lastErrno = 0;
+  for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = CONFIGS[counter];
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    mFds[counter] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (mFds[counter] < 0)
+    {
+      lastErrno = errno;
+      LOG_DEBUG("Cannot open " << getCounterName((Counter) counter) << " counter: " << strerror(errno));
+    }
+  }
+
+  if (!isOpen())
+  {
+    static bool isWarned = false;
+    if (!isWarned)
+    {
+      isWarned = true;
+      LOG_WARN("Hardware counters unavailable (" << strerror(lastErrno)
+               << "), check /proc/sys/kernel/perf_event_paranoid");
+    }
+    return false;
+  }
+
+  return true;
+}
+
+void PerfCounters::close()
+{
+  for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+  {
+    if (mFds[counter] >= 0)
+    {
+      ::close(mFds[counter]);
+      mFds[counter] = -1;
+    }
+  }
+}
+
+bool PerfCounters::isOpen() const
+{
+  for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+  {
+    if (mFds[counter] >= 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PerfCounters::read(uint64_t values[COUNTER_COUNT]) const
+{
+  for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+  {
+    values[counter] = 0;
+
+    // value, time enabled, time running
+    uint64_t data[3];
+    if (mFds[counter] < 0 || (ssize_t) sizeof(data) != ::read(mFds[counter], data, sizeof(data)))
+    {
+      continue;
+    }
+
+    if (data[2] > 0 && data[2] < data[1])
+    {
+      values[counter] = (uint64_t) ((double) data[0] * data[1] / data[2]);
+    }
+    else
+    {
+      values[counter] = data[0];
+    }
+  }
+}
+
+const char* PerfCounters::getCounterName(Counter counter)
+{
+  static const char* const NAMES[COUNTER_COUNT] =
+  {
+    "cycles", "instructions", "cache_misses", "branch_misses"
+  };
+  return (counter < COUNTER_COUNT) ? NAMES[counter] : "unknown";
+}
@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_PERFCOUNTERS_H_
+#define SRC_PERFCOUNTERS_H_
+
+#include "Common.h"
+#include <stdint.h>
+
+/**
+ * Hardware counters of this process via perf_event_open, user space only
+ * Threads spawned after open() are counted once they're joined
+ * Any counter the kernel refuses is left out, it's never an error
+ */
+class PerfCounters
+{
+public:
+  enum Counter
+  {
+    COUNTER_CYCLES = 0,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT
+  };
+
+  PerfCounters();
+  virtual ~PerfCounters();
+
+  /**
+   * Start counting, warns once if nothing can be counted,
+   * e.g. kernel.perf_event_paranoid too high or no PMU in a VM
+   * @return true if at least 1 counter is open
+   */
+  bool open();
+  void close();
+
+  bool isOpen() const;
+  bool isAvailable(Counter counter) const { return mFds[counter] >= 0; }
+
+  /**
+   * Totals since open(), scaled up if the kernel multiplexed counters,
+   * unavailable counters read 0
+   */
+  void read(uint64_t values[COUNTER_COUNT]) const;
+
+  /**
+   * Snake case name of counter, used as JSON key too
+   */
+  static const char* getCounterName(Counter counter);
+
+private:
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  int mFds[COUNTER_COUNT];
+};
+
+#endif /* SRC_PERFCOUNTERS_H_ */
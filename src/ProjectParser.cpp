@@ -23,9 +23,24 @@
  */
 #include "ProjectParser.h"
 #include <dirent.h>
+#include <errno.h>
 #include <string.h>
+#include <sys/stat.h>
+#include "PathCache.h"
+#include "Trace.h"
 
-static const set<string> HEADER_EXTENSIONS = {".h", ".hpp"};
+// Transparent so extensions are looked up by view, without a copy
+typedef set<string, std::less<> > ExtensionSet;
+static const ExtensionSet HEADER_EXTENSIONS = {".h", ".hpp"};
+static const ExtensionSet SOURCE_EXTENSIONS = {".c", ".cc", ".cpp", ".cxx"};
+
+// Only files scanned slower than this are traced, there are too many otherwise
+static const uint64_t TRACE_MIN_FILE_NS = 100000;
+
+static bool has_extension(const string& path, const ExtensionSet& extensions)
+{
+  return extensions.count(Common::getExtension(path)) > 0;
+}
 
 bool is_header_file(const string& path, bool checkForExist = true)
 {
@@ -34,36 +49,57 @@ bool is_header_file(const string& path, bool checkForExist = true)
     return false;
   }
 
-  for (const string& ext : HEADER_EXTENSIONS)
+  return has_extension(path, HEADER_EXTENSIONS);
+}
+
+bool ProjectParser::isSourceFile(const string& path)
+{
+  return has_extension(path, SOURCE_EXTENSIONS);
+}
+
+static void enter_phase(RunStats* stats, RunStats::Phase phase)
+{
+  if (stats)
   {
-    if (ext.size() > path.size())
-    {
-      continue;
-    }
-    else if (std::equal(ext.rbegin(), ext.rend(), path.rbegin()))
-    {
-      // path ends with ext
-      return true;
-    }
+    stats->enter(phase);
   }
-
-  return false;
 }
 
-void process_header_file(const string& filePath, const set<string>& excludedFiles,
-    Graph& output, Graph& detailOutput)
+/**
+ * Settings of one parse call, handed down the traversal
+ */
+struct ParseContext
 {
-  const string fileName = Common::getBaseName(filePath);
-  Node fileNode(fileName);
-  Node fileRealNode(filePath);
+  const set<string>& excludedFiles;
+  const PathMatcher* excludedPaths;
+  bool scanSources;
+  RunStats* stats;
+  ProjectParser::ScanCache* scanCache;
+  PathCache cache;
+
+  ParseContext(const set<string>& files, const PathMatcher* paths, bool sources,
+               RunStats* runStats, ProjectParser::ScanCache* scans):
+    excludedFiles(files), excludedPaths(paths), scanSources(sources), stats(runStats),
+    scanCache(scans) {}
+};
+
+bool ProjectParser::scanFile(const string& filePath, ScannedFile& output)
+{
+  output = ScannedFile();
+  FILE* file = fopen(filePath.c_str(), "r");
+  if (!file)
+  {
+    LOG_DEBUG("Cannot open " << filePath << ": " << strerror(errno));
+    return false;
+  }
 
   // Only the first 2000 lines of file is process for performance
-  int lineNum = 0;
-  FILE* file = fopen(filePath.c_str(), "r");
+  unsigned lineNum = 0;
   char line[1024];
-
   while (fgets(line, sizeof(line), file) && lineNum++ < 2000)
   {
+    output.byteCount += strlen(line);
+
     // First trim all spaces
     string lineStr = line;
     lineStr.erase(remove_if(lineStr.begin(), lineStr.end(), isspace), lineStr.end());
@@ -85,6 +121,7 @@ void process_header_file(const string& filePath, const set<string>& excludedFile
       }
 
       // Here means it's include msg, let's get the included header
+      ++output.includeCount;
       const char openBracket = sig[sig.size() - 1];
       const char closeBracket = (openBracket == '<')? '>' : openBracket;
       const size_t foundPos = lineStr.find(closeBracket, sig.size());
@@ -95,22 +132,110 @@ void process_header_file(const string& filePath, const set<string>& excludedFile
         continue;
       }
 
-      string includedHeader = lineStr.substr(sig.size(), foundPos - sig.size());
-      if (excludedFiles.end() == excludedFiles.find(includedHeader))
+      output.includes.push_back(
+          std::make_pair(lineStr.substr(sig.size(), foundPos - sig.size()), lineNum));
+    }
+  }
+  fclose(file);
+
+  return true;
+}
+
+std::shared_ptr<const ProjectParser::ScannedFile> ProjectParser::ScanCache::get(
+    const string& filePath, const PathCache::FileId& fileId)
+{
+  struct stat sb;
+  const bool isStated = (0 == stat(filePath.c_str(), &sb));
+  if (isStated)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto entryIt = mEntries.find(fileId);
+    if (entryIt != mEntries.end() && entryIt->second.size == sb.st_size
+        && entryIt->second.mtimeSec == sb.st_mtim.tv_sec
+        && entryIt->second.mtimeNsec == sb.st_mtim.tv_nsec)
+    {
+      ++mHitCount;
+      return entryIt->second.file;
+    }
+  }
+
+  // Scanned unlocked, 2 threads may both scan a file the first time
+  auto scanned = std::make_shared<ScannedFile>();
+  scanFile(filePath, *scanned);
+  if (isStated)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    Entry& entry = mEntries[fileId];
+    entry.size = sb.st_size;
+    entry.mtimeSec = sb.st_mtim.tv_sec;
+    entry.mtimeNsec = sb.st_mtim.tv_nsec;
+    entry.file = scanned;
+    ++mMissCount;
+  }
+  return scanned;
+}
+
+size_t ProjectParser::ScanCache::getHitCount() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mHitCount;
+}
+
+size_t ProjectParser::ScanCache::getMissCount() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mMissCount;
+}
+
+/**
+ * Add includes of filePath into output under nodeId,
+ * headers use their basename, source files their path
+ */
+void process_header_file(const string& filePath, const string& nodeId,
+    const PathCache::FileId& fileId, ParseContext& context, Graph& output, Graph& detailOutput)
+{
+  Node fileNode(nodeId);
+  Node fileRealNode(filePath);
+
+  ProjectParser::ScannedFile localScan;
+  std::shared_ptr<const ProjectParser::ScannedFile> cachedScan;
+  const ProjectParser::ScannedFile* scanned = &localScan;
+  if (context.scanCache)
+  {
+    cachedScan = context.scanCache->get(filePath, fileId);
+    scanned = cachedScan.get();
+  }
+  else
+  {
+    ProjectParser::scanFile(filePath, localScan);
+  }
+
+  for (const auto& include : scanned->includes)
+  {
+    const string& includedName = include.first;
+    if (context.excludedFiles.end() == context.excludedFiles.find(includedName)
+        && !(context.excludedPaths && context.excludedPaths->match(includedName)))
+    {
+      // Only add if not found in excluded set
+      // Also, don't put files that don't have .h or .hpp
+      // in because it's clearly system include files
+      if (is_header_file(includedName, false))
       {
-        // Only add if not found in excluded set
-        // Also, don't put files that don't have .h or .hpp
-        // in because it's clearly system include files
-        if (is_header_file(includedHeader, false))
-        {
-          includedHeader = Common::getBaseName(includedHeader);
-          fileNode.childNodes.insert(includedHeader);
-          fileRealNode.childNodes.insert(includedHeader);
-        }
+        const string includedHeader(Common::getBaseName(includedName));
+        fileNode.childNodes.insert(includedHeader);
+        fileRealNode.childNodes.insert(includedHeader);
+        fileNode.childLines.insert(std::make_pair(includedHeader, include.second));
+        fileRealNode.childLines.insert(std::make_pair(includedHeader, include.second));
       }
     }
   }
-  fclose(file);
+
+  if (context.stats)
+  {
+    ++context.stats->fileCount;
+    context.stats->byteCount += scanned->byteCount;
+    context.stats->includeCount += scanned->includeCount;
+  }
 
   // Let's update detail output first before combining duplicates
   detailOutput.insert(fileRealNode);
@@ -123,6 +248,8 @@ void process_header_file(const string& filePath, const set<string>& excludedFile
   {
     fileNode.childNodes.insert(outputNodeIt->childNodes.begin(),
                                outputNodeIt->childNodes.end());
+    fileNode.childLines.insert(outputNodeIt->childLines.begin(),
+                               outputNodeIt->childLines.end());
     output.erase(outputNodeIt);
   }
   output.insert(fileNode);
@@ -139,20 +266,102 @@ void process_header_file(const string& filePath, const set<string>& excludedFile
 }
 
 /**
- * Recursively find in dirPath for eligible header files
+ * Identify entry of a dir, regular files come straight from the dirent,
+ * dirs are identified once they're entered, the rest needs a stat to
+ * follow symlinks
+ * @return false if entry should be skipped
+ */
+static bool identify_entry(const struct dirent* entry, const string& itemPath,
+    const PathCache::FileId& dirId, PathCache::FileId& itemId, PathCache::Kind& kind)
+{
+  switch (entry->d_type)
+  {
+  case DT_REG:
+    itemId.device = dirId.device;
+    itemId.inode = entry->d_ino;
+    kind = PathCache::KIND_FILE;
+    return true;
+  case DT_DIR:
+    kind = PathCache::KIND_DIR;
+    return true;
+  case DT_LNK:
+  case DT_UNKNOWN:
+    return PathCache::identify(itemPath, itemId, kind);
+  default:
+    return false;
+  }
+}
+
+/**
+ * Canonical path of a dir entry, the canonical dir plus its name unless
+ * the entry is a symlink itself, then it's resolved on its own
+ */
+static string get_canonical_path(PathCache& cache, const string& canonicalDir,
+    const string& itemPath, const string& itemName, const struct dirent* entry)
+{
+  string retVal;
+  if (entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN)
+  {
+    retVal = canonicalDir + "/" + itemName;
+  }
+  else if (!cache.canonicalize(itemPath, retVal))
+  {
+    retVal = itemPath;
+  }
+  return retVal;
+}
+
+/**
+ * Mark file visited, a file reached again under its first basename is
+ * skipped, under another basename it's a node of its own
+ * @return true if file is to be scanned
+ */
+static bool visit_file(const string& filePath, const PathCache::FileId& fileId, PathCache& cache)
+{
+  const string* firstPath = cache.findVisited(fileId);
+  if (!firstPath)
+  {
+    cache.markVisited(fileId, filePath);
+    return true;
+  }
+  else if (Common::getBaseName(*firstPath) != Common::getBaseName(filePath))
+  {
+    return true;
+  }
+
+  LOG_DEBUG("Skipping " << filePath << ", same file as " << *firstPath);
+  return false;
+}
+
+/**
+ * Recursively find in dirPath for eligible header files, every physical
+ * dir & file is only taken once
+ * canonicalDir is dirPath resolved, files are reported under it
  * @return same as ProjectParser::parse
  */
-int parse_one_dir(const string& dirPath, const set<string>& excludedFiles,
-    Graph& output, ProjectParser::HeaderLocationMap& headerFullPathMap, Graph& detailOutput)
+int parse_one_dir(const string& dirPath, const string& canonicalDir,
+    const PathMatcher::State& matchState, ParseContext& context, Graph& output,
+    ProjectParser::HeaderLocationMap& headerFullPathMap, Graph& detailOutput)
 {
+  PathCache& cache = context.cache;
+  RunStats* stats = context.stats;
   int retVal = 0;
   // check for existence
-  if (!Common::isDirExist(dirPath))
+  PathCache::FileId dirId;
+  PathCache::Kind dirKind;
+  if (!PathCache::identify(dirPath, dirId, dirKind) || PathCache::KIND_DIR != dirKind)
   {
     return 1;
   }
+  else if (!cache.markVisited(dirId, dirPath))
+  {
+    // Reached already, through a symlink or bind mount
+    LOG_DEBUG("Skipping " << dirPath << ", same dir as " << *cache.findVisited(dirId));
+    return 0;
+  }
 
   // Iterate thru dir
+  Trace::Scope traceScope("scan dir", "parser", dirPath.c_str());
   DIR *d;
   struct dirent *dir;
   d = opendir(dirPath.c_str());
@@ -162,15 +371,32 @@ int parse_one_dir(const string& dirPath, const set<string>& excludedFiles,
     {
       const string itemName = dir->d_name;
       const string itemPath = dirPath + "/" + itemName;
+      PathCache::FileId itemId;
+      PathCache::Kind itemKind;
+      PathMatcher::State itemMatchState;
       if (itemName == "." || itemName == "..")
       {
         continue;
       }
+      else if (context.excludedPaths
+               && context.excludedPaths->step(matchState, itemName, itemMatchState))
+      {
+        // Excluded subtrees are never opened
+        LOG_DEBUG("Excluding " << itemPath);
+        continue;
+      }
+      else if (!identify_entry(dir, itemPath, dirId, itemId, itemKind))
+      {
+        continue;
+      }
 
-      if (Common::isDirExist(itemPath))
+      if (PathCache::KIND_DIR == itemKind)
       {
-        const int parseVal = parse_one_dir(itemPath, excludedFiles, output,
-                                            headerFullPathMap, detailOutput);
+        // Only a symlinked dir needs resolving, others extend the parent's path
+        const string childCanonicalDir = get_canonical_path(cache, canonicalDir, itemPath,
+                                                            itemName, dir);
+        const int parseVal = parse_one_dir(itemPath, childCanonicalDir, itemMatchState, context,
+                                           output, headerFullPathMap, detailOutput);
         if (parseVal < 0)
         {
           retVal = parseVal;
@@ -182,19 +408,43 @@ int parse_one_dir(const string& dirPath, const set<string>& excludedFiles,
           continue;
         }
       }
-      else if (is_header_file(itemPath))
+      else if (PathCache::KIND_FILE != itemKind)
       {
-        const string headerBasename = Common::getBaseName(itemPath);
-        if (excludedFiles.end() == excludedFiles.find(headerBasename))
+        continue;
+      }
+      else if (is_header_file(itemPath, false))
+      {
+        const string headerBasename(Common::getBaseName(itemPath));
+        if (context.excludedFiles.end() == context.excludedFiles.find(headerBasename)
+            && visit_file(itemPath, itemId, cache))
         {
-          headerFullPathMap[headerBasename].insert(itemPath);
-          process_header_file(itemPath, excludedFiles, output, detailOutput);
+          const string filePath = get_canonical_path(cache, canonicalDir, itemPath, itemName, dir);
+          headerFullPathMap[headerBasename].insert(filePath);
+          enter_phase(stats, RunStats::PHASE_SCAN);
+          {
+            Trace::Scope fileScope("scan file", "parser", filePath.c_str(), TRACE_MIN_FILE_NS);
+            process_header_file(filePath, headerBasename, itemId, context, output, detailOutput);
+          }
+          enter_phase(stats, RunStats::PHASE_TRAVERSAL);
         }
         else
         {
           continue;
         }
       }
+      else if (context.scanSources && ProjectParser::isSourceFile(itemPath)
+               && visit_file(itemPath, itemId, cache))
+      {
+        // Nothing includes a source file, so key it by path to keep
+        // same named files apart
+        const string filePath = get_canonical_path(cache, canonicalDir, itemPath, itemName, dir);
+        enter_phase(stats, RunStats::PHASE_SCAN);
+        {
+          Trace::Scope fileScope("scan file", "parser", filePath.c_str(), TRACE_MIN_FILE_NS);
+          process_header_file(filePath, itemPath, itemId, context, output, detailOutput);
+        }
+        enter_phase(stats, RunStats::PHASE_TRAVERSAL);
+      }
       else
       {
         continue;
@@ -208,13 +458,20 @@ int parse_one_dir(const string& dirPath, const set<string>& excludedFiles,
 }
 
 int ProjectParser::parse(const set<string>& parseDirs, const set<string>& excludedFiles,
-    Graph& output, Graph& detailOutput, HeaderLocationMap& outputLocationMap)
+    Graph& output, Graph& detailOutput, HeaderLocationMap& outputLocationMap, bool scanSources,
+    RunStats* stats, const PathMatcher* excludedPaths, ScanCache* scanCache)
 {
   int retVal = 0;
   output.clear();
   outputLocationMap.clear();
   detailOutput.clear();
   Graph tmpOutput;
+  ParseContext context(excludedFiles, excludedPaths, scanSources, stats, scanCache);
+  PathMatcher::State startState;
+  if (excludedPaths)
+  {
+    excludedPaths->start(startState);
+  }
 
   // This map keeps track of duplicate items
   // which may cause unwanted result since spinclude
@@ -223,10 +480,14 @@ int ProjectParser::parse(const set<string>& parseDirs, const set<string>& exclud
   {
     // Report
     Common::printSeparator(2, true);
-    LOG_DEBUG("Parsing " << Common::getRealPath(dirName));
+    string realPath = dirName;
+    context.cache.canonicalize(dirName, realPath);
+    LOG_DEBUG("Parsing " << realPath);
     Common::printSeparator(2, true);
 
-    int helperRetval = parse_one_dir(dirName, excludedFiles, tmpOutput, outputLocationMap, detailOutput);
+    enter_phase(stats, RunStats::PHASE_TRAVERSAL);
+    int helperRetval = parse_one_dir(dirName, realPath, startState, context, tmpOutput,
+                                     outputLocationMap, detailOutput);
     if (0 > helperRetval)
     {
       // Only stop if we hit critical error
@@ -241,6 +502,7 @@ int ProjectParser::parse(const set<string>& parseDirs, const set<string>& exclud
   }
 
   // Check for duplicate basename
+  enter_phase(stats, RunStats::PHASE_MERGE);
   int totalDupBasename = 0;
   for (const auto& nameSet : outputLocationMap)
   {
@@ -272,12 +534,17 @@ int ProjectParser::parse(const set<string>& parseDirs, const set<string>& exclud
   HeaderLocationMap tossedOutMap;
   for (auto node: tmpOutput)
   {
-    for (const string& childId : node.childNodes)
+    for (auto childIt = node.childNodes.begin(); childIt != node.childNodes.end();)
     {
-      if (idMap.end() == idMap.find(childId))
+      if (idMap.end() == idMap.find(*childIt))
+      {
+        tossedOutMap[*childIt].insert(node.id);
+        node.childLines.erase(*childIt);
+        childIt = node.childNodes.erase(childIt);
+      }
+      else
       {
-        tossedOutMap[childId].insert(node.id);
-        node.childNodes.erase(childId);
+        ++childIt;
       }
     }
 
@@ -313,9 +580,27 @@ int ProjectParser::parse(const set<string>& parseDirs, const set<string>& exclud
   return retVal;
 }
 
-int generateHeaderList_helper(const string& dirPath, set<string>& headerFiles)
+/**
+ * Recursively find in dirPath for eligible header files, a header reached
+ * through symlinked dirs is listed under every path so includes spelled
+ * either way are excluded. Only a dir that's its own ancestor is skipped
+ * @return same as ProjectParser::parse
+ */
+int generateHeaderList_helper(const string& dirPath, set<string>& headerFiles,
+                              set<PathCache::FileId>& ancestorIds)
 {
   int retVal = 0;
+  PathCache::FileId dirId;
+  PathCache::Kind dirKind;
+  if (!PathCache::identify(dirPath, dirId, dirKind) || PathCache::KIND_DIR != dirKind)
+  {
+    return retVal;
+  }
+  else if (!ancestorIds.insert(dirId).second)
+  {
+    LOG_DEBUG("Skipping " << dirPath << ", symlink cycle");
+    return retVal;
+  }
 
   DIR *d;
   struct dirent *dir;
@@ -331,11 +616,17 @@ int generateHeaderList_helper(const string& dirPath, set<string>& headerFiles)
         continue;
       }
 
-      if (Common::isDirExist(itemPath))
+      PathCache::FileId itemId;
+      PathCache::Kind itemKind;
+      if (!identify_entry(dir, itemPath, dirId, itemId, itemKind))
       {
-        retVal += generateHeaderList_helper(itemPath, headerFiles);
+        continue;
+      }
+      else if (PathCache::KIND_DIR == itemKind)
+      {
+        retVal += generateHeaderList_helper(itemPath, headerFiles, ancestorIds);
       }
-      else if (is_header_file(itemPath))
+      else if (PathCache::KIND_FILE == itemKind && is_header_file(itemPath, false))
       {
         headerFiles.insert(itemPath);
       }
@@ -347,9 +638,26 @@ int generateHeaderList_helper(const string& dirPath, set<string>& headerFiles)
     closedir(d);
   }
 
+  ancestorIds.erase(dirId);
   return retVal;
 }
 
+void ProjectParser::splitExcludes(const set<string>& entries, set<string>& plainOutput,
+                                  PathMatcher& patterns)
+{
+  for (const string& entry : entries)
+  {
+    if (PathMatcher::isPattern(entry))
+    {
+      patterns.add(entry);
+    }
+    else
+    {
+      plainOutput.insert(entry);
+    }
+  }
+}
+
 int ProjectParser::generateHeaderList(const set<string>& dirs, set<string>& headerFiles)
 {
   int retVal = 0;
@@ -358,9 +666,10 @@ int ProjectParser::generateHeaderList(const set<string>& dirs, set<string>& head
   for (const string& dirPath : dirs)
   {
     set<string> fullPathHeaders = {};
+    set<PathCache::FileId> ancestorIds;
     if (Common::isDirExist(dirPath))
     {
-      retVal += generateHeaderList_helper(dirPath, fullPathHeaders);
+      retVal += generateHeaderList_helper(dirPath, fullPathHeaders, ancestorIds);
     }
 
     // Make header files relative path
@@ -25,12 +25,60 @@
 #define SRC_PROJECTPARSER_H_
 
 #include "DataStructure.h"
+#include "PathCache.h"
+#include "PathMatcher.h"
+#include "RunStats.h"
+#include <mutex>
 
 namespace ProjectParser
 {
-  /// map<header> = set<header path>
+  /// map<header> = set<canonical header path>
   typedef map<string,set<string> > HeaderLocationMap;
 
+  /**
+   * Include directives of one file as written, before any exclusion
+   */
+  struct ScannedFile
+  {
+    vector<std::pair<string, unsigned> > includes; // included name, line
+    uint64_t byteCount;
+    uint64_t includeCount;  // directives, parsed or not
+
+    ScannedFile(): byteCount(0), includeCount(0) {}
+  };
+
+  /**
+   * Scanned files by (st_dev, st_ino), rescanned once size or mtime
+   * changes, so parses of overlapping projects read each file once.
+   * Thread safe
+   */
+  class ScanCache
+  {
+  public:
+    ScanCache(): mHitCount(0), mMissCount(0) {}
+
+    /**
+     * Scan of filePath, from cache if it's unchanged
+     */
+    std::shared_ptr<const ScannedFile> get(const string& filePath, const PathCache::FileId& fileId);
+
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+
+  private:
+    struct Entry
+    {
+      off_t size;
+      time_t mtimeSec;
+      long mtimeNsec;
+      std::shared_ptr<const ScannedFile> file;
+    };
+
+    mutable std::mutex mMutex;
+    map<PathCache::FileId, Entry> mEntries;
+    size_t mHitCount, mMissCount;
+  };
+
   /**
    * This is the C/C++ header parser
    * @param parseDirs     Input: set of dirs to search recursively
@@ -41,6 +89,14 @@ namespace ProjectParser
    *                              has unique path
    * @param outputLocationMap Output: relative path to header files in output
    *                          ideally set<header path> should have size 1
+   * @param scanSources   Input: also add .c/.cpp files to output, keyed by
+   *                             their path instead of basename
+   * @param stats         Output: optional, gets traversal/scan/merge times
+   *                              and file, byte & include counts added
+   * @param excludedPaths Input: optional, paths relative to each parseDir
+   *                             that aren't opened, includes are dropped
+   *                             if they match as written
+   * @param scanCache     Input/Output: optional, shared scans of files
    * @return 0 on success, other err code are bitwise updated
    *         1 if 1 of parseDirs not exists
    *         2 if no headers in all dirs
@@ -49,7 +105,25 @@ namespace ProjectParser
    *         <0 on critical error
    */
   int parse(const set<string>& parseDirs, const set<string>& excludedFiles,
-      Graph& output, Graph& detailOutput, HeaderLocationMap& outputLocationMap);
+      Graph& output, Graph& detailOutput, HeaderLocationMap& outputLocationMap,
+      bool scanSources = false, RunStats* stats = nullptr,
+      const PathMatcher* excludedPaths = nullptr, ScanCache* scanCache = nullptr);
+
+  /**
+   * Read include directives of one file, only its first 2000 lines
+   * @return false if file can't be opened
+   */
+  bool scanFile(const string& filePath, ScannedFile& output);
+
+  /**
+   * Check if path is a translation unit (.c, .cpp, ...) by its extension
+   */
+  bool isSourceFile(const string& path);
+
+  /**
+   * Split cfg exclude entries, globs are added to patterns
+   */
+  void splitExcludes(const set<string>& entries, set<string>& plainOutput, PathMatcher& patterns);
 
   /**
    * Recursively get header files inside dirs
@@ -0,0 +1,496 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "QueryServer.h"
+#include "GraphQuery.h"
+#include "ProjectParser.h"
+#include "TarjanSolver.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <thread>
+
+namespace
+{
+  // Requests are a few names, responses may list a whole graph
+  const size_t MAX_REQUEST_SIZE = 1 << 20;
+  const size_t MAX_RESPONSE_SIZE = 1 << 30;
+  const int LISTEN_BACKLOG = 64;
+
+  bool make_address(const string& socketPath, struct sockaddr_un& address)
+  {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+      LOG_ERROR("Socket path too long " << socketPath);
+      return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+  }
+
+  int connect_to(const string& socketPath)
+  {
+    struct sockaddr_un address;
+    if (!make_address(socketPath, address))
+    {
+      return -1;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+      return -1;
+    }
+    if (0 != connect(fd, (struct sockaddr*)&address, sizeof(address)))
+    {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  void put_u32(string& payload, uint32_t value)
+  {
+    payload.append((const char*)&value, sizeof(value));
+  }
+
+  bool get_u32(const string& payload, size_t& pos, uint32_t& value)
+  {
+    if (payload.size() - pos < sizeof(value))
+    {
+      return false;
+    }
+    memcpy(&value, payload.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+  }
+
+  bool get_string(const string& payload, size_t& pos, string& value)
+  {
+    const size_t end = payload.find('\0', pos);
+    if (end == string::npos)
+    {
+      return false;
+    }
+    value.assign(payload, pos, end - pos);
+    pos = end + 1;
+    return true;
+  }
+}
+
+QueryServer::QueryServer(CompactGraph& graph):
+  mGraph(graph), mDag(graph), mSourceCount(0), mListenFd(-1), mIsStopped(false),
+  mRequestCount(0), mStartTime(std::chrono::steady_clock::now())
+{
+}
+
+QueryServer::~QueryServer()
+{
+  if (mListenFd >= 0)
+  {
+    close(mListenFd);
+    unlink(mSocketPath.c_str());
+  }
+}
+
+bool QueryServer::prepare()
+{
+  TarjanSolver solver(mGraph);
+  set<set<string> > solution;
+  SccNameCollector collector(solver, solution);
+  if (!solver.solve(collector) || !mDag.solve())
+  {
+    LOG_ERROR("Cannot solve graph to serve");
+    return false;
+  }
+  CycleBaseline::fromSolution(solution, mCycles);
+
+  mGraph.generateParents();
+  mIndex.reset(new ReachabilityIndex(mDag));
+  mIndex->build();
+
+  for (unsigned id = 0; id < mGraph.size(); ++id)
+  {
+    mSourceCount += ProjectParser::isSourceFile(mGraph.name(id));
+  }
+  return true;
+}
+
+bool QueryServer::listen(const string& socketPath)
+{
+  struct sockaddr_un address;
+  if (!make_address(socketPath, address))
+  {
+    return false;
+  }
+
+  // A socket file left by a dead server is replaced, a live one is kept
+  struct stat sb;
+  if (0 == lstat(socketPath.c_str(), &sb) && S_ISSOCK(sb.st_mode))
+  {
+    const int fd = connect_to(socketPath);
+    if (fd >= 0)
+    {
+      close(fd);
+      LOG_ERROR("Another server is listening on " << socketPath);
+      return false;
+    }
+    unlink(socketPath.c_str());
+  }
+
+  mListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (mListenFd < 0
+      || 0 != bind(mListenFd, (struct sockaddr*)&address, sizeof(address)))
+  {
+    LOG_ERROR("Cannot bind " << socketPath << ": " << strerror(errno));
+    if (mListenFd >= 0)
+    {
+      close(mListenFd);
+      mListenFd = -1;
+    }
+    return false;
+  }
+
+  mSocketPath = socketPath;
+  if (0 != ::listen(mListenFd, LISTEN_BACKLOG))
+  {
+    LOG_ERROR("Cannot listen on " << socketPath << ": " << strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void QueryServer::serve()
+{
+  while (!mIsStopped)
+  {
+    const int fd = accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0)
+    {
+      if (errno != EINTR && errno != ECONNABORTED && !mIsStopped)
+      {
+        LOG_ERROR("Accept failed: " << strerror(errno));
+        break;
+      }
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mConnectionFds.insert(fd);
+    std::thread([this, fd]() { serveConnection_(fd); }).detach();
+  }
+
+  // Wake connections blocked on read, then wait for their threads
+  std::unique_lock<std::mutex> lock(mMutex);
+  for (const int fd : mConnectionFds)
+  {
+    shutdown(fd, SHUT_RDWR);
+  }
+  mIdle.wait(lock, [this]() { return mConnectionFds.empty(); });
+}
+
+void QueryServer::stop()
+{
+  mIsStopped = true;
+  if (mListenFd >= 0)
+  {
+    shutdown(mListenFd, SHUT_RDWR);
+  }
+}
+
+void QueryServer::serveConnection_(int fd)
+{
+  string request, payload;
+  Response response;
+  while (readFrame_(fd, request, MAX_REQUEST_SIZE))
+  {
+    ++mRequestCount;
+    answer(request, response);
+    encodeResponse(response, payload);
+    if (!writeFrame_(fd, payload))
+    {
+      break;
+    }
+  }
+
+  // Leave the set before the fd number can be reused by accept, and
+  // touch nothing of this once serve() may return
+  std::lock_guard<std::mutex> lock(mMutex);
+  mConnectionFds.erase(fd);
+  close(fd);
+  mIdle.notify_all();
+}
+
+void QueryServer::addIds_(const vector<unsigned>& ids, Response& response) const
+{
+  response.records.push_back(vector<string>());
+  vector<string>& record = response.records.back();
+  record.reserve(ids.size());
+  for (const unsigned id : ids)
+  {
+    record.push_back(mGraph.name(id));
+  }
+}
+
+void QueryServer::answer(const string& request, Response& response) const
+{
+  response = Response();
+  vector<string> args;
+  size_t pos = 1;
+  string arg;
+  while (pos < request.size() && get_string(request, pos, arg))
+  {
+    args.push_back(arg);
+  }
+  if (request.empty() || pos != request.size())
+  {
+    response.status = STATUS_BAD_REQUEST;
+    return;
+  }
+
+  switch (request[0])
+  {
+  case OP_CYCLES:
+    response.records = mCycles;
+    break;
+  case OP_IMPACT:
+  {
+    vector<unsigned> changedIds, affectedIds;
+    for (const string& file : args)
+    {
+      unsigned id;
+      if (GraphQuery::findFile(mGraph, file, id))
+      {
+        changedIds.push_back(id);
+      }
+    }
+    if (changedIds.empty() && !args.empty())
+    {
+      response.status = STATUS_NOT_FOUND;
+      break;
+    }
+    GraphQuery::getDependents(mGraph, changedIds, affectedIds);
+    addIds_(affectedIds, response);
+    break;
+  }
+  case OP_CLOSURE:
+  {
+    unsigned id;
+    if (args.size() != 1)
+    {
+      response.status = STATUS_BAD_REQUEST;
+    }
+    else if (!GraphQuery::findFile(mGraph, args[0], id))
+    {
+      response.status = STATUS_NOT_FOUND;
+    }
+    else
+    {
+      vector<unsigned> closure;
+      mIndex->getClosure(id, closure);
+      addIds_(closure, response);
+    }
+    break;
+  }
+  case OP_CHAIN:
+  {
+    unsigned from, to;
+    vector<unsigned> chain;
+    if (args.size() != 2)
+    {
+      response.status = STATUS_BAD_REQUEST;
+    }
+    else if (!GraphQuery::findFile(mGraph, args[0], from)
+             || !GraphQuery::findFile(mGraph, args[1], to)
+             || !mIndex->reaches(from, to)
+             || !GraphQuery::getShortestChain(mGraph, from, to, chain))
+    {
+      response.status = STATUS_NOT_FOUND;
+    }
+    else
+    {
+      addIds_(chain, response);
+    }
+    break;
+  }
+  case OP_STATS:
+  {
+    const auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - mStartTime).count();
+    response.records.push_back({
+      "headers=" + std::to_string(mGraph.size() - mSourceCount),
+      "sources=" + std::to_string(mSourceCount),
+      "includes=" + std::to_string(mGraph.edgeCount()),
+      "circles=" + std::to_string(mCycles.size()),
+      "requests=" + std::to_string(mRequestCount.load()),
+      "uptime=" + std::to_string(uptime)
+    });
+    break;
+  }
+  default:
+    response.status = STATUS_BAD_REQUEST;
+    break;
+  }
+}
+
+bool QueryServer::ask(const string& socketPath, Op op, const vector<string>& args,
+                      Response& response)
+{
+  const int fd = connect_to(socketPath);
+  if (fd < 0)
+  {
+    LOG_ERROR("Cannot connect to " << socketPath << ": " << strerror(errno));
+    return false;
+  }
+
+  string payload;
+  encodeRequest(op, args, payload);
+  const bool isAnswered = writeFrame_(fd, payload)
+      && readFrame_(fd, payload, MAX_RESPONSE_SIZE) && decodeResponse(payload, response);
+  close(fd);
+  if (!isAnswered)
+  {
+    LOG_ERROR("Bad response from " << socketPath);
+  }
+  return isAnswered;
+}
+
+void QueryServer::encodeRequest(Op op, const vector<string>& args, string& payload)
+{
+  payload.assign(1, (char)op);
+  for (const string& arg : args)
+  {
+    payload.append(arg.c_str(), arg.size() + 1);
+  }
+}
+
+void QueryServer::encodeResponse(const Response& response, string& payload)
+{
+  payload.assign(1, (char)response.status);
+  put_u32(payload, response.records.size());
+  for (const auto& record : response.records)
+  {
+    put_u32(payload, record.size());
+    for (const string& item : record)
+    {
+      payload.append(item.c_str(), item.size() + 1);
+    }
+  }
+}
+
+bool QueryServer::decodeResponse(const string& payload, Response& response)
+{
+  response = Response();
+  size_t pos = 1;
+  uint32_t recordCount;
+  if (payload.empty() || !get_u32(payload, pos, recordCount))
+  {
+    return false;
+  }
+  response.status = payload[0];
+
+  for (uint32_t i = 0; i < recordCount; ++i)
+  {
+    uint32_t itemCount;
+    if (!get_u32(payload, pos, itemCount) || itemCount > payload.size() - pos)
+    {
+      return false;
+    }
+    response.records.push_back(vector<string>(itemCount));
+    for (string& item : response.records.back())
+    {
+      if (!get_string(payload, pos, item))
+      {
+        return false;
+      }
+    }
+  }
+  return pos == payload.size();
+}
+
+bool QueryServer::readFrame_(int fd, string& payload, size_t maxSize)
+{
+  uint32_t size;
+  char* target = (char*)&size;
+  size_t left = sizeof(size);
+  for (int part = 0; part < 2; ++part)
+  {
+    while (left > 0)
+    {
+      const ssize_t readSize = read(fd, target, left);
+      if (readSize <= 0)
+      {
+        if (readSize < 0 && errno == EINTR)
+        {
+          continue;
+        }
+        return false;
+      }
+      target += readSize;
+      left -= readSize;
+    }
+
+    if (part == 0)
+    {
+      if (size > maxSize)
+      {
+        LOG_WARN("Frame of " << size << " bytes is too big");
+        return false;
+      }
+      payload.resize(size);
+      target = &payload[0];
+      left = size;
+    }
+  }
+  return true;
+}
+
+bool QueryServer::writeFrame_(int fd, const string& payload)
+{
+  string frame;
+  put_u32(frame, payload.size());
+  frame += payload;
+
+  const char* source = frame.data();
+  size_t left = frame.size();
+  while (left > 0)
+  {
+    const ssize_t writeSize = send(fd, source, left, MSG_NOSIGNAL);
+    if (writeSize < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    source += writeSize;
+    left -= writeSize;
+  }
+  return true;
+}
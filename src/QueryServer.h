@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_QUERYSERVER_H_
+#define SRC_QUERYSERVER_H_
+
+#include "CompactGraph.h"
+#include "Condensation.h"
+#include "CycleBaseline.h"
+#include "ReachabilityIndex.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * Keeps a solved graph resident and answers queries on a Unix socket
+ *
+ * Every frame is a host order uint32 payload size then the payload
+ *  request:  uint8 op, then NUL terminated string arguments
+ *  response: uint8 status, uint32 record count, then per record a uint32
+ *            item count and NUL terminated items
+ * A connection may send any number of requests. Everything queried is
+ * built before serving, so connections are answered in parallel unlocked
+ */
+class QueryServer
+{
+public:
+  enum Op
+  {
+    OP_CYCLES = 1,    // no argument, 1 record per circle
+    OP_IMPACT,        // changed files, 1 record of dependents
+    OP_CLOSURE,       // header, 1 record of headers it includes
+    OP_CHAIN,         // header from & to, 1 record of the shortest include chain
+    OP_STATS          // no argument, 1 record of "key=value"
+  };
+
+  enum Status
+  {
+    STATUS_OK = 0,
+    STATUS_NOT_FOUND,   // unknown file or no chain
+    STATUS_BAD_REQUEST
+  };
+
+  struct Response
+  {
+    uint8_t status;
+    vector<vector<string> > records;
+
+    Response(): status(STATUS_OK) {}
+  };
+
+  /**
+   * @param graph must outlive the server, parents are generated on it
+   */
+  QueryServer(CompactGraph& graph);
+  virtual ~QueryServer();
+
+  /**
+   * Solve circles and build the indexes queries need
+   * @return true on success
+   */
+  bool prepare();
+
+  /**
+   * Bind socketPath, a stale socket file nobody listens on is replaced
+   * @return true on success
+   */
+  bool listen(const string& socketPath);
+
+  /**
+   * Accept connections until stop(), 1 thread each
+   */
+  void serve();
+
+  /**
+   * Make serve() return once open connections are closed, signal safe
+   */
+  void stop();
+
+  /**
+   * Answer one request payload
+   */
+  void answer(const string& request, Response& response) const;
+
+  /**
+   * Send one request to a server and wait for its response
+   * @return false on connection or protocol error
+   */
+  static bool ask(const string& socketPath, Op op, const vector<string>& args,
+                  Response& response);
+
+  static void encodeRequest(Op op, const vector<string>& args, string& payload);
+  static void encodeResponse(const Response& response, string& payload);
+  static bool decodeResponse(const string& payload, Response& response);
+
+private:
+  void serveConnection_(int fd);
+  void addIds_(const vector<unsigned>& ids, Response& response) const;
+
+  static bool readFrame_(int fd, string& payload, size_t maxSize);
+  static bool writeFrame_(int fd, const string& payload);
+
+  QueryServer(const QueryServer&) = delete;
+  QueryServer& operator=(const QueryServer&) = delete;
+
+private:
+  CompactGraph& mGraph;
+  Condensation mDag;
+  std::unique_ptr<ReachabilityIndex> mIndex;
+  CycleBaseline::CycleList mCycles;
+  size_t mSourceCount;
+
+  string mSocketPath;
+  int mListenFd;
+  std::atomic<bool> mIsStopped;
+  std::atomic<uint64_t> mRequestCount;
+  std::chrono::steady_clock::time_point mStartTime;
+
+  // Open connections, closed by stop()
+  std::mutex mMutex;
+  std::condition_variable mIdle;
+  set<int> mConnectionFds;
+};
+
+#endif /* SRC_QUERYSERVER_H_ */
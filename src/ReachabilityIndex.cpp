@@ -0,0 +1,310 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "ReachabilityIndex.h"
+#include "Trace.h"
+
+// Fewer components than this per thread aren't worth a thread spawn
+static const size_t PARALLEL_MIN_CHUNK = 256;
+
+static inline void or_words(uint64_t* dst, const uint64_t* src, size_t count)
+{
+  // Plain loop on purpose, the compiler vectorizes this
+  for (size_t i = 0; i < count; ++i)
+  {
+    dst[i] |= src[i];
+  }
+}
+
+static inline bool test_bit(const vector<uint64_t>& bits, unsigned pos)
+{
+  return (bits[pos >> 6] >> (pos & 63)) & 1;
+}
+
+ReachabilityIndex::ReachabilityIndex(const Condensation& dag, size_t memoryBudget):
+    mDag(dag), mMemoryBudget(memoryBudget), mUsedBytes(0)
+{
+  mWordCount = 0;
+  isBuilt = false;
+}
+
+ReachabilityIndex::~ReachabilityIndex()
+{
+}
+
+bool ReachabilityIndex::build()
+{
+  if (isBuilt)
+  {
+    return true;
+  }
+
+  const size_t compCount = mDag.componentCount();
+  mWordCount = (compCount + 63) / 64;
+  mRows.assign(compCount, Row());
+  mUsedBytes = 0;
+
+  // A level only depends on lower levels
+  vector<unsigned> levelOffsets, levelComps;
+  mDag.getLevels(false, levelOffsets, levelComps);
+
+  for (size_t level = 0; level + 1 < levelOffsets.size(); ++level)
+  {
+    const unsigned* levelBegin = levelComps.data() + levelOffsets[level];
+    Common::parallelFor(levelOffsets[level + 1] - levelOffsets[level], PARALLEL_MIN_CHUNK,
+        [this, levelBegin](size_t begin, size_t end)
+        {
+          Trace::Scope scope("index level", "worker");
+          buildRange_(levelBegin + begin, levelBegin + end);
+        });
+  }
+
+  LOG_DEBUG("Reachability index: " << storedRowCount() << "/" << compCount
+            << " rows stored in " << mUsedBytes << " bytes");
+  isBuilt = true;
+  return isBuilt;
+}
+
+void ReachabilityIndex::buildRange_(const unsigned* compBegin, const unsigned* compEnd)
+{
+  Scratch scratch;
+  initScratch_(scratch);
+  for (const unsigned* comp = compBegin; comp != compEnd; ++comp)
+  {
+    collect_(*comp, scratch);
+    storeRow_(*comp, scratch);
+    clearScratch_(scratch);
+  }
+}
+
+void ReachabilityIndex::initScratch_(Scratch& scratch) const
+{
+  scratch.bits.assign(mWordCount, 0);
+  scratch.touchedWords.clear();
+  scratch.pending.clear();
+  scratch.isFullScan = false;
+}
+
+void ReachabilityIndex::collect_(unsigned comp, Scratch& scratch) const
+{
+  // A set bit means its whole closure is already in scratch,
+  // either from a stored row or because its children got queued
+  scratch.pending.assign(mDag.childBegin(comp), mDag.childEnd(comp));
+  while (!scratch.pending.empty())
+  {
+    const unsigned child = scratch.pending.back();
+    scratch.pending.pop_back();
+
+    uint64_t& word = scratch.bits[child >> 6];
+    const uint64_t mask = uint64_t(1) << (child & 63);
+    if (word & mask)
+    {
+      continue;
+    }
+    if (0 == word)
+    {
+      scratch.touchedWords.push_back(child >> 6);
+    }
+    word |= mask;
+
+    const Row& row = mRows[child];
+    if (!row.isStored)
+    {
+      scratch.pending.insert(scratch.pending.end(),
+                             mDag.childBegin(child), mDag.childEnd(child));
+    }
+    else if (row.isDense)
+    {
+      or_words(scratch.bits.data(), row.bits.data(), mWordCount);
+      scratch.isFullScan = true;
+    }
+    else
+    {
+      for (const unsigned reached : row.comps)
+      {
+        uint64_t& reachedWord = scratch.bits[reached >> 6];
+        if (0 == reachedWord)
+        {
+          scratch.touchedWords.push_back(reached >> 6);
+        }
+        reachedWord |= uint64_t(1) << (reached & 63);
+      }
+    }
+  }
+
+  if (!scratch.isFullScan)
+  {
+    std::sort(scratch.touchedWords.begin(), scratch.touchedWords.end());
+  }
+}
+
+void ReachabilityIndex::clearScratch_(Scratch& scratch) const
+{
+  if (scratch.isFullScan)
+  {
+    std::fill(scratch.bits.begin(), scratch.bits.end(), 0);
+  }
+  else
+  {
+    for (const unsigned wordPos : scratch.touchedWords)
+    {
+      scratch.bits[wordPos] = 0;
+    }
+  }
+  scratch.touchedWords.clear();
+  scratch.isFullScan = false;
+}
+
+/**
+ * Call fn(comp) for every bit set in scratch, ascending
+ */
+template <typename Fn>
+static void for_each_bit(const vector<uint64_t>& bits, const vector<unsigned>& touchedWords,
+                         bool isFullScan, Fn fn)
+{
+  const size_t wordCount = isFullScan ? bits.size() : touchedWords.size();
+  for (size_t i = 0; i < wordCount; ++i)
+  {
+    const unsigned wordPos = isFullScan ? i : touchedWords[i];
+    uint64_t word = bits[wordPos];
+    while (word)
+    {
+      fn(wordPos * 64 + __builtin_ctzll(word));
+      word &= word - 1;
+    }
+  }
+}
+
+void ReachabilityIndex::storeRow_(unsigned comp, Scratch& scratch)
+{
+  size_t popCount = 0;
+  const size_t wordCount = scratch.isFullScan ? mWordCount : scratch.touchedWords.size();
+  for (size_t i = 0; i < wordCount; ++i)
+  {
+    popCount += __builtin_popcountll(scratch.bits[scratch.isFullScan ? i : scratch.touchedWords[i]]);
+  }
+
+  const size_t sparseBytes = popCount * sizeof(unsigned);
+  const size_t denseBytes = mWordCount * sizeof(uint64_t);
+  const bool isDense = denseBytes < sparseBytes;
+  const size_t rowBytes = isDense ? denseBytes : sparseBytes;
+
+  // Reserve from budget, leave row unstored when it doesn't fit
+  size_t used = mUsedBytes.load();
+  do
+  {
+    if (used + rowBytes > mMemoryBudget)
+    {
+      return;
+    }
+  } while (!mUsedBytes.compare_exchange_weak(used, used + rowBytes));
+
+  Row& row = mRows[comp];
+  row.isDense = isDense;
+  if (isDense)
+  {
+    row.bits = scratch.bits;
+  }
+  else
+  {
+    row.comps.reserve(popCount);
+    for_each_bit(scratch.bits, scratch.touchedWords, scratch.isFullScan,
+                 [&row](unsigned reached) { row.comps.push_back(reached); });
+  }
+  row.isStored = true;
+}
+
+bool ReachabilityIndex::reaches(unsigned from, unsigned to) const
+{
+  const unsigned fromComp = mDag.componentOf(from);
+  const unsigned toComp = mDag.componentOf(to);
+  if (fromComp == toComp)
+  {
+    return mDag.isCyclic(fromComp);
+  }
+  else if (toComp > fromComp)
+  {
+    // DAG edges only go to lower component ids
+    return false;
+  }
+
+  const Row& row = mRows[fromComp];
+  if (row.isStored)
+  {
+    return row.isDense ? test_bit(row.bits, toComp)
+                       : std::binary_search(row.comps.begin(), row.comps.end(), toComp);
+  }
+
+  Scratch scratch;
+  initScratch_(scratch);
+  collect_(fromComp, scratch);
+  return test_bit(scratch.bits, toComp);
+}
+
+void ReachabilityIndex::getClosure(unsigned node, vector<unsigned>& closure) const
+{
+  closure.clear();
+  const unsigned comp = mDag.componentOf(node);
+  auto addMembers = [this, &closure](unsigned reached)
+  {
+    closure.insert(closure.end(), mDag.memberBegin(reached), mDag.memberEnd(reached));
+  };
+
+  if (mDag.isCyclic(comp))
+  {
+    addMembers(comp);
+  }
+
+  const Row& row = mRows[comp];
+  if (row.isStored && !row.isDense)
+  {
+    std::for_each(row.comps.begin(), row.comps.end(), addMembers);
+  }
+  else
+  {
+    Scratch scratch;
+    initScratch_(scratch);
+    if (row.isStored)
+    {
+      scratch.bits = row.bits;
+      scratch.isFullScan = true;
+    }
+    else
+    {
+      collect_(comp, scratch);
+    }
+    for_each_bit(scratch.bits, scratch.touchedWords, scratch.isFullScan, addMembers);
+  }
+
+  std::sort(closure.begin(), closure.end());
+}
+
+size_t ReachabilityIndex::storedRowCount() const
+{
+  size_t count = 0;
+  for (const Row& row : mRows)
+  {
+    count += row.isStored;
+  }
+  return count;
+}
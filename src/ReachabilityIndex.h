@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_REACHABILITYINDEX_H_
+#define SRC_REACHABILITYINDEX_H_
+
+#include "Condensation.h"
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Transitive closure over the condensation DAG
+ * Each component keeps the set of components it reaches, stored either as
+ * a sorted id list or as a word packed bitset, whichever is smaller. Rows
+ * are filled in reverse topological order one DAG height at a time, so
+ * components of the same height are combined in parallel. Once the memory
+ * budget is used up, the remaining rows aren't stored and queries on them
+ * walk the DAG down to the nearest stored rows instead
+ */
+class ReachabilityIndex
+{
+public:
+  static const size_t DEFAULT_MEMORY_BUDGET = 256u << 20;
+
+  ReachabilityIndex(const Condensation& dag, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+  virtual ~ReachabilityIndex();
+
+  /**
+   * Fill closure rows, dag must be solved
+   * @return true on success
+   */
+  bool build();
+
+  /**
+   * Does node from transitively reach node to
+   * A node only reaches itself when it's part of a circle
+   */
+  bool reaches(unsigned from, unsigned to) const;
+
+  /**
+   * All node ids transitively reached from node, sorted ascending
+   */
+  void getClosure(unsigned node, vector<unsigned>& closure) const;
+
+  /**
+   * Index footprint for reporting
+   */
+  size_t storedRowCount() const;
+  size_t memoryUsage() const { return mUsedBytes; }
+
+private:
+  struct Row
+  {
+    bool isStored;
+    bool isDense;
+    vector<uint64_t> bits;   // dense row
+    vector<unsigned> comps;  // sparse row, sorted
+    Row(): isStored(false), isDense(false) {}
+  };
+
+  /**
+   * Reusable bitset for collecting one row
+   */
+  struct Scratch
+  {
+    vector<uint64_t> bits;
+    vector<unsigned> touchedWords;
+    vector<unsigned> pending;
+    bool isFullScan;
+  };
+
+  void initScratch_(Scratch& scratch) const;
+  void collect_(unsigned comp, Scratch& scratch) const;
+  void clearScratch_(Scratch& scratch) const;
+  void storeRow_(unsigned comp, Scratch& scratch);
+  void buildRange_(const unsigned* compBegin, const unsigned* compEnd);
+
+private:
+  const Condensation& mDag;
+  size_t mMemoryBudget;
+  size_t mWordCount;
+  bool isBuilt;
+
+  vector<Row> mRows;
+  std::atomic<size_t> mUsedBytes;
+};
+
+#endif /* SRC_REACHABILITYINDEX_H_ */
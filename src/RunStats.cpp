@@ -0,0 +1,320 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "RunStats.h"
+#include "Trace.h"
+#include <iomanip>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+static double clock_seconds(clockid_t clockId)
+{
+  struct timespec now;
+  clock_gettime(clockId, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static double per_second(uint64_t count, double seconds)
+{
+  return (seconds > 0) ? count / seconds : 0;
+}
+
+/**
+ * Counter columns of one phase, - for counters the kernel refused
+ */
+static void print_counters(std::ostream& out, const PerfCounters& counters, const uint64_t* totals)
+{
+  static const int WIDTHS[PerfCounters::COUNTER_COUNT] = {16, 16, 14, 14};
+  for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter)
+  {
+    if (PerfCounters::COUNTER_CACHE_MISSES == counter)
+    {
+      // IPC goes between instructions and the misses
+      const uint64_t cycles = totals[PerfCounters::COUNTER_CYCLES];
+      if (counters.isAvailable(PerfCounters::COUNTER_CYCLES)
+          && counters.isAvailable(PerfCounters::COUNTER_INSTRUCTIONS) && cycles > 0)
+      {
+        out << std::setw(6) << std::setprecision(2)
+            << (double) totals[PerfCounters::COUNTER_INSTRUCTIONS] / cycles << std::setprecision(3);
+      }
+      else
+      {
+        out << std::setw(6) << "-";
+      }
+    }
+
+    out << std::setw(WIDTHS[counter]);
+    if (counters.isAvailable((PerfCounters::Counter) counter))
+    {
+      out << totals[counter];
+    }
+    else
+    {
+      out << "-";
+    }
+  }
+}
+
+RunStats::RunStats(): fileCount(0), byteCount(0), includeCount(0), nodeCount(0), edgeCount(0),
+    mCurrent(-1), mWallBegin(0), mCpuBegin(0), mTraceBegin(0)
+{
+  for (int phase = 0; phase < PHASE_COUNT; ++phase)
+  {
+    mWallTimes[phase] = 0;
+    mCpuTimes[phase] = 0;
+    mIsEntered[phase] = false;
+    mAllocTotals[phase] = AllocStats::Counters();
+    for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter)
+    {
+      mCounterTotals[phase][counter] = 0;
+    }
+  }
+
+  for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter)
+  {
+    mCounterBegin[counter] = 0;
+  }
+  AllocStats::read(mAllocBegin);
+}
+
+RunStats::~RunStats()
+{
+}
+
+bool RunStats::openCounters()
+{
+  if (!mCounters.open())
+  {
+    return false;
+  }
+  mCounters.read(mCounterBegin);
+  return true;
+}
+
+void RunStats::close_(double wallNow, double cpuNow)
+{
+  uint64_t counterNow[PerfCounters::COUNTER_COUNT];
+  if (mCounters.isOpen())
+  {
+    mCounters.read(counterNow);
+  }
+  AllocStats::Counters allocNow;
+  AllocStats::read(allocNow);
+
+  if (mCurrent >= 0)
+  {
+    mWallTimes[mCurrent] += wallNow - mWallBegin;
+    mCpuTimes[mCurrent] += cpuNow - mCpuBegin;
+    if (mCounters.isOpen())
+    {
+      for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter)
+      {
+        mCounterTotals[mCurrent][counter] += counterNow[counter] - mCounterBegin[counter];
+      }
+    }
+
+    AllocStats::Counters& allocs = mAllocTotals[mCurrent];
+    allocs.allocations += allocNow.allocations - mAllocBegin.allocations;
+    allocs.frees += allocNow.frees - mAllocBegin.frees;
+    allocs.bytes += allocNow.bytes - mAllocBegin.bytes;
+    allocs.liveBytes = allocNow.liveBytes;
+    allocs.peakLiveBytes = std::max(allocs.peakLiveBytes, allocNow.peakLiveBytes);
+
+    // Scan & traversal switch per file, the parser traces dirs & slow files instead
+    if (PHASE_SCAN != mCurrent && PHASE_TRAVERSAL != mCurrent && Trace::isEnabled())
+    {
+      Trace::record(getPhaseName((Phase) mCurrent), "phase", mTraceBegin, Trace::now());
+    }
+  }
+
+  if (mCounters.isOpen())
+  {
+    memcpy(mCounterBegin, counterNow, sizeof(mCounterBegin));
+  }
+  mAllocBegin = allocNow;
+  AllocStats::resetPeak();
+}
+
+void RunStats::enter(Phase phase)
+{
+  const double wallNow = clock_seconds(CLOCK_MONOTONIC);
+  const double cpuNow = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+  close_(wallNow, cpuNow);
+
+  mCurrent = phase;
+  mIsEntered[phase] = true;
+  mWallBegin = wallNow;
+  mCpuBegin = cpuNow;
+  mTraceBegin = Trace::isEnabled() ? Trace::now() : 0;
+}
+
+void RunStats::stop()
+{
+  if (mCurrent >= 0)
+  {
+    close_(clock_seconds(CLOCK_MONOTONIC), clock_seconds(CLOCK_PROCESS_CPUTIME_ID));
+    mCurrent = -1;
+  }
+}
+
+const char* RunStats::getPhaseName(Phase phase)
+{
+  static const char* const NAMES[PHASE_COUNT] =
+  {
+    "load", "exclude_index", "traversal", "scan", "merge", "convert", "scc", "report"
+  };
+  return (phase < PHASE_COUNT) ? NAMES[phase] : "unknown";
+}
+
+uint64_t RunStats::getPeakRssKb()
+{
+  struct rusage usage;
+  if (0 != getrusage(RUSAGE_SELF, &usage))
+  {
+    return 0;
+  }
+  return usage.ru_maxrss; // kB on Linux
+}
+
+double RunStats::getScanWallTime_() const
+{
+  return mWallTimes[PHASE_TRAVERSAL] + mWallTimes[PHASE_SCAN];
+}
+
+void RunStats::print(std::ostream& out)
+{
+  stop();
+  const std::ios::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << std::fixed << std::setprecision(3);
+
+  out << "Stats:" << endl;
+  const bool hasCounters = mCounters.isOpen();
+  out << "   " << std::left << std::setw(16) << "phase" << std::right
+      << std::setw(10) << "wall(s)" << std::setw(10) << "cpu(s)";
+  if (hasCounters)
+  {
+    out << std::setw(16) << "cycles" << std::setw(16) << "instructions" << std::setw(6) << "IPC"
+        << std::setw(14) << "cache misses" << std::setw(14) << "branch misses";
+  }
+  const bool hasAllocs = AllocStats::isEnabled();
+  if (hasAllocs)
+  {
+    out << std::setw(12) << "allocs" << std::setw(12) << "alloc(MB)" << std::setw(12) << "peak(MB)";
+  }
+  out << endl;
+  double wallTotal = 0, cpuTotal = 0;
+  for (int phase = 0; phase < PHASE_COUNT; ++phase)
+  {
+    if (!mIsEntered[phase])
+    {
+      continue;
+    }
+    out << "   " << std::left << std::setw(16) << getPhaseName((Phase) phase) << std::right
+        << std::setw(10) << mWallTimes[phase] << std::setw(10) << mCpuTimes[phase];
+    if (hasCounters)
+    {
+      print_counters(out, mCounters, mCounterTotals[phase]);
+    }
+    if (hasAllocs)
+    {
+      const AllocStats::Counters& allocs = mAllocTotals[phase];
+      out << std::setw(12) << allocs.allocations << std::setw(12) << allocs.bytes / 1048576.0
+          << std::setw(12) << allocs.peakLiveBytes / 1048576.0;
+    }
+    out << endl;
+    wallTotal += mWallTimes[phase];
+    cpuTotal += mCpuTimes[phase];
+  }
+  out << "   " << std::left << std::setw(16) << "total" << std::right
+      << std::setw(10) << wallTotal << std::setw(10) << cpuTotal << endl;
+  for (int counter = 0; hasCounters && counter < PerfCounters::COUNTER_COUNT; ++counter)
+  {
+    if (!mCounters.isAvailable((PerfCounters::Counter) counter))
+    {
+      out << "   (- counter not allowed by kernel)" << endl;
+      break;
+    }
+  }
+
+  const double scanTime = getScanWallTime_();
+  out << std::setprecision(0);
+  out << "   files:    " << fileCount << " (" << per_second(fileCount, scanTime) << "/s)" << endl;
+  out << "   bytes:    " << byteCount << " (" << per_second(byteCount, scanTime) << "/s)" << endl;
+  out << "   includes: " << includeCount << " (" << per_second(includeCount, scanTime) << "/s)" << endl;
+  out << "   nodes:    " << nodeCount << ", edges: " << edgeCount << endl;
+  out << "   peak RSS: " << getPeakRssKb() << " kB" << endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void RunStats::printJson(std::ostream& out)
+{
+  stop();
+  const std::ios::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << std::fixed << std::setprecision(6);
+
+  out << "{\"phases\":{";
+  bool isFirst = true;
+  for (int phase = 0; phase < PHASE_COUNT; ++phase)
+  {
+    if (!mIsEntered[phase])
+    {
+      continue;
+    }
+    out << (isFirst ? "" : ",") << "\"" << getPhaseName((Phase) phase) << "\":{\"wall_sec\":"
+        << mWallTimes[phase] << ",\"cpu_sec\":" << mCpuTimes[phase];
+    for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter)
+    {
+      if (mCounters.isAvailable((PerfCounters::Counter) counter))
+      {
+        out << ",\"" << PerfCounters::getCounterName((PerfCounters::Counter) counter) << "\":"
+            << mCounterTotals[phase][counter];
+      }
+    }
+    if (AllocStats::isEnabled())
+    {
+      out << ",\"allocations\":" << mAllocTotals[phase].allocations
+          << ",\"alloc_bytes\":" << mAllocTotals[phase].bytes
+          << ",\"peak_live_bytes\":" << mAllocTotals[phase].peakLiveBytes;
+    }
+    out << "}";
+    isFirst = false;
+  }
+  out << "}";
+
+  const double scanTime = getScanWallTime_();
+  out << ",\"files\":" << fileCount << ",\"bytes\":" << byteCount
+      << ",\"includes\":" << includeCount
+      << ",\"files_per_sec\":" << per_second(fileCount, scanTime)
+      << ",\"bytes_per_sec\":" << per_second(byteCount, scanTime)
+      << ",\"includes_per_sec\":" << per_second(includeCount, scanTime)
+      << ",\"nodes\":" << nodeCount << ",\"edges\":" << edgeCount
+      << ",\"peak_rss_kb\":" << getPeakRssKb() << "}" << endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
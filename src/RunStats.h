@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_RUNSTATS_H_
+#define SRC_RUNSTATS_H_
+
+#include "PerfCounters.h"
+#include "AllocStats.h"
+#include <stdint.h>
+
+/**
+ * Wall & CPU time of each phase of a run plus throughput counters
+ *
+ * A run is in at most one phase at a time, entering a phase closes the
+ * current one, so nested work like scanning inside the directory walk
+ * is charged to the inner phase only
+ * With counters open, hardware counters are charged per phase the same way
+ * While tracing, each coarse phase is recorded as a trace event
+ * Built with ALLOC_STATS=1, heap allocations & peak live bytes go per phase too
+ */
+class RunStats
+{
+public:
+  enum Phase
+  {
+    PHASE_LOAD = 0,       // snapshot mapping, time trace reading
+    PHASE_EXCLUDE_INDEX,  // walking excluded dirs
+    PHASE_TRAVERSAL,      // walking project dirs
+    PHASE_SCAN,           // reading files for includes
+    PHASE_MERGE,          // duplicate & missing header checks
+    PHASE_CONVERT,        // graph to compact graph
+    PHASE_SCC,            // solver
+    PHASE_REPORT,         // everything printed
+    PHASE_COUNT
+  };
+
+  RunStats();
+  virtual ~RunStats();
+
+  /**
+   * Close the current phase if any and start phase
+   */
+  void enter(Phase phase);
+
+  /**
+   * Close the current phase if any
+   */
+  void stop();
+
+  /**
+   * Also count cycles, instructions, cache & branch misses per phase
+   * @return false if the kernel allows none of them, stats go on without
+   */
+  bool openCounters();
+
+  double getWallTime(Phase phase) const { return mWallTimes[phase]; }
+  double getCpuTime(Phase phase) const { return mCpuTimes[phase]; }
+  uint64_t getCounter(Phase phase, PerfCounters::Counter counter) const
+  {
+    return mCounterTotals[phase][counter];
+  }
+
+  /**
+   * Heap use of phase, allocations & bytes are what the phase allocated,
+   * peakLiveBytes the most the whole process held during it
+   */
+  const AllocStats::Counters& getAllocs(Phase phase) const { return mAllocTotals[phase]; }
+
+  /**
+   * Snake case name of phase, used as JSON key too
+   */
+  static const char* getPhaseName(Phase phase);
+
+  /**
+   * Peak resident set size of this process so far in kB
+   */
+  static uint64_t getPeakRssKb();
+
+  /**
+   * Human readable table, stops the current phase
+   */
+  void print(std::ostream& out);
+
+  /**
+   * One line JSON object, stops the current phase
+   */
+  void printJson(std::ostream& out);
+
+public:
+  uint64_t fileCount;     // files scanned
+  uint64_t byteCount;     // bytes scanned
+  uint64_t includeCount;  // include directives seen
+  uint64_t nodeCount;
+  uint64_t edgeCount;
+
+private:
+  /**
+   * Charge time & counters since the current phase began to it
+   */
+  void close_(double wallNow, double cpuNow);
+
+  /**
+   * Seconds spent reading files, over which throughput is computed
+   */
+  double getScanWallTime_() const;
+
+private:
+  int mCurrent;           // current phase, -1 if none
+  double mWallBegin;
+  double mCpuBegin;
+  uint64_t mTraceBegin;   // phases are traced too, when tracing
+  double mWallTimes[PHASE_COUNT];
+  double mCpuTimes[PHASE_COUNT];
+  bool mIsEntered[PHASE_COUNT];
+
+  PerfCounters mCounters;
+  uint64_t mCounterBegin[PerfCounters::COUNTER_COUNT];
+  uint64_t mCounterTotals[PHASE_COUNT][PerfCounters::COUNTER_COUNT];
+
+  AllocStats::Counters mAllocBegin;
+  AllocStats::Counters mAllocTotals[PHASE_COUNT];
+};
+
+#endif /* SRC_RUNSTATS_H_ */
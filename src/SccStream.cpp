@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "SccStream.h"
+
+static const unsigned UNVISITED = ~0u;
+
+void SccStream::solve(const CompactGraph& graph, SccVisitor& visitor, bool skipSingletons)
+{
+  // Iterative Tarjan, recursion would blow the stack on long include chains
+  // Children are read through a cursor, encoded graphs are never unpacked
+  struct Frame
+  {
+    unsigned node;
+    EdgeCursor children;
+  };
+
+  const size_t nodeCount = graph.size();
+  vector<unsigned> index(nodeCount, UNVISITED), lowLink(nodeCount, 0);
+  vector<bool> onStack(nodeCount, false);
+  vector<unsigned> stack;
+  vector<Frame> callStack;
+  unsigned nextIndex = 0;
+
+  for (unsigned root = 0; root < nodeCount; ++root)
+  {
+    if (index[root] != UNVISITED)
+    {
+      continue;
+    }
+
+    index[root] = lowLink[root] = nextIndex++;
+    stack.push_back(root);
+    onStack[root] = true;
+    callStack.push_back({root, graph.children(root)});
+
+    while (!callStack.empty())
+    {
+      Frame& frame = callStack.back();
+      const unsigned node = frame.node;
+      unsigned child;
+      if (frame.children.next(child))
+      {
+        if (index[child] == UNVISITED)
+        {
+          index[child] = lowLink[child] = nextIndex++;
+          stack.push_back(child);
+          onStack[child] = true;
+          callStack.push_back({child, graph.children(child)});
+        }
+        else if (onStack[child])
+        {
+          lowLink[node] = std::min(lowLink[node], index[child]);
+        }
+        continue;
+      }
+
+      // All children done, propagate low link and finalize the set
+      callStack.pop_back();
+      if (!callStack.empty())
+      {
+        const unsigned parent = callStack.back().node;
+        lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+      }
+
+      if (lowLink[node] == index[node])
+      {
+        // The set is the top of the stack down to node
+        size_t setBegin = stack.size();
+        do
+        {
+          onStack[stack[--setBegin]] = false;
+        } while (stack[setBegin] != node);
+
+        const size_t count = stack.size() - setBegin;
+        if (!skipSingletons || count > 1)
+        {
+          visitor.visitScc(stack.data() + setBegin, count);
+        }
+        stack.resize(setBegin);
+      }
+    }
+  }
+}
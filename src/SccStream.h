@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_SCCSTREAM_H_
+#define SRC_SCCSTREAM_H_
+
+#include "CompactGraph.h"
+
+/**
+ * Receives strongly connected sets one at a time
+ */
+class SccVisitor
+{
+public:
+  virtual ~SccVisitor() {}
+
+  /**
+   * Called as soon as a set is finalized, sets come in reverse topological
+   * order: a set can only reach sets visited before it
+   * @param ids   node ids of the set, only valid during the call
+   * @param count number of ids
+   */
+  virtual void visitScc(const unsigned* ids, size_t count) = 0;
+};
+
+namespace SccStream
+{
+  /**
+   * Iterative Tarjan over graph, streaming every set to visitor
+   * @param skipSingletons don't emit sets of 1 node
+   */
+  void solve(const CompactGraph& graph, SccVisitor& visitor, bool skipSingletons = false);
+};
+
+#endif /* SRC_SCCSTREAM_H_ */
@@ -34,19 +34,14 @@ TarjanCore::~TarjanCore()
   // TODO Auto-generated destructor stub
 }
 
-const set<TarjanGraph>& TarjanCore::getSolution()
+const set<TarjanGraph>& TarjanCore::getSolution() const
 {
-  static set<TarjanGraph> retVal;
   if (!isSolved)
   {
     LOG_ERROR("Need to solve before getting solution");
   }
-  else
-  {
-    retVal = mSolution;
-  }
 
-  return retVal;
+  return mSolution;
 }
 
 const string& TarjanNode::str() const
@@ -64,9 +64,9 @@ public:
   bool solve();
 
   /**
-   * Return solution if solved successfully
+   * Return solution if solved successfully, empty otherwise
    */
-  const set<TarjanGraph>& getSolution();
+  const set<TarjanGraph>& getSolution() const;
 
   /**
    * Print all member data for debugging
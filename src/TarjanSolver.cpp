@@ -24,7 +24,14 @@
 #include "TarjanSolver.h"
 #include "TarjanCore.h"
 
-TarjanSolver::TarjanSolver(const Graph& allNodes): mGraph(allNodes)
+TarjanSolver::TarjanSolver(const Graph& allNodes): mGraph(&allNodes), mSolveGraph(&mCompactGraph),
+    mStats(nullptr)
+{
+  isSolved = false;
+}
+
+TarjanSolver::TarjanSolver(const CompactGraph& graph): mGraph(nullptr), mSolveGraph(&graph),
+    mStats(nullptr)
 {
   isSolved = false;
 }
@@ -35,15 +42,23 @@ TarjanSolver::~TarjanSolver()
 
 bool TarjanSolver::solve()
 {
+  if (!mGraph)
+  {
+    LOG_ERROR("Solver of a compact graph must use the streaming solve()");
+    return false;
+  }
+
   if (!isSolved)
   {
     // Try to solve in here
+    enterPhase_(RunStats::PHASE_CONVERT);
     if (!convertToCoreNodes_())
     {
       LOG_ERROR("Cannot convert to core data structure");
       return false;
     }
 
+    enterPhase_(RunStats::PHASE_SCC);
     TarjanCore coreSolver(mAllTarjanNodes);
     isSolved = coreSolver.solve();
 
@@ -53,48 +68,67 @@ bool TarjanSolver::solve()
     }
     else
     {
+      enterPhase_(RunStats::PHASE_CONVERT);
       mTarjanSolution = coreSolver.getSolution();
+      if (!convertFromCoreNodes_())
+      {
+        LOG_ERROR("Cannot convert solution from core data structure");
+        isSolved = false;
+      }
+      mTarjanSolution.clear();
     }
   }
 
   return isSolved;
 }
 
-const set<set<string> >& TarjanSolver::getSolution()
+bool TarjanSolver::solve(SccVisitor& visitor, bool skipSingletons)
 {
-  static auto retVal = mSolution;
-  if (!isSolved)
+  if (mGraph)
   {
-    LOG_ERROR("Solver must call solve() before calling " << __FUNCTION__);
-    return retVal;
-
+    enterPhase_(RunStats::PHASE_CONVERT);
+    mCompactGraph.assign(*mGraph);
   }
+  enterPhase_(RunStats::PHASE_SCC);
+  SccStream::solve(*mSolveGraph, visitor, skipSingletons);
+  return true;
+}
 
-  if (!convertFromCoreNodes_())
+void TarjanSolver::enterPhase_(RunStats::Phase phase)
+{
+  if (mStats)
   {
-    retVal.clear();
-    LOG_ERROR("Cannot convert solution from core data structure");
+    mStats->enter(phase);
   }
-  else
+}
+
+const char* TarjanSolver::getName(unsigned id) const
+{
+  return mSolveGraph->name(id);
+}
+
+const set<set<string> >& TarjanSolver::getSolution() const
+{
+  if (!isSolved)
   {
-    retVal = mSolution;
+    LOG_ERROR("Solver must call solve() before calling " << __FUNCTION__);
   }
 
-  return retVal;
+  return mSolution;
 }
 
 bool TarjanSolver::convertToCoreNodes_()
 {
   // Create tarjan graph map
   map<string, shared_ptr<TarjanNode> > allTarjanNodeMap; // map[id] = tarjannode
-  for (const Node & node : mGraph)
+  for (const Node & node : *mGraph)
   {
     allTarjanNodeMap[node.id] = std::make_shared<TarjanNode>(node.id);
   }
 
   // For tolerance, add tarjan node that exists from child nodes
   // but not exist in node map
-  for (const Node & node : mGraph)
+  for (const Node & node : *mGraph)
   {
     for (const string& childId : node.childNodes)
     {
@@ -107,7 +141,7 @@ bool TarjanSolver::convertToCoreNodes_()
   }
 
   // Update tarjan graph map
-  for (const Node & node : mGraph)
+  for (const Node & node : *mGraph)
   {
     for (const string& childId : node.childNodes)
     {
@@ -155,3 +189,18 @@ bool TarjanSolver::convertFromCoreNodes_()
   }
   return true;
 }
+
+SccNameCollector::SccNameCollector(const TarjanSolver& solver, set<set<string> >& output):
+    mSolver(solver), mOutput(output)
+{
+}
+
+void SccNameCollector::visitScc(const unsigned* ids, size_t count)
+{
+  set<string> oneSet;
+  for (size_t i = 0; i < count; ++i)
+  {
+    oneSet.insert(mSolver.getName(ids[i]));
+  }
+  mOutput.insert(oneSet);
+}
@@ -25,6 +25,8 @@
 #define SRC_TARJANSOLVER_H_
 
 #include "DataStructure.h"
+#include "SccStream.h"
+#include "RunStats.h"
 
 struct TarjanNode;
 class TarjanCore;
@@ -36,7 +38,16 @@ class TarjanCore;
 class TarjanSolver
 {
 public:
+  /**
+   * allNodes must outlive the solver
+   */
   TarjanSolver(const Graph& allNodes);
+
+  /**
+   * Solve an already compacted graph, e.g. a mapped snapshot
+   * Only the streaming solve() is available, graph must outlive the solver
+   */
+  TarjanSolver(const CompactGraph& graph);
   virtual ~TarjanSolver();
 
   /**
@@ -47,8 +58,28 @@ public:
 
   /**
    * If solved successfully, return a set of strongly connected graph
+   * empty otherwise
+   */
+  const set<set<string> >& getSolution() const;
+
+  /**
+   * Streaming form of solve(), each strongly connected set goes to visitor
+   * as an id span as soon as it's found, nothing is kept in getSolution()
+   * @param skipSingletons don't emit sets of 1 node, which is most of them
+   * @return true on success
+   */
+  bool solve(SccVisitor& visitor, bool skipSingletons = true);
+
+  /**
+   * Charge conversions to PHASE_CONVERT and the algorithm to PHASE_SCC
+   * of stats, null to stop, stats must outlive the solver
    */
-  const set<set<string> >& getSolution();
+  void setStats(RunStats* stats) { mStats = stats; }
+
+  /**
+   * Name of an id passed to SccVisitor
+   */
+  const char* getName(unsigned id) const;
 
 private: // internal functions
   /**
@@ -57,6 +88,7 @@ private: // internal functions
    */
   bool convertToCoreNodes_();
   bool convertFromCoreNodes_();
+  void enterPhase_(RunStats::Phase phase);
 
 private: // internal facing vars
   set<shared_ptr<TarjanNode> > mAllTarjanNodes;
@@ -64,8 +96,27 @@ private: // internal facing vars
 
 private: // external facing vars
   set<set<string> > mSolution;
-  Graph mGraph;
+  const Graph* mGraph;
+  const CompactGraph* mSolveGraph;
+  CompactGraph mCompactGraph;
+  RunStats* mStats;
   bool isSolved;
 };
 
+/**
+ * Keeps every streamed set by name, for callers that report them all
+ * at once. With singletons skipped at the source this stays small
+ */
+class SccNameCollector: public SccVisitor
+{
+public:
+  SccNameCollector(const TarjanSolver& solver, set<set<string> >& output);
+
+  void visitScc(const unsigned* ids, size_t count);
+
+private:
+  const TarjanSolver& mSolver;
+  set<set<string> >& mOutput;
+};
+
 #endif /* SRC_TARJANSOLVER_H_ */
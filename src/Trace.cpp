@@ -0,0 +1,240 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "Trace.h"
+#include "Common.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+namespace
+{
+  struct Event
+  {
+    const char* name;
+    const char* category;
+    uint64_t begin;
+    uint64_t duration;
+    string detail;
+  };
+
+  struct ThreadBuffer
+  {
+    unsigned tid;
+    vector<Event> events;
+  };
+
+  std::atomic<bool> g_isEnabled(false);
+  std::atomic<unsigned> g_generation(0);  // bumped by start(), stale buffers re-register
+  std::chrono::steady_clock::time_point g_origin;
+
+  std::mutex g_buffersMutex;
+  vector<std::unique_ptr<ThreadBuffer> > g_buffers;
+
+  thread_local ThreadBuffer* t_buffer = nullptr;
+  thread_local unsigned t_generation = 0;
+
+  ThreadBuffer& thread_buffer()
+  {
+    const unsigned generation = g_generation.load(std::memory_order_acquire);
+    if (!t_buffer || t_generation != generation)
+    {
+      std::lock_guard<std::mutex> lock(g_buffersMutex);
+      g_buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer));
+      t_buffer = g_buffers.back().get();
+      t_buffer->tid = g_buffers.size();
+      t_generation = generation;
+    }
+    return *t_buffer;
+  }
+
+  void write_json_string(std::ostream& out, const string& text)
+  {
+    out << '"';
+    for (const char c : text)
+    {
+      if (c == '"' || c == '\\')
+      {
+        out << '\\' << c;
+      }
+      else if ((unsigned char) c < 0x20)
+      {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned) c);
+        out << escaped;
+      }
+      else
+      {
+        out << c;
+      }
+    }
+    out << '"';
+  }
+
+  /**
+   * Microseconds with ns precision, the unit of trace timestamps
+   */
+  void write_micros(std::ostream& out, uint64_t nanos)
+  {
+    char text[32];
+    snprintf(text, sizeof(text), "%llu.%03u", (unsigned long long) (nanos / 1000),
+             (unsigned) (nanos % 1000));
+    out << text;
+  }
+}
+
+void Trace::start()
+{
+  {
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    g_buffers.clear();
+    g_origin = std::chrono::steady_clock::now();
+    g_generation.fetch_add(1, std::memory_order_release);
+    g_isEnabled = true;
+  }
+
+  // The starting thread gets the first tid, named main
+  thread_buffer();
+}
+
+bool Trace::isEnabled()
+{
+  return g_isEnabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Trace::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - g_origin).count();
+}
+
+void Trace::record(const char* name, const char* category, uint64_t begin, uint64_t end,
+                   const char* detail)
+{
+  if (!isEnabled())
+  {
+    return;
+  }
+
+  Event event;
+  event.name = name;
+  event.category = category;
+  event.begin = begin;
+  event.duration = (end > begin) ? end - begin : 0;
+  if (detail)
+  {
+    event.detail = detail;
+  }
+  thread_buffer().events.push_back(std::move(event));
+}
+
+bool Trace::write(const std::string& path)
+{
+  g_isEnabled = false;
+  std::lock_guard<std::mutex> lock(g_buffersMutex);
+
+  const string tmpPath = path + ".tmp";
+  std::ofstream out(tmpPath.c_str());
+  if (!out)
+  {
+    LOG_ERROR("Cannot write trace " << path);
+    return false;
+  }
+
+  size_t eventCount = 0;
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  for (const auto& buffer : g_buffers)
+  {
+    out << (buffer->tid > 1 ? ",\n" : "")
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+        << ",\"args\":{\"name\":\"";
+    if (buffer->tid == 1)
+    {
+      out << "main";
+    }
+    else
+    {
+      out << "worker " << buffer->tid;
+    }
+    out << "\"}}";
+    for (const Event& event : buffer->events)
+    {
+      out << ",\n{\"name\":";
+      write_json_string(out, event.name);
+      out << ",\"cat\":";
+      write_json_string(out, event.category);
+      out << ",\"ph\":\"X\",\"ts\":";
+      write_micros(out, event.begin);
+      out << ",\"dur\":";
+      write_micros(out, event.duration);
+      out << ",\"pid\":1,\"tid\":" << buffer->tid;
+      if (!event.detail.empty())
+      {
+        out << ",\"args\":{\"detail\":";
+        write_json_string(out, event.detail);
+        out << "}";
+      }
+      out << "}";
+    }
+    eventCount += buffer->events.size();
+  }
+  out << "\n]}\n";
+  out.close();
+  const size_t threadCount = g_buffers.size();
+  g_buffers.clear();
+  g_generation.fetch_add(1, std::memory_order_release);
+
+  if (!out || 0 != rename(tmpPath.c_str(), path.c_str()))
+  {
+    LOG_ERROR("Cannot write trace " << path);
+    remove(tmpPath.c_str());
+    return false;
+  }
+
+  LOG_DEBUG("Wrote " << eventCount << " trace events of " << threadCount << " threads to " << path);
+  return true;
+}
+
+Trace::Scope::Scope(const char* name, const char* category, const char* detail,
+                    uint64_t minDuration):
+    mName(name), mCategory(category), mDetail(detail), mMinDuration(minDuration), mBegin(0),
+    isRecording(Trace::isEnabled())
+{
+  if (isRecording)
+  {
+    mBegin = now();
+  }
+}
+
+Trace::Scope::~Scope()
+{
+  if (isRecording)
+  {
+    const uint64_t end = now();
+    if (end - mBegin >= mMinDuration)
+    {
+      record(mName, mCategory, mBegin, end, mDetail);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_TRACE_H_
+#define SRC_TRACE_H_
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * Chrome trace event recorder, load the output in chrome://tracing or Perfetto
+ * Each thread appends to its own buffer without locking, buffers are merged
+ * when written out. Recording is off until start()
+ */
+namespace Trace
+{
+  /**
+   * Start recording, drops anything recorded before
+   */
+  void start();
+
+  bool isEnabled();
+
+  /**
+   * Nanoseconds since start()
+   */
+  uint64_t now();
+
+  /**
+   * Record a complete event of the calling thread
+   * @param name, category must be string literals, they're not copied
+   * @param detail optional, shown as args.detail, copied
+   */
+  void record(const char* name, const char* category, uint64_t begin, uint64_t end,
+              const char* detail = nullptr);
+
+  /**
+   * Stop recording and write every thread's events as trace JSON,
+   * threads that recorded must be done by now
+   * @return true on success
+   */
+  bool write(const std::string& path);
+
+  /**
+   * Records its own lifetime, if it lasts at least minDuration nanoseconds
+   */
+  class Scope
+  {
+  public:
+    Scope(const char* name, const char* category, const char* detail = nullptr,
+          uint64_t minDuration = 0);
+    ~Scope();
+
+  private:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    const char* mName;
+    const char* mCategory;
+    const char* mDetail;
+    uint64_t mMinDuration;
+    uint64_t mBegin;
+    bool isRecording;
+  };
+}
+
+#endif /* SRC_TRACE_H_ */
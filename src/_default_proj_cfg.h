@@ -0,0 +1,57 @@
+unsigned char DefaultProjectDescription_cfg[] = {
+  0x23, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20,
+  0x63, 0x6f, 0x6e, 0x74, 0x61, 0x69, 0x6e, 0x73, 0x20, 0x64, 0x65, 0x74,
+  0x61, 0x69, 0x6c, 0x20, 0x61, 0x62, 0x6f, 0x75, 0x74, 0x20, 0x74, 0x68,
+  0x65, 0x20, 0x70, 0x72, 0x6f, 0x6a, 0x65, 0x63, 0x74, 0x0a, 0x23, 0x20,
+  0x49, 0x66, 0x20, 0x6a, 0x75, 0x73, 0x74, 0x20, 0x63, 0x72, 0x65, 0x61,
+  0x74, 0x65, 0x64, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x73, 0x70, 0x69,
+  0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x2c, 0x20, 0x61, 0x6c, 0x6c, 0x20,
+  0x76, 0x61, 0x6c, 0x75, 0x65, 0x73, 0x20, 0x61, 0x72, 0x65, 0x20, 0x64,
+  0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x0a, 0x23, 0x20, 0x55, 0x73, 0x65,
+  0x20, 0x23, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x65,
+  0x6e, 0x74, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x73, 0x70, 0x69, 0x6e,
+  0x63, 0x6c, 0x75, 0x64, 0x65, 0x20, 0x77, 0x69, 0x6c, 0x6c, 0x20, 0x75,
+  0x73, 0x65, 0x20, 0x69, 0x74, 0x73, 0x20, 0x64, 0x65, 0x66, 0x61, 0x75,
+  0x6c, 0x74, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x0a, 0x23, 0x20, 0x41,
+  0x6c, 0x6c, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x73, 0x20, 0x6f, 0x6e,
+  0x20, 0x61, 0x20, 0x73, 0x61, 0x6d, 0x65, 0x20, 0x6c, 0x69, 0x6e, 0x65,
+  0x20, 0x63, 0x61, 0x6e, 0x20, 0x62, 0x65, 0x20, 0x73, 0x65, 0x70, 0x61,
+  0x72, 0x61, 0x74, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x63, 0x6f, 0x6d,
+  0x6d, 0x61, 0x0a, 0x0a, 0x23, 0x20, 0x44, 0x69, 0x72, 0x65, 0x63, 0x74,
+  0x6f, 0x72, 0x69, 0x65, 0x73, 0x20, 0x70, 0x61, 0x74, 0x68, 0x20, 0x74,
+  0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x70, 0x72, 0x6f, 0x6a, 0x65, 0x63,
+  0x74, 0x0a, 0x50, 0x52, 0x4f, 0x4a, 0x45, 0x43, 0x54, 0x5f, 0x44, 0x49,
+  0x52, 0x53, 0x20, 0x3d, 0x20, 0x64, 0x69, 0x72, 0x31, 0x2c, 0x20, 0x64,
+  0x69, 0x72, 0x32, 0x0a, 0x0a, 0x23, 0x20, 0x50, 0x61, 0x74, 0x68, 0x20,
+  0x74, 0x6f, 0x20, 0x64, 0x69, 0x72, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20,
+  0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x62, 0x65, 0x20, 0x65, 0x78,
+  0x63, 0x6c, 0x75, 0x64, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x66, 0x69,
+  0x6e, 0x64, 0x69, 0x6e, 0x67, 0x20, 0x63, 0x69, 0x72, 0x63, 0x6c, 0x65,
+  0x0a, 0x23, 0x20, 0x47, 0x6c, 0x6f, 0x62, 0x73, 0x20, 0x6c, 0x69, 0x6b,
+  0x65, 0x20, 0x74, 0x68, 0x69, 0x72, 0x64, 0x5f, 0x70, 0x61, 0x72, 0x74,
+  0x79, 0x2f, 0x2a, 0x2a, 0x20, 0x6f, 0x72, 0x20, 0x2a, 0x2a, 0x2f, 0x74,
+  0x65, 0x73, 0x74, 0x2f, 0x2a, 0x2a, 0x20, 0x6d, 0x61, 0x74, 0x63, 0x68,
+  0x20, 0x70, 0x61, 0x74, 0x68, 0x73, 0x20, 0x69, 0x6e, 0x73, 0x69, 0x64,
+  0x65, 0x20, 0x70, 0x72, 0x6f, 0x6a, 0x65, 0x63, 0x74, 0x20, 0x64, 0x69,
+  0x72, 0x73, 0x2c, 0x0a, 0x23, 0x20, 0x74, 0x68, 0x6f, 0x73, 0x65, 0x20,
+  0x64, 0x69, 0x72, 0x73, 0x20, 0x61, 0x72, 0x65, 0x20, 0x6e, 0x65, 0x76,
+  0x65, 0x72, 0x20, 0x6f, 0x70, 0x65, 0x6e, 0x65, 0x64, 0x0a, 0x23, 0x45,
+  0x58, 0x43, 0x4c, 0x55, 0x44, 0x45, 0x5f, 0x44, 0x49, 0x52, 0x53, 0x20,
+  0x3d, 0x20, 0x2f, 0x75, 0x73, 0x72, 0x2f, 0x69, 0x6e, 0x63, 0x6c, 0x75,
+  0x64, 0x65, 0x2c, 0x20, 0x2f, 0x75, 0x73, 0x72, 0x2f, 0x6c, 0x69, 0x62,
+  0x2f, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x2c, 0x20, 0x2f, 0x75,
+  0x73, 0x72, 0x2f, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x2f, 0x6c,
+  0x69, 0x6e, 0x75, 0x78, 0x0a, 0x0a, 0x23, 0x20, 0x4c, 0x69, 0x73, 0x74,
+  0x20, 0x6f, 0x66, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x20, 0x74, 0x68,
+  0x61, 0x74, 0x20, 0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x62, 0x65,
+  0x20, 0x65, 0x78, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x64, 0x2c, 0x20, 0x67,
+  0x6c, 0x6f, 0x62, 0x73, 0x20, 0x6c, 0x69, 0x6b, 0x65, 0x20, 0x2a, 0x5f,
+  0x67, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65, 0x64, 0x2e, 0x68, 0x20,
+  0x6d, 0x61, 0x74, 0x63, 0x68, 0x0a, 0x23, 0x20, 0x62, 0x61, 0x73, 0x65,
+  0x6e, 0x61, 0x6d, 0x65, 0x73, 0x20, 0x61, 0x74, 0x20, 0x61, 0x6e, 0x79,
+  0x20, 0x64, 0x65, 0x70, 0x74, 0x68, 0x0a, 0x23, 0x45, 0x58, 0x43, 0x4c,
+  0x55, 0x44, 0x45, 0x5f, 0x46, 0x49, 0x4c, 0x45, 0x53, 0x20, 0x3d, 0x20,
+  0x73, 0x74, 0x64, 0x69, 0x6f, 0x2e, 0x68, 0x2c, 0x20, 0x73, 0x74, 0x64,
+  0x6c, 0x69, 0x62, 0x2e, 0x68, 0x0a, 0x0a
+};
+unsigned int DefaultProjectDescription_cfg_len = 643;
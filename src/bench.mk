@@ -0,0 +1,79 @@
+# Google Benchmark suites
+# bench/*_bench.cpp: one binary each, other bench/*.cpp are shared helpers
+# Uses submodules/benchmark when it's checked out, the system libbenchmark otherwise
+# Pass benchmark flags with BENCH_ARGS, e.g. make bench BENCH_ARGS=--benchmark_filter=SccStream
+# bench-compare reruns the small sizes with repetitions and fails on slowdowns against
+# bench/baseline.json, bench-baseline rewrites that file from the same runs
+
+# benchmark library definition
+BENCH_DIR       = $(TOP)/submodules/benchmark
+ifneq ($(wildcard $(BENCH_DIR)/include/benchmark/benchmark.h),)
+BENCH_LIB       = $(BENCH_DIR)/build/src/libbenchmark.a
+BENCH_CFLAGS    = -isystem $(BENCH_DIR)/include -DBENCHMARK_STATIC_DEFINE
+BENCH_LDLIBS    = $(BENCH_LIB)
+else
+BENCH_LIB       =
+BENCH_CFLAGS    =
+BENCH_LDLIBS    = -lbenchmark
+endif
+
+# bench objects definition
+BENCH_SOURCES   := $(wildcard bench/*_bench.cpp)
+BENCH_TOOL_SRCS := bench/BenchCompare.cpp
+BENCH_EXTRA_SRCS := $(filter-out $(BENCH_SOURCES) $(BENCH_TOOL_SRCS), $(wildcard bench/*.cpp))
+BENCH_OBJECTS   := $(OBJS) $(BENCH_EXTRA_SRCS:.cpp=.obench)
+BENCH_BIN_OBJS  = $(patsubst %.cpp, %.obench, $(BENCH_SOURCES))
+BENCH_BINARIES  = $(patsubst %.cpp, %.bench, $(BENCH_SOURCES))
+BENCH_IFLAGS    = -Ibench $(IFLAGS)
+BENCH_ARGS      ?=
+
+# regression gate definition
+BENCH_COMPARE   = bench/bench-compare
+BENCH_BASELINE  = bench/baseline.json
+BENCH_RESULTS   = $(patsubst %.cpp, %.result.json, $(BENCH_SOURCES))
+BENCH_THRESHOLD ?= 25
+BENCH_MAD_FACTOR ?= 3
+BENCH_COMPARE_FLAGS ?=
+BENCH_COMPARE_ARGS ?= --benchmark_filter='/(1000|10000)$$' --benchmark_repetitions=7 \
+                      --benchmark_min_time=0.1
+
+# main rules to run
+##########################################################################################
+.PHONY: bench bench_compile bench-compare bench-baseline bench_results cleanbench
+
+bench: bench_compile
+	@printf "Running benchmark binaries \n\n"
+	for bin in $(BENCH_BINARIES); do ./$$bin $(BENCH_ARGS) || exit 1 ; done
+
+bench_compile: $(BENCH_LIB) $(BENCH_OBJECTS) $(BENCH_BIN_OBJS) $(BENCH_BINARIES) $(BENCH_COMPARE)
+
+bench-compare: bench_results
+	./$(BENCH_COMPARE) -t $(BENCH_THRESHOLD) -k $(BENCH_MAD_FACTOR) $(BENCH_COMPARE_FLAGS) \
+	    $(BENCH_BASELINE) $(BENCH_RESULTS)
+
+bench-baseline: bench_results
+	./$(BENCH_COMPARE) -o $(BENCH_BASELINE) $(BENCH_RESULTS)
+
+bench_results: bench_compile
+	for bin in $(BENCH_BINARIES); do \
+	    ./$$bin $(BENCH_COMPARE_ARGS) --benchmark_out=$${bin%.bench}.result.json \
+	        --benchmark_out_format=json > /dev/null || exit 1 ; \
+	done
+##########################################################################################
+
+%.bench: %.obench $(BENCH_OBJECTS)
+	$(CXX) $(CFLAGS) $(LDFLAGS) $(BENCH_OBJECTS) $< $(BENCH_LDLIBS) -o $@
+
+$(BENCH_COMPARE): $(BENCH_TOOL_SRCS:.cpp=.obench) bench/BenchResults.obench
+	$(CXX) $(CFLAGS) $(LDFLAGS) $(OBJS) $^ -o $@
+
+%.obench: %.cpp
+	$(CXX) -c $(CFLAGS) $(BENCH_CFLAGS) $(BENCH_IFLAGS) -o $@ $<
+
+$(BENCH_LIB):
+	cmake -S $(BENCH_DIR) -B $(BENCH_DIR)/build -DCMAKE_BUILD_TYPE=Release \
+	    -DBENCHMARK_ENABLE_TESTING=OFF -DBENCHMARK_ENABLE_GTEST_TESTS=OFF
+	$(MAKE) -C $(BENCH_DIR)/build benchmark
+
+cleanbench:
+	rm -f bench/*.obench $(BENCH_BINARIES) $(BENCH_COMPARE) $(BENCH_RESULTS)
@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <unistd.h>
+#include <iomanip>
+#include "BenchResults.h"
+
+using BenchResults::Timing;
+using BenchResults::TimingMap;
+
+static void usage(int /*argc*/, char * argv[])
+{
+  cout << "Usage: " << argv[0] << " [options] baseline.json result1.json result2.json..." << endl
+       << "       " << argv[0] << " -o baseline.json result1.json result2.json..." << endl << endl
+
+      << "  Compare Google Benchmark json results against a baseline, exit code is 1" << endl
+      << "    when one benchmark got slower than both the threshold and k times" << endl
+      << "    the noise (MAD) allow, failed or when a baseline benchmark wasn't run" << endl << endl
+
+      << "  Option:" << endl
+      << "    -t {percent} allowed slowdown of the median, default 25" << endl
+      << "    -k {factor}  slowdown must also exceed factor * MAD, default 3" << endl
+      << "    -o {file}    write results as new baseline instead of comparing" << endl
+      << "    -m           allow baseline benchmarks missing from the results" << endl
+      << "    -h           This message" << endl << endl;
+
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  double threshold = 25, madFactor = 3;
+  string outputPath;
+  bool isMissingAllowed = false;
+
+  int command = -1;
+  while ((command = getopt(argc, argv, "t:k:o:mh")) != -1)
+  {
+    switch (command)
+    {
+    case 't':
+      threshold = atof(optarg);
+      break;
+    case 'k':
+      madFactor = atof(optarg);
+      break;
+    case 'o':
+      outputPath = optarg;
+      break;
+    case 'm':
+      isMissingAllowed = true;
+      break;
+    case 'h':
+    default:
+      usage(argc, argv);
+      break;
+    }
+  }
+
+  const int firstResult = optind + (outputPath.empty() ? 1 : 0);
+  if (firstResult >= argc)
+  {
+    usage(argc, argv);
+  }
+
+  TimingMap results;
+  for (int arg = firstResult; arg < argc; ++arg)
+  {
+    if (!BenchResults::load(argv[arg], results))
+    {
+      return 2;
+    }
+  }
+
+  if (!outputPath.empty())
+  {
+    const bool isSaved = BenchResults::save(outputPath, results);
+    Logger::flush();
+    cout << "Wrote " << results.size() << " benchmarks to " << outputPath << endl;
+    return isSaved ? 0 : 2;
+  }
+
+  TimingMap baseline;
+  if (!BenchResults::load(argv[optind], baseline))
+  {
+    return 2;
+  }
+
+  int regressionCount = 0, failCount = 0, missingCount = 0;
+  cout << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(14) << "base ns"
+       << std::setw(14) << "new ns" << std::setw(10) << "change" << "  verdict" << endl;
+  cout << std::fixed << std::setprecision(0);
+  for (const auto& result : results)
+  {
+    const Timing& current = result.second;
+    const auto baseIt = baseline.find(result.first);
+    cout << std::left << std::setw(40) << result.first << std::right;
+    if (current.isFailed)
+    {
+      ++failCount;
+      cout << "  FAILED" << endl;
+      continue;
+    }
+    else if (baseline.end() == baseIt)
+    {
+      cout << std::setw(14) << "-" << std::setw(14) << current.median << "  new" << endl;
+      continue;
+    }
+
+    const Timing& base = baseIt->second;
+    const double change = (base.median > 0) ? (current.median / base.median - 1) * 100 : 0;
+    const double noise = madFactor * std::max(base.mad, current.mad);
+    const char* verdict = "ok";
+    if (change > threshold && current.median - base.median > noise)
+    {
+      ++regressionCount;
+      verdict = "SLOWER";
+    }
+    else if (change < -threshold && base.median - current.median > noise)
+    {
+      verdict = "faster";
+    }
+    cout << std::setw(14) << base.median << std::setw(14) << current.median
+         << std::setw(9) << std::setprecision(1) << std::showpos << change << "%"
+         << std::noshowpos << std::setprecision(0) << "  " << verdict << endl;
+  }
+
+  for (const auto& base : baseline)
+  {
+    if (results.end() == results.find(base.first))
+    {
+      // A renamed or filtered out benchmark would silently stop being checked
+      ++missingCount;
+      cout << std::left << std::setw(40) << base.first << "  NOT RUN" << endl;
+    }
+  }
+
+  cout << endl << regressionCount << " regression(s), " << failCount << " failure(s), "
+       << missingCount << " missing over " << threshold << "% and " << madFactor << " MAD" << endl;
+  return (regressionCount || failCount || (missingCount && !isMissingAllowed)) ? 1 : 0;
+}
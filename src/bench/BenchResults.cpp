@@ -0,0 +1,343 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "BenchResults.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+  /// Scalar fields of one benchmark row, numbers & bools as their text
+  typedef map<string, string> Row;
+
+  /**
+   * Just enough JSON to read the benchmarks array, anything
+   * nested deeper than its rows' scalars is skipped
+   */
+  class JsonReader
+  {
+  public:
+    JsonReader(const string& text): mText(text), mPos(0) {}
+
+    bool readRows(vector<Row>& output)
+    {
+      if (!expect_('{'))
+      {
+        return false;
+      }
+      while (!peek_('}'))
+      {
+        string key;
+        if (!readString_(key) || !expect_(':'))
+        {
+          return false;
+        }
+        if (key == "benchmarks" ? !readArray_(output) : !skipValue_())
+        {
+          return false;
+        }
+        if (!peek_('}') && !expect_(','))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+  private:
+    void skipSpaces_()
+    {
+      while (mPos < mText.size() && isspace((unsigned char) mText[mPos]))
+      {
+        ++mPos;
+      }
+    }
+
+    bool peek_(char c)
+    {
+      skipSpaces_();
+      return mPos < mText.size() && mText[mPos] == c;
+    }
+
+    bool expect_(char c)
+    {
+      if (!peek_(c))
+      {
+        return false;
+      }
+      ++mPos;
+      return true;
+    }
+
+    bool readString_(string& output)
+    {
+      output.clear();
+      if (!expect_('"'))
+      {
+        return false;
+      }
+      while (mPos < mText.size() && mText[mPos] != '"')
+      {
+        char c = mText[mPos++];
+        if (c == '\\' && mPos < mText.size())
+        {
+          c = mText[mPos++];
+          switch (c)
+          {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u':
+            // Names are ascii, anything else only needs to be skipped
+            c = (mPos + 4 <= mText.size())
+                ? (char) strtoul(mText.substr(mPos, 4).c_str(), nullptr, 16) : '?';
+            mPos += 4;
+            break;
+          default: break;
+          }
+        }
+        output += c;
+      }
+      return expect_('"');
+    }
+
+    bool readScalar_(string& output)
+    {
+      skipSpaces_();
+      const size_t start = mPos;
+      while (mPos < mText.size() && !strchr(",}] \t\r\n", mText[mPos]))
+      {
+        ++mPos;
+      }
+      output = mText.substr(start, mPos - start);
+      return !output.empty();
+    }
+
+    bool skipValue_()
+    {
+      string ignored;
+      if (peek_('"'))
+      {
+        return readString_(ignored);
+      }
+      else if (!peek_('{') && !peek_('['))
+      {
+        return readScalar_(ignored);
+      }
+
+      const char close = (mText[mPos++] == '{') ? '}' : ']';
+      while (!peek_(close))
+      {
+        if ((close == '}') && (!readString_(ignored) || !expect_(':')))
+        {
+          return false;
+        }
+        if (!skipValue_() || (!peek_(close) && !expect_(',')))
+        {
+          return false;
+        }
+      }
+      return expect_(close);
+    }
+
+    bool readArray_(vector<Row>& output)
+    {
+      if (!expect_('['))
+      {
+        return false;
+      }
+      while (!peek_(']'))
+      {
+        output.push_back(Row());
+        if (!readRow_(output.back()) || (!peek_(']') && !expect_(',')))
+        {
+          return false;
+        }
+      }
+      return expect_(']');
+    }
+
+    bool readRow_(Row& output)
+    {
+      if (!expect_('{'))
+      {
+        return false;
+      }
+      while (!peek_('}'))
+      {
+        string key, value;
+        if (!readString_(key) || !expect_(':'))
+        {
+          return false;
+        }
+        if (peek_('"') ? !readString_(value) : (peek_('{') || peek_('['))
+                                               ? !skipValue_() : !readScalar_(value))
+        {
+          return false;
+        }
+        output[key] = value;
+        if (!peek_('}') && !expect_(','))
+        {
+          return false;
+        }
+      }
+      return expect_('}');
+    }
+
+    const string& mText;
+    size_t mPos;
+  };
+
+  double to_ns(const string& unit)
+  {
+    static const map<string, double> SCALES = {{"ns", 1}, {"us", 1e3}, {"ms", 1e6}, {"s", 1e9}};
+    const auto scaleIt = SCALES.find(unit);
+    return (scaleIt == SCALES.end()) ? 1 : scaleIt->second;
+  }
+
+  const string& get_field(const Row& row, const string& key)
+  {
+    static const string EMPTY;
+    const auto fieldIt = row.find(key);
+    return (fieldIt == row.end()) ? EMPTY : fieldIt->second;
+  }
+}
+
+double BenchResults::getMedian(vector<double> values)
+{
+  if (values.empty())
+  {
+    return 0;
+  }
+
+  const size_t mid = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + mid, values.end());
+  if (values.size() % 2)
+  {
+    return values[mid];
+  }
+  return (values[mid] + *std::max_element(values.begin(), values.begin() + mid)) / 2;
+}
+
+double BenchResults::getMad(const vector<double>& values, double median)
+{
+  vector<double> deviations;
+  deviations.reserve(values.size());
+  for (const double value : values)
+  {
+    deviations.push_back(std::fabs(value - median));
+  }
+  return getMedian(deviations);
+}
+
+bool BenchResults::load(const string& path, TimingMap& output)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    LOG_ERROR("Cannot read " << path);
+    return false;
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+
+  vector<Row> rows;
+  if (!JsonReader(text.str()).readRows(rows))
+  {
+    LOG_ERROR("Malformed benchmark json " << path);
+    return false;
+  }
+
+  set<string> loadedNames;
+  for (const Row& row : rows)
+  {
+    if (get_field(row, "run_type") == "aggregate")
+    {
+      continue;
+    }
+
+    const string& runName = get_field(row, "run_name");
+    const string& name = runName.empty() ? get_field(row, "name") : runName;
+    Timing& timing = output[name];
+    loadedNames.insert(name);
+    if (get_field(row, "error_occurred") == "true")
+    {
+      timing.isFailed = true;
+    }
+    else if (!get_field(row, "median_ns").empty())
+    {
+      // Baseline row, already summed up
+      timing.median = atof(get_field(row, "median_ns").c_str());
+      timing.mad = atof(get_field(row, "mad_ns").c_str());
+      continue;
+    }
+    else
+    {
+      timing.samples.push_back(atof(get_field(row, "cpu_time").c_str())
+                               * to_ns(get_field(row, "time_unit")));
+    }
+  }
+
+  for (const string& name : loadedNames)
+  {
+    Timing& timing = output[name];
+    if (!timing.samples.empty())
+    {
+      timing.median = getMedian(timing.samples);
+      timing.mad = getMad(timing.samples, timing.median);
+    }
+  }
+
+  return true;
+}
+
+bool BenchResults::save(const string& path, const TimingMap& timings)
+{
+  std::ofstream file(path);
+  file << std::fixed << std::setprecision(1) << "{\n  \"benchmarks\": [";
+  bool isFirst = true;
+  for (const auto& timing : timings)
+  {
+    if (timing.second.isFailed)
+    {
+      continue;
+    }
+    file << (isFirst ? "\n" : ",\n") << "    {\"name\": \"" << timing.first
+         << "\", \"median_ns\": " << timing.second.median
+         << ", \"mad_ns\": " << timing.second.mad << "}";
+    isFirst = false;
+  }
+  file << "\n  ]\n}\n";
+
+  if (!file)
+  {
+    LOG_ERROR("Cannot write " << path);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_BENCH_BENCHRESULTS_H_
+#define SRC_BENCH_BENCHRESULTS_H_
+
+#include "Common.h"
+
+/**
+ * Google Benchmark JSON results boiled down to median & MAD per benchmark,
+ * which is what the checked in baseline keeps
+ */
+namespace BenchResults
+{
+  struct Timing
+  {
+    vector<double> samples; // cpu time per iteration in ns, one per repetition
+    double median;
+    double mad;             // median absolute deviation from median
+    bool isFailed;
+
+    Timing(): median(0), mad(0), isFailed(false) {}
+  };
+
+  /// map<benchmark name> = timing
+  typedef map<string, Timing> TimingMap;
+
+  /**
+   * Add benchmarks of a Google Benchmark --benchmark_out file or of a
+   * baseline written by save() to output, aggregate rows are skipped
+   * @return true on success
+   */
+  bool load(const string& path, TimingMap& output);
+
+  /**
+   * Write output as baseline, only median & MAD are kept
+   * @return true on success
+   */
+  bool save(const string& path, const TimingMap& timings);
+
+  double getMedian(vector<double> values);
+  double getMad(const vector<double>& values, double median);
+}
+
+#endif /* SRC_BENCH_BENCHRESULTS_H_ */
@@ -0,0 +1,242 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "GraphGenerator.h"
+#include <random>
+
+namespace
+{
+  typedef std::mt19937 Random;
+
+  unsigned uniform(Random& random, unsigned bound)
+  {
+    return std::uniform_int_distribution<unsigned>(0, bound - 1)(random);
+  }
+
+  /**
+   * Edges packed as from << 32 | to, sorted & deduplicated into CSR
+   */
+  void build_csr(unsigned nodeCount, vector<uint64_t>& packed, GraphGenerator::EdgeList& output)
+  {
+    std::sort(packed.begin(), packed.end());
+    packed.erase(std::unique(packed.begin(), packed.end()), packed.end());
+
+    output.nodeCount = nodeCount;
+    output.offsets.assign(nodeCount + 1, 0);
+    output.targets.clear();
+    output.targets.reserve(packed.size());
+    for (const uint64_t edge : packed)
+    {
+      const unsigned from = edge >> 32, to = (unsigned) edge;
+      if (from != to)
+      {
+        ++output.offsets[from + 1];
+        output.targets.push_back(to);
+      }
+    }
+    for (unsigned id = 0; id < nodeCount; ++id)
+    {
+      output.offsets[id + 1] += output.offsets[id];
+    }
+    vector<uint64_t>().swap(packed);
+  }
+
+  inline uint64_t pack(unsigned from, unsigned to)
+  {
+    return ((uint64_t) from << 32) | to;
+  }
+}
+
+const char* GraphGenerator::getShapeName(Shape shape)
+{
+  static const char* const NAMES[SHAPE_COUNT] =
+  {
+    "random_sparse", "chain", "giant_scc", "small_sccs", "power_law", "layered_dag"
+  };
+  return (shape < SHAPE_COUNT) ? NAMES[shape] : "unknown";
+}
+
+void GraphGenerator::generate(Shape shape, unsigned nodeCount, EdgeList& output, unsigned seed)
+{
+  static const unsigned RING_SIZE = 4, LAYER_WIDTH = 16;
+  Random random(seed);
+  vector<uint64_t> packed;
+  const unsigned n = std::max(nodeCount, 2u);
+
+  switch (shape)
+  {
+  case SHAPE_RANDOM_SPARSE:
+    packed.reserve(3ull * n);
+    for (uint64_t i = 0; i < 3ull * n; ++i)
+    {
+      packed.push_back(pack(uniform(random, n), uniform(random, n)));
+    }
+    break;
+
+  case SHAPE_CHAIN:
+    packed.reserve(n);
+    for (unsigned id = 0; id + 1 < n; ++id)
+    {
+      packed.push_back(pack(id, id + 1));
+    }
+    break;
+
+  case SHAPE_GIANT_SCC:
+    packed.reserve(3ull * n);
+    for (unsigned id = 0; id < n; ++id)
+    {
+      packed.push_back(pack(id, (id + 1) % n));
+      packed.push_back(pack(id, uniform(random, n)));
+      packed.push_back(pack(id, uniform(random, n)));
+    }
+    break;
+
+  case SHAPE_SMALL_SCCS:
+  {
+    const unsigned ringCount = (n + RING_SIZE - 1) / RING_SIZE;
+    packed.reserve(3ull * n);
+    for (unsigned id = 0; id < n; ++id)
+    {
+      const unsigned ring = id / RING_SIZE, first = ring * RING_SIZE;
+      const unsigned last = std::min(first + RING_SIZE, n) - 1;
+      packed.push_back(pack(id, (id == last) ? first : id + 1));
+
+      // Forward to a later ring only, so rings stay apart
+      if (ring + 1 < ringCount && uniform(random, 2) == 0)
+      {
+        const unsigned target = (ring + 1 + uniform(random, ringCount - ring - 1)) * RING_SIZE;
+        packed.push_back(pack(id, std::min(target, n - 1)));
+      }
+    }
+    break;
+  }
+
+  case SHAPE_POWER_LAW:
+  {
+    // A file includes ~4 older files, picking what others already include half the time
+    packed.reserve(5ull * n);
+    vector<unsigned> includedTargets;
+    includedTargets.reserve(5ull * n);
+    std::geometric_distribution<unsigned> includeCount(0.25);
+    for (unsigned id = 1; id < n; ++id)
+    {
+      const unsigned count = 1 + includeCount(random);
+      for (unsigned i = 0; i < count; ++i)
+      {
+        unsigned target;
+        if (!includedTargets.empty() && uniform(random, 2) == 0)
+        {
+          target = includedTargets[uniform(random, includedTargets.size())];
+        }
+        else
+        {
+          target = uniform(random, id);
+        }
+        packed.push_back(pack(id, target));
+        includedTargets.push_back(target);
+      }
+    }
+
+    // A few includes the wrong way make the odd circle
+    for (unsigned i = 0; i < n / 1000 + 1; ++i)
+    {
+      const unsigned from = uniform(random, n - 1);
+      packed.push_back(pack(from, from + 1 + uniform(random, n - from - 1)));
+    }
+    break;
+  }
+
+  case SHAPE_LAYERED_DAG:
+    packed.reserve(2ull * n);
+    for (unsigned id = 0; id < n; ++id)
+    {
+      const unsigned nextLayer = (id / LAYER_WIDTH + 1) * LAYER_WIDTH;
+      for (unsigned i = 0; i < 2 && nextLayer < n; ++i)
+      {
+        packed.push_back(pack(id, nextLayer + uniform(random, std::min(LAYER_WIDTH, n - nextLayer))));
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  build_csr(n, packed, output);
+}
+
+string GraphGenerator::nodeName(unsigned id)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "n%09u.h", id);
+  return name;
+}
+
+void GraphGenerator::toCompactGraph(const EdgeList& edges, CompactGraph& output)
+{
+  vector<char> names;
+  vector<unsigned> nameOffsets(edges.nodeCount);
+  names.reserve(edges.nodeCount * 13ull);
+  for (unsigned id = 0; id < edges.nodeCount; ++id)
+  {
+    const string name = nodeName(id);
+    nameOffsets[id] = names.size();
+    names.insert(names.end(), name.c_str(), name.c_str() + name.size() + 1);
+  }
+
+  vector<unsigned> offsets(edges.offsets), targets(edges.targets);
+  output.assign(names, nameOffsets, offsets, targets);
+}
+
+void GraphGenerator::toGraph(const EdgeList& edges, Graph& output)
+{
+  output.clear();
+  for (unsigned id = 0; id < edges.nodeCount; ++id)
+  {
+    Node node(nodeName(id));
+    for (unsigned edge = edges.offsets[id]; edge < edges.offsets[id + 1]; ++edge)
+    {
+      node.childNodes.insert(nodeName(edges.targets[edge]));
+    }
+    output.insert(output.end(), node);
+  }
+}
+
+void GraphGenerator::toTarjanGraph(const EdgeList& edges, TarjanGraph& output)
+{
+  output.clear();
+  vector<shared_ptr<TarjanNode> > nodes(edges.nodeCount);
+  for (unsigned id = 0; id < edges.nodeCount; ++id)
+  {
+    nodes[id] = std::make_shared<TarjanNode>(nodeName(id));
+  }
+
+  for (unsigned id = 0; id < edges.nodeCount; ++id)
+  {
+    for (unsigned edge = edges.offsets[id]; edge < edges.offsets[id + 1]; ++edge)
+    {
+      nodes[id]->childNodes.insert(nodes[edges.targets[edge]]);
+    }
+    output.insert(nodes[id]);
+  }
+}
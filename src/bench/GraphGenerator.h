@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_BENCH_GRAPHGENERATOR_H_
+#define SRC_BENCH_GRAPHGENERATOR_H_
+
+#include "CompactGraph.h"
+#include "TarjanCore.h"
+
+/**
+ * Synthetic include graphs for benchmarks, same seed gives the same graph
+ * Node i is named by nodeName(i), names sort the same way as ids
+ */
+namespace GraphGenerator
+{
+  enum Shape
+  {
+    SHAPE_RANDOM_SPARSE = 0,  // 3 uniformly random edges per node
+    SHAPE_CHAIN,              // 0 -> 1 -> ... -> n-1, as deep as it gets
+    SHAPE_GIANT_SCC,          // a ring through every node plus random chords
+    SHAPE_SMALL_SCCS,         // rings of 4 nodes, linked forward only
+    SHAPE_POWER_LAW,          // preferential attachment like real includes, few back edges
+    SHAPE_LAYERED_DAG,        // layers of 16 nodes, each linked to the next layer
+    SHAPE_COUNT
+  };
+
+  /**
+   * Sorted unique adjacency lists
+   */
+  struct EdgeList
+  {
+    unsigned nodeCount;
+    vector<unsigned> offsets;  // nodeCount + 1
+    vector<unsigned> targets;
+
+    EdgeList(): nodeCount(0) {}
+  };
+
+  /**
+   * Snake case name of shape
+   */
+  const char* getShapeName(Shape shape);
+
+  void generate(Shape shape, unsigned nodeCount, EdgeList& output, unsigned seed = 42);
+
+  string nodeName(unsigned id);
+
+  /**
+   * Conversions to what each engine takes
+   */
+  void toCompactGraph(const EdgeList& edges, CompactGraph& output);
+  void toGraph(const EdgeList& edges, Graph& output);
+  void toTarjanGraph(const EdgeList& edges, TarjanGraph& output);
+}
+
+#endif /* SRC_BENCH_GRAPHGENERATOR_H_ */
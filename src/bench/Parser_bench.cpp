@@ -0,0 +1,196 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <benchmark/benchmark.h>
+#include <linux/magic.h>
+#include <sys/vfs.h>
+#include "TreeGenerator.h"
+#include "ProjectParser.h"
+#include "TarjanSolver.h"
+
+using TreeGenerator::Tree;
+
+namespace
+{
+  // Trees are written on first use and shared by every benchmark of that size
+  map<unsigned, Tree> g_trees;
+
+  const Tree* get_tree(unsigned headerCount)
+  {
+    auto treeIt = g_trees.find(headerCount);
+    if (treeIt != g_trees.end())
+    {
+      return &treeIt->second;
+    }
+
+    Tree tree;
+    if (!TreeGenerator::makeTempRoot(tree.root))
+    {
+      return nullptr;
+    }
+    else if (!TreeGenerator::generate(tree.root, TreeGenerator::Options(headerCount), tree))
+    {
+      TreeGenerator::remove(tree.root);
+      return nullptr;
+    }
+
+    return &(g_trees[headerCount] = tree);
+  }
+
+  bool is_tmpfs(const string& path)
+  {
+    struct statfs info;
+    return (0 == statfs(path.c_str(), &info)) && (TMPFS_MAGIC == info.f_type);
+  }
+
+  /**
+   * Evict the tree before a cold run, tmpfs has nothing to evict
+   */
+  void prepare_run(benchmark::State& state, const Tree& tree, bool isCold)
+  {
+    if (isCold)
+    {
+      state.PauseTiming();
+      TreeGenerator::dropPageCache(tree);
+      state.ResumeTiming();
+    }
+  }
+
+  void set_rates(benchmark::State& state, const Tree& tree, bool isCold)
+  {
+    state.counters["files/s"] = benchmark::Counter(tree.files.size(),
+                                                   benchmark::Counter::kIsIterationInvariantRate);
+    if (isCold && is_tmpfs(tree.root))
+    {
+      state.SetLabel("tmpfs, same as warm");
+    }
+  }
+
+  void bench_parse(benchmark::State& state, bool isCold, unsigned headerCount)
+  {
+    const Tree* tree = get_tree(headerCount);
+    if (!tree)
+    {
+      state.SkipWithError("Cannot generate tree");
+      return;
+    }
+
+    const set<string> dirs = {tree->root};
+    Graph output, detailOutput;
+    ProjectParser::HeaderLocationMap locationMap;
+    for (auto _ : state)
+    {
+      prepare_run(state, *tree, isCold);
+      if (0 != ProjectParser::parse(dirs, {}, output, detailOutput, locationMap))
+      {
+        state.SkipWithError("Parser failed");
+        return;
+      }
+    }
+
+    // Parsing fast is no use if it's wrong
+    TarjanSolver solver(output);
+    set<set<string> > solution;
+    SccNameCollector collector(solver, solution);
+    if (!solver.solve(collector) || solution != tree->plantedCycles)
+    {
+      state.SkipWithError("Planted cycles not found");
+      return;
+    }
+    set_rates(state, *tree, isCold);
+    state.SetBytesProcessed(state.iterations() * tree->byteCount);
+  }
+
+  void bench_header_list(benchmark::State& state, bool isCold, unsigned headerCount)
+  {
+    const Tree* tree = get_tree(headerCount);
+    if (!tree)
+    {
+      state.SkipWithError("Cannot generate tree");
+      return;
+    }
+
+    const set<string> dirs = {tree->root};
+    set<string> headerFiles;
+    for (auto _ : state)
+    {
+      prepare_run(state, *tree, isCold);
+      if (0 != ProjectParser::generateHeaderList(dirs, headerFiles))
+      {
+        state.SkipWithError("Header listing failed");
+        return;
+      }
+    }
+
+    if (headerFiles.size() != tree->files.size())
+    {
+      state.SkipWithError("Headers missing from list");
+      return;
+    }
+    set_rates(state, *tree, isCold);
+  }
+
+  struct Suite
+  {
+    const char* name;
+    void (*run)(benchmark::State&, bool, unsigned);
+  };
+
+  const Suite SUITES[] =
+  {
+    {"Parse",      bench_parse},
+    {"HeaderList", bench_header_list},
+  };
+}
+
+int main(int argc, char** argv)
+{
+  static const unsigned MIN_HEADERS = 1000, MAX_HEADERS = 10000;
+  for (const Suite& suite : SUITES)
+  {
+    for (const bool isCold : {false, true})
+    {
+      for (unsigned headerCount = MIN_HEADERS; headerCount <= MAX_HEADERS; headerCount *= 10)
+      {
+        const string name = string(suite.name) + (isCold ? "/cold/" : "/warm/")
+                            + std::to_string(headerCount);
+        benchmark::RegisterBenchmark(name.c_str(), suite.run, isCold, headerCount)
+            ->Unit(benchmark::kMillisecond);
+      }
+    }
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  for (const auto& tree : g_trees)
+  {
+    TreeGenerator::remove(tree.second.root);
+  }
+  return 0;
+}
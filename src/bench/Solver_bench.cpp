@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <benchmark/benchmark.h>
+#include "GraphGenerator.h"
+#include "TarjanSolver.h"
+
+using GraphGenerator::EdgeList;
+using GraphGenerator::Shape;
+
+namespace
+{
+  class CountingVisitor: public SccVisitor
+  {
+  public:
+    CountingVisitor(): count(0) {}
+    void visitScc(const unsigned* /*ids*/, size_t /*count*/) { ++count; }
+
+    size_t count;
+  };
+
+  /**
+   * Report throughput as nodes/s & edges/s of the whole graph
+   */
+  void set_rates(benchmark::State& state, const EdgeList& edges)
+  {
+    state.counters["nodes/s"] = benchmark::Counter(edges.nodeCount,
+                                                   benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["edges/s"] = benchmark::Counter(edges.targets.size(),
+                                                   benchmark::Counter::kIsIterationInvariantRate);
+  }
+
+  void bench_scc_stream(benchmark::State& state, Shape shape, unsigned nodeCount)
+  {
+    EdgeList edges;
+    GraphGenerator::generate(shape, nodeCount, edges);
+    CompactGraph graph;
+    GraphGenerator::toCompactGraph(edges, graph);
+
+    for (auto _ : state)
+    {
+      CountingVisitor visitor;
+      SccStream::solve(graph, visitor, true);
+      benchmark::DoNotOptimize(visitor.count);
+    }
+    set_rates(state, edges);
+  }
+
+  void bench_solver_stream(benchmark::State& state, Shape shape, unsigned nodeCount)
+  {
+    EdgeList edges;
+    GraphGenerator::generate(shape, nodeCount, edges);
+    Graph graph;
+    GraphGenerator::toGraph(edges, graph);
+
+    // Includes converting the node set to compact form, as spinclude does
+    for (auto _ : state)
+    {
+      TarjanSolver solver(graph);
+      CountingVisitor visitor;
+      solver.solve(visitor);
+      benchmark::DoNotOptimize(visitor.count);
+    }
+    set_rates(state, edges);
+  }
+
+  void bench_solver(benchmark::State& state, Shape shape, unsigned nodeCount)
+  {
+    EdgeList edges;
+    GraphGenerator::generate(shape, nodeCount, edges);
+    Graph graph;
+    GraphGenerator::toGraph(edges, graph);
+
+    for (auto _ : state)
+    {
+      TarjanSolver solver(graph);
+      if (!solver.solve())
+      {
+        state.SkipWithError("TarjanSolver failed");
+        break;
+      }
+      benchmark::DoNotOptimize(solver.getSolution().size());
+    }
+    set_rates(state, edges);
+  }
+
+  void bench_core(benchmark::State& state, Shape shape, unsigned nodeCount)
+  {
+    EdgeList edges;
+    GraphGenerator::generate(shape, nodeCount, edges);
+
+    // The core writes into its nodes, each run gets fresh ones
+    for (auto _ : state)
+    {
+      state.PauseTiming();
+      TarjanGraph graph;
+      GraphGenerator::toTarjanGraph(edges, graph);
+      state.ResumeTiming();
+
+      TarjanCore core(graph);
+      if (!core.solve())
+      {
+        state.SkipWithError("TarjanCore failed");
+        break;
+      }
+      benchmark::DoNotOptimize(core.getSolution().size());
+
+      // Nodes point at each other, break the cycles before they're dropped
+      state.PauseTiming();
+      for (const auto& node : graph)
+      {
+        node->childNodes.clear();
+        node->parentNodes.clear();
+      }
+      state.ResumeTiming();
+    }
+    set_rates(state, edges);
+  }
+
+  /**
+   * Solver engines under test, new engines go here
+   * Deep shapes (chain, layered) recurse in the reference engines, so
+   * they get a lower cap there
+   */
+  struct Engine
+  {
+    const char* name;
+    unsigned maxNodes;
+    unsigned maxDeepNodes;
+    void (*run)(benchmark::State&, Shape, unsigned);
+  };
+
+  const Engine ENGINES[] =
+  {
+    {"SccStream",         10000000, 10000000, bench_scc_stream},
+    {"TarjanSolverStream", 1000000,  1000000, bench_solver_stream},
+    {"TarjanSolver",        100000,    10000, bench_solver},
+    {"TarjanCore",          100000,    10000, bench_core},
+  };
+}
+
+int main(int argc, char** argv)
+{
+  static const unsigned MIN_NODES = 1000;
+  for (const Engine& engine : ENGINES)
+  {
+    for (int shape = 0; shape < GraphGenerator::SHAPE_COUNT; ++shape)
+    {
+      const bool isDeep = (GraphGenerator::SHAPE_CHAIN == shape)
+                          || (GraphGenerator::SHAPE_LAYERED_DAG == shape);
+      const unsigned maxNodes = isDeep ? engine.maxDeepNodes : engine.maxNodes;
+      for (unsigned nodeCount = MIN_NODES; nodeCount <= maxNodes; nodeCount *= 10)
+      {
+        const string name = string(engine.name) + "/" + GraphGenerator::getShapeName((Shape) shape)
+                            + "/" + std::to_string(nodeCount);
+        benchmark::RegisterBenchmark(name.c_str(), engine.run, (Shape) shape, nodeCount)
+            ->Unit(benchmark::kMillisecond);
+      }
+    }
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
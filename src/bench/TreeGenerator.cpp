@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "TreeGenerator.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <random>
+
+namespace
+{
+  typedef std::mt19937 Random;
+
+  // Each dir holds up to this many sub dirs
+  const unsigned DIR_FANOUT = 4;
+
+  unsigned uniform(Random& random, unsigned bound)
+  {
+    return std::uniform_int_distribution<unsigned>(0, bound - 1)(random);
+  }
+
+  string format(const char* fmt, unsigned a, unsigned b = 0, unsigned c = 0)
+  {
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), fmt, a, b, c);
+    return buffer;
+  }
+
+  string header_name(unsigned id)
+  {
+    return format("h%06u.h", id);
+  }
+
+  /**
+   * Comment or code line for body of header id, comments sometimes hold
+   * an include going backwards which would make a cycle if it were parsed
+   */
+  string body_line(Random& random, unsigned id, unsigned line, unsigned commentPercent)
+  {
+    if (uniform(random, 100) >= commentPercent)
+    {
+      return format("static inline int f%06u_%u(int x) { return x * %u + 1; }\n", id, line,
+                    uniform(random, 1000));
+    }
+
+    switch (uniform(random, 3))
+    {
+    case 0:
+      if (id > 0)
+      {
+        return "// #include \"" + header_name(uniform(random, id)) + "\"\n";
+      }
+      // fall through
+    case 1:
+      return format("// note %u for f%06u, keep it in sync with its callers\n", line, id);
+    default:
+      return format("/* f%06u_%u: documented behaviour, see the design notes */\n", id, line);
+    }
+  }
+
+  int remove_item(const char* path, const struct stat* /*info*/, int /*flag*/, struct FTW* /*ftw*/)
+  {
+    return ::remove(path);
+  }
+}
+
+bool TreeGenerator::makeTempRoot(string& output)
+{
+  const char* base = getenv("SPINCLUDE_BENCH_DIR");
+  string pathTemplate = string((base && *base) ? base : "/tmp") + "/spinclude-bench-XXXXXX";
+  if (!mkdtemp(&pathTemplate[0]))
+  {
+    LOG_ERROR("Cannot create temp dir " << pathTemplate << ": " << strerror(errno));
+    return false;
+  }
+
+  output = pathTemplate;
+  return true;
+}
+
+bool TreeGenerator::generate(const string& root, const Options& options, Tree& output)
+{
+  const unsigned headerCount = options.headerCount;
+  const unsigned dirCount = std::max(options.dirCount, 1u);
+  const string rootPath = root; // root may be output.root
+  output = Tree();
+  output.root = rootPath;
+
+  vector<string> dirs(dirCount);
+  for (unsigned id = 0; id < dirCount; ++id)
+  {
+    dirs[id] = ((id == 0) ? rootPath : dirs[(id - 1) / DIR_FANOUT]) + format("/d%04u", id);
+    if (0 != mkdir(dirs[id].c_str(), 0755))
+    {
+      LOG_ERROR("Cannot create " << dirs[id] << ": " << strerror(errno));
+      return false;
+    }
+  }
+
+  // Forward edges only, then each cycle is a run of headers chained
+  // forward plus one edge back to its start
+  Random random(options.seed);
+  vector<set<unsigned> > includes(headerCount);
+  for (unsigned id = 0; id + 1 < headerCount; ++id)
+  {
+    for (unsigned edge = 0; edge < options.fanout; ++edge)
+    {
+      includes[id].insert(id + 1 + uniform(random, headerCount - id - 1));
+    }
+  }
+
+  const unsigned cycleLength = std::max(options.cycleLength, 2u);
+  const unsigned cycleCount = std::min(options.cycleCount, headerCount / cycleLength);
+  for (unsigned cycle = 0; cycle < cycleCount; ++cycle)
+  {
+    const unsigned start = cycle * (headerCount / cycleCount);
+    set<string> names;
+    for (unsigned step = 0; step < cycleLength; ++step)
+    {
+      const unsigned id = start + step;
+      includes[id].insert((step + 1 < cycleLength) ? id + 1 : start);
+      names.insert(header_name(id));
+    }
+    output.plantedCycles.insert(names);
+  }
+
+  output.files.reserve(headerCount);
+  string content;
+  for (unsigned id = 0; id < headerCount; ++id)
+  {
+    const string name = header_name(id);
+    const string guard = format("H%06u_H_", id);
+    content = "// " + name + ", generated for benchmarks\n";
+    content += "#ifndef " + guard + "\n#define " + guard + "\n\n";
+
+    if (id % 4 == 0)
+    {
+      // System include, no extension so the parser keeps it out
+      content += "#include <vector>\n";
+      ++output.includeCount;
+    }
+    for (const unsigned child : includes[id])
+    {
+      // Some includes go by path, the parser only keeps the basename
+      const string childName = header_name(child);
+      content += (child % 3 == 0)
+          ? "#include \"" + format("d%04u/", child % dirCount) + childName + "\"\n"
+          : "#include \"" + childName + "\"\n";
+      ++output.includeCount;
+    }
+    content += "\n";
+
+    for (unsigned line = 0; line < options.linesPerFile; ++line)
+    {
+      content += body_line(random, id, line, options.commentPercent);
+    }
+    content += "\n#endif /* " + guard + " */\n";
+
+    const string path = dirs[id % dirCount] + "/" + name;
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+      LOG_ERROR("Cannot create " << path << ": " << strerror(errno));
+      return false;
+    }
+    const bool isWritten = (content.size() == fwrite(content.data(), 1, content.size(), file));
+    if (0 != fclose(file) || !isWritten)
+    {
+      LOG_ERROR("Cannot write " << path);
+      return false;
+    }
+
+    output.files.push_back(path);
+    output.byteCount += content.size();
+  }
+
+  return true;
+}
+
+size_t TreeGenerator::dropPageCache(const Tree& tree)
+{
+  size_t retVal = 0;
+  for (const string& path : tree.files)
+  {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      continue;
+    }
+
+    // Dirty pages can't be dropped, write them out first
+    fdatasync(fd);
+    if (0 == posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED))
+    {
+      ++retVal;
+    }
+    close(fd);
+  }
+
+  return retVal;
+}
+
+bool TreeGenerator::remove(const string& root)
+{
+  return 0 == nftw(root.c_str(), remove_item, 16, FTW_DEPTH | FTW_PHYS);
+}
@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_BENCH_TREEGENERATOR_H_
+#define SRC_BENCH_TREEGENERATOR_H_
+
+#include "Common.h"
+
+/**
+ * Synthetic project trees on disk for parser benchmarks, same options give
+ * the same tree. Headers only include ones with a higher index except in
+ * planted cycles, so the planted cycles are exactly the non trivial SCCs
+ */
+namespace TreeGenerator
+{
+  struct Options
+  {
+    unsigned dirCount;        // nested 4 wide under root
+    unsigned headerCount;
+    unsigned fanout;          // includes per header
+    unsigned linesPerFile;    // body lines besides includes & guards
+    unsigned commentPercent;  // share of body lines that are comments
+    unsigned cycleCount;
+    unsigned cycleLength;
+    unsigned seed;
+
+    Options(unsigned headers = 1000):
+      dirCount(headers / 20 + 1), headerCount(headers), fanout(4), linesPerFile(60),
+      commentPercent(30), cycleCount(10), cycleLength(3), seed(42) {}
+  };
+
+  struct Tree
+  {
+    string root;
+    vector<string> files;             // every header written
+    set<set<string> > plantedCycles;  // header basenames
+    uint64_t byteCount;
+    uint64_t includeCount;
+
+    Tree(): byteCount(0), includeCount(0) {}
+  };
+
+  /**
+   * Fresh temp dir under $SPINCLUDE_BENCH_DIR, /tmp if not set,
+   * point that at a tmpfs like /dev/shm to keep disks out of it
+   * @return true on success
+   */
+  bool makeTempRoot(string& output);
+
+  /**
+   * Write the tree into root, which must exist
+   * @return true on success
+   */
+  bool generate(const string& root, const Options& options, Tree& output);
+
+  /**
+   * Flush & evict file pages of the tree from the page cache,
+   * dentries & inodes stay cached, dropping them needs root
+   * @return number of files evicted
+   */
+  size_t dropPageCache(const Tree& tree);
+
+  /**
+   * Recursively delete the tree root
+   */
+  bool remove(const string& root);
+}
+
+#endif /* SRC_BENCH_TREEGENERATOR_H_ */
@@ -0,0 +1,551 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "libspinclude.h"
+#include "Condensation.h"
+#include "ConfigFile.h"
+#include "CycleBaseline.h"
+#include "GraphQuery.h"
+#include "GraphSnapshot.h"
+#include "ProjectParser.h"
+#include "ReachabilityIndex.h"
+#include "TarjanSolver.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+struct spinclude_session
+{
+  spinclude_allocator allocator;
+  ConfigData config;
+  bool scanSources;
+
+  // Warm state, the index is kept until exclude dirs change
+  bool isIndexed;
+  set<string> indexedDirs;
+  set<string> dirHeaders;
+  ProjectParser::ScanCache scanCache;
+
+  spinclude_session(const spinclude_allocator& _allocator):
+    allocator(_allocator), scanSources(false), isIndexed(false)
+  {
+    config.projDirs.clear();
+  }
+};
+
+struct spinclude_graph
+{
+  spinclude_session* session;
+  CompactGraph parsed;
+  GraphSnapshot snapshot;
+  CompactGraph* graph;
+
+  // Built by the first reachability query
+  std::unique_ptr<Condensation> dag;
+  std::unique_ptr<ReachabilityIndex> index;
+  ProjectParser::HeaderLocationMap locationMap;
+
+  spinclude_graph(spinclude_session* _session): session(_session), graph(&parsed) {}
+};
+
+namespace
+{
+  void* default_alloc(void* /*context*/, size_t size)
+  {
+    return malloc(size);
+  }
+
+  void default_free(void* /*context*/, void* ptr)
+  {
+    free(ptr);
+  }
+
+  template <typename T, typename... Args>
+  T* create_object(const spinclude_allocator& allocator, Args&&... args)
+  {
+    void* memory = allocator.alloc(allocator.context, sizeof(T));
+    if (!memory)
+    {
+      return nullptr;
+    }
+
+    try
+    {
+      return new (memory) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      allocator.free(allocator.context, memory);
+      return nullptr;
+    }
+  }
+
+  void destroy_session(spinclude_session* session)
+  {
+    // Allocator is copied first, it goes with the session
+    const spinclude_allocator allocator = session->allocator;
+    session->~spinclude_session();
+    allocator.free(allocator.context, session);
+  }
+
+  void destroy_graph(spinclude_graph* graph)
+  {
+    const spinclude_allocator allocator = graph->session->allocator;
+    graph->~spinclude_graph();
+    allocator.free(allocator.context, graph);
+  }
+
+  /**
+   * Owns a graph until it's handed to the caller, so a throw can't leak it
+   */
+  struct GraphDeleter
+  {
+    void operator()(spinclude_graph* graph) const
+    {
+      destroy_graph(graph);
+    }
+  };
+  typedef std::unique_ptr<spinclude_graph, GraphDeleter> GraphPtr;
+
+  /**
+   * Body of an API call, no exception gets through the C ABI
+   */
+  template <typename Function>
+  int guard(Function function)
+  {
+    try
+    {
+      return function();
+    }
+    catch (const std::bad_alloc&)
+    {
+      return SPINCLUDE_ERR_NOMEM;
+    }
+    catch (...)
+    {
+      return SPINCLUDE_ERR_ARG;
+    }
+  }
+
+  /**
+   * Copy lists into 1 block from allocator: the spinclude_list array,
+   * then item pointers, then the names
+   * @param header  bytes kept free in front of the lists, e.g. spinclude_cycles
+   */
+  void* pack_lists(const spinclude_allocator& allocator, size_t header,
+                   const vector<vector<const char*> >& lists, spinclude_list*& listOutput)
+  {
+    size_t itemCount = 0, nameBytes = 0;
+    for (const auto& list : lists)
+    {
+      itemCount += list.size();
+      for (const char* name : list)
+      {
+        nameBytes += strlen(name) + 1;
+      }
+    }
+
+    const size_t listBytes = header + lists.size() * sizeof(spinclude_list);
+    char* block = static_cast<char*>(allocator.alloc(allocator.context,
+        listBytes + itemCount * sizeof(const char*) + nameBytes));
+    if (!block)
+    {
+      return nullptr;
+    }
+
+    listOutput = reinterpret_cast<spinclude_list*>(block + header);
+    const char** items = reinterpret_cast<const char**>(block + listBytes);
+    char* names = reinterpret_cast<char*>(items + itemCount);
+    for (size_t i = 0; i < lists.size(); ++i)
+    {
+      listOutput[i].count = lists[i].size();
+      listOutput[i].items = items;
+      for (const char* name : lists[i])
+      {
+        const size_t size = strlen(name) + 1;
+        memcpy(names, name, size);
+        *items++ = names;
+        names += size;
+      }
+    }
+
+    return block;
+  }
+
+  int pack_list(const spinclude_allocator& allocator, const CompactGraph& graph,
+                const vector<unsigned>& ids, spinclude_list** output)
+  {
+    vector<vector<const char*> > lists(1);
+    for (const unsigned id : ids)
+    {
+      lists[0].push_back(graph.name(id));
+    }
+
+    spinclude_list* list = nullptr;
+    *output = static_cast<spinclude_list*>(pack_lists(allocator, 0, lists, list));
+    return *output ? SPINCLUDE_OK : SPINCLUDE_ERR_NOMEM;
+  }
+
+  /**
+   * Condensed graph & reachability index, built once per graph
+   */
+  bool build_index(spinclude_graph* graph)
+  {
+    if (!graph->index)
+    {
+      std::unique_ptr<Condensation> dag(new Condensation(*graph->graph));
+      if (!dag->solve())
+      {
+        return false;
+      }
+      graph->index.reset(new ReachabilityIndex(*dag));
+      graph->dag = std::move(dag);
+      graph->index->build();
+    }
+    return true;
+  }
+}
+
+int spinclude_api_version(void)
+{
+  return SPINCLUDE_API_VERSION;
+}
+
+spinclude_session* spinclude_session_new(const spinclude_allocator* allocator)
+{
+  spinclude_allocator sessionAllocator = {default_alloc, default_free, nullptr};
+  if (allocator)
+  {
+    if (!allocator->alloc || !allocator->free)
+    {
+      return nullptr;
+    }
+    sessionAllocator = *allocator;
+  }
+
+  return create_object<spinclude_session>(sessionAllocator, sessionAllocator);
+}
+
+void spinclude_session_free(spinclude_session* session)
+{
+  if (session)
+  {
+    destroy_session(session);
+  }
+}
+
+int spinclude_config_load(spinclude_session* session, const char* cfgPath)
+{
+  if (!session || !cfgPath)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  return guard([&]() -> int
+  {
+    ConfigFile cfgFile(cfgPath);
+    if (!cfgFile.parse())
+    {
+      LOG_ERROR("Error parsing " << cfgPath);
+      return SPINCLUDE_ERR_PARSE;
+    }
+    session->config = cfgFile.data();
+    return SPINCLUDE_OK;
+  });
+}
+
+int spinclude_config_add(spinclude_session* session, spinclude_key key, const char* value)
+{
+  if (!session || !value)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  return guard([&]() -> int
+  {
+    switch (key)
+    {
+    case SPINCLUDE_PROJECT_DIR:
+      session->config.projDirs.insert(value);
+      break;
+    case SPINCLUDE_EXCLUDE_DIR:
+      session->config.excludedDirs.insert(value);
+      break;
+    case SPINCLUDE_EXCLUDE_FILE:
+      session->config.excludedFiles.insert(value);
+      break;
+    default:
+      return SPINCLUDE_ERR_ARG;
+    }
+    return SPINCLUDE_OK;
+  });
+}
+
+int spinclude_config_set_scan_sources(spinclude_session* session, int isEnabled)
+{
+  if (!session)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  session->scanSources = (isEnabled != 0);
+  return SPINCLUDE_OK;
+}
+
+int spinclude_scan(spinclude_session* session, spinclude_graph** output)
+{
+  if (!session || !output)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  *output = nullptr;
+  return guard([&]() -> int
+  {
+    set<string> excludedDirs, excludedFiles;
+    PathMatcher excludedPaths;
+    ProjectParser::splitExcludes(session->config.excludedDirs, excludedDirs, excludedPaths);
+    ProjectParser::splitExcludes(session->config.excludedFiles, excludedFiles, excludedPaths);
+    if (!session->isIndexed || session->indexedDirs != excludedDirs)
+    {
+      session->dirHeaders.clear();
+      if (0 != ProjectParser::generateHeaderList(excludedDirs, session->dirHeaders))
+      {
+        LOG_ERROR("Error generating excluded files from excluded dirs, ignoring these dirs");
+        session->dirHeaders.clear();
+      }
+      session->indexedDirs = excludedDirs;
+      session->isIndexed = true;
+    }
+
+    set<string> allExcludedFiles(session->dirHeaders);
+    allExcludedFiles.insert(excludedFiles.begin(), excludedFiles.end());
+
+    GraphPtr graph(create_object<spinclude_graph>(session->allocator, session));
+    if (!graph)
+    {
+      return SPINCLUDE_ERR_NOMEM;
+    }
+
+    Graph headerFileGraph, detailHeaderFileGraph;
+    const int parseCode = ProjectParser::parse(session->config.projDirs, allExcludedFiles,
+        headerFileGraph, detailHeaderFileGraph, graph->locationMap, session->scanSources, nullptr,
+        excludedPaths.empty() ? nullptr : &excludedPaths, &session->scanCache);
+    if (parseCode < 0)
+    {
+      return SPINCLUDE_ERR_PARSE;
+    }
+
+    graph->parsed.assign(headerFileGraph);
+    *output = graph.release();
+    return parseCode;
+  });
+}
+
+int spinclude_snapshot_load(spinclude_session* session, const char* path,
+                            spinclude_graph** output)
+{
+  if (!session || !path || !output)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  *output = nullptr;
+  return guard([&]() -> int
+  {
+    GraphPtr graph(create_object<spinclude_graph>(session->allocator, session));
+    if (!graph)
+    {
+      return SPINCLUDE_ERR_NOMEM;
+    }
+    if (!graph->snapshot.open(path))
+    {
+      return SPINCLUDE_ERR_IO;
+    }
+
+    graph->graph = &graph->snapshot.graph();
+    graph->snapshot.getLocationMap(graph->locationMap);
+    *output = graph.release();
+    return SPINCLUDE_OK;
+  });
+}
+
+int spinclude_snapshot_save(spinclude_graph* graph, const char* path, int compress)
+{
+  if (!graph || !path)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  return guard([&]() -> int
+  {
+    return GraphSnapshot::write(path, *graph->graph, graph->locationMap, compress != 0)
+        ? SPINCLUDE_OK : SPINCLUDE_ERR_IO;
+  });
+}
+
+void spinclude_graph_free(spinclude_graph* graph)
+{
+  if (graph)
+  {
+    destroy_graph(graph);
+  }
+}
+
+size_t spinclude_graph_node_count(const spinclude_graph* graph)
+{
+  return graph ? graph->graph->size() : 0;
+}
+
+size_t spinclude_graph_edge_count(const spinclude_graph* graph)
+{
+  return graph ? graph->graph->edgeCount() : 0;
+}
+
+int spinclude_solve(const spinclude_graph* graph, spinclude_cycles** output)
+{
+  if (!graph || !output)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  *output = nullptr;
+  return guard([&]() -> int
+  {
+    TarjanSolver solver(*graph->graph);
+    set<set<string> > solution;
+    SccNameCollector collector(solver, solution);
+    if (!solver.solve(collector))
+    {
+      return SPINCLUDE_ERR_SOLVE;
+    }
+
+    CycleBaseline::CycleList cycles;
+    CycleBaseline::fromSolution(solution, cycles);
+    vector<vector<const char*> > lists(cycles.size());
+    for (size_t i = 0; i < cycles.size(); ++i)
+    {
+      for (const string& member : cycles[i])
+      {
+        lists[i].push_back(member.c_str());
+      }
+    }
+
+    spinclude_list* packed = nullptr;
+    spinclude_cycles* result = static_cast<spinclude_cycles*>(
+        pack_lists(graph->session->allocator, sizeof(spinclude_cycles), lists, packed));
+    if (!result)
+    {
+      return SPINCLUDE_ERR_NOMEM;
+    }
+    result->count = cycles.size();
+    result->cycles = packed;
+    *output = result;
+    return SPINCLUDE_OK;
+  });
+}
+
+int spinclude_query_includes(spinclude_graph* graph, const char* from, const char* to)
+{
+  if (!graph || !from || !to)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  return guard([&]() -> int
+  {
+    unsigned fromId, toId;
+    if (!GraphQuery::findFile(*graph->graph, from, fromId)
+        || !GraphQuery::findFile(*graph->graph, to, toId))
+    {
+      return SPINCLUDE_ERR_NOT_FOUND;
+    }
+    if (!build_index(graph))
+    {
+      return SPINCLUDE_ERR_SOLVE;
+    }
+    return graph->index->reaches(fromId, toId) ? 1 : 0;
+  });
+}
+
+int spinclude_query_closure(spinclude_graph* graph, const char* header, spinclude_list** output)
+{
+  if (!graph || !header || !output)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  *output = nullptr;
+  return guard([&]() -> int
+  {
+    unsigned id;
+    if (!GraphQuery::findFile(*graph->graph, header, id))
+    {
+      return SPINCLUDE_ERR_NOT_FOUND;
+    }
+    if (!build_index(graph))
+    {
+      return SPINCLUDE_ERR_SOLVE;
+    }
+
+    vector<unsigned> closure;
+    graph->index->getClosure(id, closure);
+    return pack_list(graph->session->allocator, *graph->graph, closure, output);
+  });
+}
+
+int spinclude_query_impact(spinclude_graph* graph, const char* const* files, size_t fileCount,
+                           spinclude_list** output)
+{
+  if (!graph || (!files && fileCount > 0) || !output)
+  {
+    return SPINCLUDE_ERR_ARG;
+  }
+
+  *output = nullptr;
+  return guard([&]() -> int
+  {
+    vector<unsigned> changedIds;
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+      unsigned id;
+      if (files[i] && GraphQuery::findFile(*graph->graph, files[i], id))
+      {
+        changedIds.push_back(id);
+      }
+    }
+
+    graph->graph->generateParents();
+    vector<unsigned> affectedIds;
+    GraphQuery::getDependents(*graph->graph, changedIds, affectedIds);
+    return pack_list(graph->session->allocator, *graph->graph, affectedIds, output);
+  });
+}
+
+void spinclude_result_free(spinclude_session* session, void* result)
+{
+  if (session && result)
+  {
+    session->allocator.free(session->allocator.context, result);
+  }
+}
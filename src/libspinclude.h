@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef SRC_LIBSPINCLUDE_H_
+#define SRC_LIBSPINCLUDE_H_
+
+/*
+ * C API of libspinclude, for keeping a warm spinclude in process
+ *
+ * Handles are opaque and allocated through the allocator given to
+ * spinclude_session_new, so are results handed to the caller. A session
+ * keeps its exclude dir index and file scans between scans, a rescan only
+ * reads files whose size or mtime changed. A session and the graphs it
+ * made must be used by one thread at a time, graphs are freed before
+ * their session.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(SPINCLUDE_BUILD_SHARED)
+#define SPINCLUDE_API __attribute__((visibility("default")))
+#else
+#define SPINCLUDE_API
+#endif
+
+/* Bumped when a declaration below changes incompatibly */
+#define SPINCLUDE_API_VERSION 1
+
+/* Return codes, 0 or positive on success */
+enum
+{
+  SPINCLUDE_OK = 0,
+  SPINCLUDE_ERR_ARG = -1,       /* NULL handle or bad value */
+  SPINCLUDE_ERR_NOMEM = -2,
+  SPINCLUDE_ERR_IO = -3,        /* file can't be read or written */
+  SPINCLUDE_ERR_PARSE = -4,     /* bad cfg file or project dirs */
+  SPINCLUDE_ERR_SOLVE = -5,
+  SPINCLUDE_ERR_NOT_FOUND = -6  /* queried file isn't in graph */
+};
+
+/* Config keys, same as in cfg files */
+typedef enum
+{
+  SPINCLUDE_PROJECT_DIR = 0,
+  SPINCLUDE_EXCLUDE_DIR,        /* dir or glob */
+  SPINCLUDE_EXCLUDE_FILE        /* basename or glob */
+} spinclude_key;
+
+/* Memory for handles & results, context is passed back as is */
+typedef struct spinclude_allocator
+{
+  void* (*alloc)(void* context, size_t size);
+  void (*free)(void* context, void* ptr);
+  void* context;
+} spinclude_allocator;
+
+/* Names in a result, valid until the result is freed */
+typedef struct spinclude_list
+{
+  size_t count;
+  const char* const* items;
+} spinclude_list;
+
+/* Circles in a result, members of each are sorted */
+typedef struct spinclude_cycles
+{
+  size_t count;
+  const spinclude_list* cycles;
+} spinclude_cycles;
+
+typedef struct spinclude_session spinclude_session;
+typedef struct spinclude_graph spinclude_graph;
+
+SPINCLUDE_API int spinclude_api_version(void);
+
+/*
+ * New session with no project dir and the default excludes
+ * allocator may be NULL for malloc & free, it's copied
+ * Returns NULL when out of memory
+ */
+SPINCLUDE_API spinclude_session* spinclude_session_new(const spinclude_allocator* allocator);
+SPINCLUDE_API void spinclude_session_free(spinclude_session* session);
+
+/* Replace config with a cfg file */
+SPINCLUDE_API int spinclude_config_load(spinclude_session* session, const char* cfgPath);
+
+/* Add a value to config */
+SPINCLUDE_API int spinclude_config_add(spinclude_session* session, spinclude_key key,
+                                       const char* value);
+
+/* Also scan translation units (.c, .cpp...), off by default */
+SPINCLUDE_API int spinclude_config_set_scan_sources(spinclude_session* session, int isEnabled);
+
+/*
+ * Parse project dirs of config into a new graph
+ * Returns the parse warning code (>= 0) on success
+ */
+SPINCLUDE_API int spinclude_scan(spinclude_session* session, spinclude_graph** output);
+
+/* Map a snapshot written by spinclude --snapshot or spinclude_snapshot_save */
+SPINCLUDE_API int spinclude_snapshot_load(spinclude_session* session, const char* path,
+                                          spinclude_graph** output);
+SPINCLUDE_API int spinclude_snapshot_save(spinclude_graph* graph, const char* path, int compress);
+
+SPINCLUDE_API void spinclude_graph_free(spinclude_graph* graph);
+SPINCLUDE_API size_t spinclude_graph_node_count(const spinclude_graph* graph);
+SPINCLUDE_API size_t spinclude_graph_edge_count(const spinclude_graph* graph);
+
+/* Circles of graph, free with spinclude_result_free */
+SPINCLUDE_API int spinclude_solve(const spinclude_graph* graph, spinclude_cycles** output);
+
+/* Returns 1 if header from transitively includes header to, 0 if not */
+SPINCLUDE_API int spinclude_query_includes(spinclude_graph* graph, const char* from,
+                                           const char* to);
+
+/* Every header transitively included by header */
+SPINCLUDE_API int spinclude_query_closure(spinclude_graph* graph, const char* header,
+                                          spinclude_list** output);
+
+/* Every file transitively including one of files, unknown files are skipped */
+SPINCLUDE_API int spinclude_query_impact(spinclude_graph* graph, const char* const* files,
+                                         size_t fileCount, spinclude_list** output);
+
+/* Free a spinclude_list or spinclude_cycles through the session allocator, NULL is ignored */
+SPINCLUDE_API void spinclude_result_free(spinclude_session* session, void* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_LIBSPINCLUDE_H_ */
@@ -25,16 +25,40 @@
 #include <signal.h>
 #include <execinfo.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <fstream>
 
 #include "TarjanSolver.h"
 #include "ProjectParser.h"
 #include "ConfigFile.h"
+#include "ReachabilityIndex.h"
+#include "GraphQuery.h"
+#include "FanoutReport.h"
+#include "CycleBaseline.h"
+#include "GraphSnapshot.h"
+#include "Trace.h"
+#include "BatchRunner.h"
+#include "QueryServer.h"
+#include "DepfileLoader.h"
+#include "NinjaDepsLoader.h"
+#include "ParseCost.h"
 
 #include "_default_proj_cfg.h"
 
 const string DEFAULT_CFG_FILE = "Project.cfg";
 
+/// Filled in as the run goes, printed to stderr on exit with --stats
+enum StatsFormat
+{
+  STATS_NONE,
+  STATS_TEXT,
+  STATS_JSON
+};
+static RunStats g_runStats;
+static StatsFormat g_statsFormat = STATS_NONE;
+static string g_tracePath;
+static QueryServer* g_server = nullptr;
+
 static void usage(int /*argc*/, char * argv[])
 {
   cout << "Usage: " << argv[0] << " [options] [dir1 dir2...]" << endl << endl
@@ -43,35 +67,648 @@ static void usage(int /*argc*/, char * argv[])
       << "    if [dir1 dir2...] is blank, use current pwd as project dir" << endl << endl
 
       << "  Option:" << endl
-      << "    -c {cfg file}   use project config file" << endl
-      << "    -g              generate config file " << DEFAULT_CFG_FILE << endl
-      << "    -v              verbose mode" << endl
-      << "    -h              This message, (version " __DATE__ << " " << __TIME__ << ")" << endl << endl;
+      << "    -c {cfg file}       use project config file" << endl
+      << "    -g                  generate config file " << DEFAULT_CFG_FILE << endl
+      << "    -v                  verbose mode" << endl
+      << "    -t                  also scan translation units (.c, .cpp...)" << endl
+      << "    --includes {a,b}    check if header a transitively includes header b" << endl
+      << "    --closure {header}  list every header transitively included by header" << endl
+      << "    --chain {a,b}       print the shortest include chain from header a to header b" << endl
+      << "    --impact {file|-}   list every file that transitively includes file," << endl
+      << "                        - reads a list of changed files from stdin" << endl
+      << "    --fanout {N}        rank top N headers by translation units including them, implies -t" << endl
+      << "    --baseline {file}   only report circles that are new or grown since baseline file," << endl
+      << "                        exit code 4 if there's any" << endl
+      << "    --save-baseline {file}" << endl
+      << "                        save found circles as baseline file" << endl
+      << "                        a snapshot file is accepted as baseline too" << endl
+      << "    --snapshot {file}   save parsed graph as binary snapshot file" << endl
+      << "    --compress          write snapshot with varint encoded include lists" << endl
+      << "    --load {file}       use snapshot file instead of parsing project dirs" << endl
+      << "    --depfiles {path|-} use compiler .d files instead of parsing project dirs," << endl
+      << "                        a dir is searched for *.d, - reads a list from stdin" << endl
+      << "    --ninja-deps {path} use ninja's .ninja_deps log, or the one in build dir path," << endl
+      << "                        instead of parsing project dirs" << endl
+      << "    --time-trace {path|-}" << endl
+      << "                        rank circles & headers by parse time from clang -ftime-trace" << endl
+      << "                        files, a dir is searched for *.json, - reads a list from stdin" << endl
+      << "    --stats[=json]      print time per phase, throughput & peak memory to stderr" << endl
+      << "    --perf-counters     add cycles, instructions, cache & branch misses per phase" << endl
+      << "                        to stats, needs perf_event_open permission" << endl
+      << "    --trace {file}      write phases, dir & slow file scans as Chrome trace JSON" << endl
+      << "    --batch {manifest}  evaluate each [name] section of manifest as a project" << endl
+      << "    --batch-out {dir}   write circles of each batch project to dir/name.txt (default .)" << endl
+      << "    -j {N}              threads for --batch, default one per core" << endl
+      << "    --serve {socket}    keep the solved graph in memory and answer queries on socket" << endl
+      << "    --connect {socket}  ask a --serve server: --closure, --impact, --chain," << endl
+      << "                        --server-stats, circles if none is given" << endl
+      << "    -h                  This message, (version " __DATE__ << " " << __TIME__ << ")" << endl << endl;
 
   exit(1);
 }
 
+/**
+ * Stats for the hot paths, null unless --stats or --trace wants them,
+ * per file phase switches cost syscalls
+ */
+static RunStats* getRunStats()
+{
+  return (STATS_NONE != g_statsFormat || !g_tracePath.empty()) ? &g_runStats : nullptr;
+}
+
+/**
+ * Print stats and write the trace of the run, if asked for
+ */
+static void finishRun()
+{
+  if (!g_tracePath.empty())
+  {
+    g_runStats.stop();
+    Trace::write(g_tracePath);
+  }
+
+  Logger::flush();
+  if (STATS_JSON == g_statsFormat)
+  {
+    g_runStats.printJson(std::cerr);
+  }
+  else if (STATS_TEXT == g_statsFormat)
+  {
+    g_runStats.print(std::cerr);
+  }
+}
+
 static void safeExit(int errCode = 0)
 {
+  finishRun();
   exit(errCode);
 }
 
 static void sigHandler(int signo)
 {
-  cout << " Caught signal " << signo << endl;
-  safeExit(0);
+  // A server stops accepting and cleans up on its own
+  if (g_server)
+  {
+    g_server->stop();
+    return;
+  }
+
+  // Nothing that locks is safe here, queued log lines are dropped
+  Common::printSignal(" Caught signal ", signo);
+  _exit(0);
 }
 
 static void errorHandler(int signo)
 {
-  cout << " Caught error signal " << signo << endl;
+  Common::printSignal(" Caught error signal ", signo);
   void *array[10];
   size_t size = backtrace(array, 10);
 
   // print out all the frames to stderr
   backtrace_symbols_fd(array, size, STDERR_FILENO);
 
-  safeExit(signo);
+  _exit(signo);
+}
+
+/**
+ * Print every file depending on one of changedFiles
+ * @return 0 if all changed files are known
+ */
+static int runImpactQuery(CompactGraph& graph, const vector<string>& changedFiles)
+{
+  int retVal = 0;
+  vector<unsigned> changedIds;
+  for (const string& file : changedFiles)
+  {
+    unsigned id;
+    if (!GraphQuery::findFile(graph, file, id))
+    {
+      // Unknown file has no dependents, may be a new or excluded one
+      LOG_WARN("Unknown file in impact query " << file);
+      retVal = 1;
+      continue;
+    }
+    changedIds.push_back(id);
+  }
+
+  graph.generateParents();
+  vector<unsigned> affectedIds;
+  GraphQuery::getDependents(graph, changedIds, affectedIds);
+
+  vector<const char*> headers, sources;
+  for (const unsigned id : affectedIds)
+  {
+    if (ProjectParser::isSourceFile(graph.name(id)))
+    {
+      sources.push_back(graph.name(id));
+    }
+    else
+    {
+      headers.push_back(graph.name(id));
+    }
+  }
+
+  Logger::flush();
+  cout << "Impact of " << changedIds.size() << " file(s): " << headers.size() << " header(s), "
+       << sources.size() << " source file(s)" << endl;
+  for (const char* name : headers)
+  {
+    cout << "   \"" << name << "\"" << endl;
+  }
+  for (const char* name : sources)
+  {
+    cout << "   \"" << name << "\"" << endl;
+  }
+
+  return retVal;
+}
+
+/**
+ * Answer reachability queries over the parsed header graph
+ * @return 0 if all queried headers are known
+ */
+static int runQueries(CompactGraph& graph, const vector<std::pair<string, string> >& includeQueries,
+                      const vector<string>& closureQueries, const vector<string>& changedFiles,
+                      const vector<std::pair<string, string> >& chainQueries)
+{
+  int retVal = 0;
+  if (!changedFiles.empty())
+  {
+    retVal |= runImpactQuery(graph, changedFiles);
+  }
+
+  for (const auto& query : chainQueries)
+  {
+    unsigned from, to;
+    vector<unsigned> chain;
+    if (!GraphQuery::findFile(graph, query.first, from)
+        || !GraphQuery::findFile(graph, query.second, to))
+    {
+      LOG_ERROR("Unknown header in query " << query.first << "," << query.second);
+      retVal = 1;
+      continue;
+    }
+
+    Logger::flush();
+    cout << "Shortest chain from \"" << query.first << "\" to \"" << query.second << "\":";
+    if (!GraphQuery::getShortestChain(graph, from, to, chain))
+    {
+      cout << " none";
+    }
+    for (const unsigned id : chain)
+    {
+      cout << endl << "   \"" << graph.name(id) << "\"";
+    }
+    cout << endl;
+  }
+
+  if (includeQueries.empty() && closureQueries.empty())
+  {
+    return retVal;
+  }
+
+  Condensation dag(graph);
+  dag.solve();
+  ReachabilityIndex index(dag);
+  index.build();
+
+  for (const auto& query : includeQueries)
+  {
+    unsigned from, to;
+    if (!GraphQuery::findFile(graph, query.first, from) || !GraphQuery::findFile(graph, query.second, to))
+    {
+      LOG_ERROR("Unknown header in query " << query.first << "," << query.second);
+      retVal = 1;
+      continue;
+    }
+
+    Logger::flush();
+    cout << "\"" << query.first << "\" includes \"" << query.second << "\": "
+         << (index.reaches(from, to) ? "yes" : "no") << endl;
+  }
+
+  for (const string& header : closureQueries)
+  {
+    unsigned id;
+    if (!GraphQuery::findFile(graph, header, id))
+    {
+      LOG_ERROR("Unknown header in query " << header);
+      retVal = 1;
+      continue;
+    }
+
+    vector<unsigned> closure;
+    index.getClosure(id, closure);
+    Logger::flush();
+    cout << "Include closure of \"" << header << "\": " << closure.size() << " header(s)" << endl;
+    for (const unsigned child : closure)
+    {
+      cout << "   \"" << graph.name(child) << "\"" << endl;
+    }
+  }
+
+  return retVal;
+}
+
+/**
+ * Print the top headers by rebuild fan-out
+ */
+static void runFanoutReport(const CompactGraph& graph, const ProjectParser::HeaderLocationMap& headerPathMap,
+                            size_t topCount)
+{
+  Condensation dag(graph);
+  dag.solve();
+
+  // Duplicate basenames are merged in the graph, so are their sizes
+  vector<bool> isSource(graph.size(), false);
+  vector<uint64_t> nodeBytes(graph.size(), 0);
+  for (unsigned id = 0; id < graph.size(); ++id)
+  {
+    const auto pathSetIt = headerPathMap.find(graph.name(id));
+    isSource[id] = ProjectParser::isSourceFile(graph.name(id));
+    if (isSource[id])
+    {
+      nodeBytes[id] = Common::getFileSize(graph.name(id));
+    }
+    else if (pathSetIt != headerPathMap.end())
+    {
+      for (const string& path : pathSetIt->second)
+      {
+        nodeBytes[id] += Common::getFileSize(path);
+      }
+    }
+  }
+
+  FanoutReport report(dag, isSource, nodeBytes);
+  if (!report.solve())
+  {
+    LOG_ERROR("Cannot compute rebuild fan-out");
+    safeExit(3);
+  }
+
+  const auto& scores = report.getScores();
+  topCount = std::min(topCount, scores.size());
+  g_runStats.enter(RunStats::PHASE_REPORT);
+  Common::printSeparator(2);
+  cout << "Rebuild fan-out, top " << topCount << " of " << scores.size() << " headers:" << endl << endl;
+  fprintf(stdout, "%10s %16s  %s\n", "TUs", "Rebuild bytes", "Header");
+  for (size_t i = 0; i < topCount; ++i)
+  {
+    fprintf(stdout, "%10zu %16llu  \"%s\"\n", scores[i].tuCount,
+            (unsigned long long) scores[i].rebuildBytes, graph.name(scores[i].node));
+  }
+  Common::printSeparator(2);
+}
+
+/**
+ * Add input files named by arg: a list on stdin for -, files ending in
+ * suffix under a dir, or arg itself
+ * @return false if a dir can't be read
+ */
+static bool addInputPaths(const char* arg, const char* suffix, vector<string>& paths)
+{
+  if (string("-") == arg)
+  {
+    string line;
+    while (std::getline(std::cin, line))
+    {
+      if (!line.empty())
+      {
+        paths.push_back(line);
+      }
+    }
+    return true;
+  }
+  else if (Common::isDirExist(arg))
+  {
+    return Common::findFiles(arg, suffix, paths);
+  }
+
+  paths.push_back(arg);
+  return true;
+}
+
+/**
+ * Rank circles by the parse time spent in their headers, then the
+ * costliest headers
+ */
+static void runCostReport(const CompactGraph& graph, const set<set<string> >& solution,
+                          const vector<ParseCost::Cost>& nodeCosts)
+{
+  static const size_t TOP_HEADER_COUNT = 20;
+  auto toMs = [](uint64_t us) { return us / 1000.0; };
+  auto averageMs = [&](const ParseCost::Cost& cost)
+  {
+    return cost.parseCount ? toMs(cost.inclusiveUs) / cost.parseCount : 0.0;
+  };
+
+  // Circles by total exclusive time, the slowest single parse in a circle
+  // tells how much one TU pays for it
+  struct CycleCost
+  {
+    const set<string>* cycle;
+    uint64_t exclusiveUs;
+    double maxAverageMs;
+  };
+  vector<CycleCost> cycleCosts;
+  for (const auto& cycle : solution)
+  {
+    CycleCost cycleCost = {&cycle, 0, 0.0};
+    for (const string& header : cycle)
+    {
+      unsigned id;
+      if (graph.findId(header, id))
+      {
+        cycleCost.exclusiveUs += nodeCosts[id].exclusiveUs;
+        cycleCost.maxAverageMs = std::max(cycleCost.maxAverageMs, averageMs(nodeCosts[id]));
+      }
+    }
+    cycleCosts.push_back(cycleCost);
+  }
+  std::stable_sort(cycleCosts.begin(), cycleCosts.end(), [](const CycleCost& a, const CycleCost& b)
+  {
+    return a.exclusiveUs > b.exclusiveUs;
+  });
+
+  if (!cycleCosts.empty())
+  {
+    cout << "Circles by parse time:" << endl << endl;
+    fprintf(stdout, "%12s %12s  %s\n", "Total ms", "Max avg ms", "Headers");
+    for (const auto& cycleCost : cycleCosts)
+    {
+      fprintf(stdout, "%12.1f %12.1f ", toMs(cycleCost.exclusiveUs), cycleCost.maxAverageMs);
+      for (const string& header : *cycleCost.cycle)
+      {
+        fprintf(stdout, " \"%s\"", header.c_str());
+      }
+      fprintf(stdout, "\n");
+    }
+    cout << endl;
+  }
+
+  vector<unsigned> ids;
+  for (unsigned id = 0; id < graph.size(); ++id)
+  {
+    if (nodeCosts[id].parseCount > 0)
+    {
+      ids.push_back(id);
+    }
+  }
+  const size_t topCount = std::min(TOP_HEADER_COUNT, ids.size());
+  std::partial_sort(ids.begin(), ids.begin() + topCount, ids.end(), [&](unsigned a, unsigned b)
+  {
+    return nodeCosts[a].inclusiveUs > nodeCosts[b].inclusiveUs
+        || (nodeCosts[a].inclusiveUs == nodeCosts[b].inclusiveUs && a < b);
+  });
+
+  cout << "Parse time, top " << topCount << " of " << ids.size() << " headers:" << endl << endl;
+  fprintf(stdout, "%12s %12s %8s %10s  %s\n", "Incl ms", "Excl ms", "Parses", "Avg ms", "Header");
+  for (size_t i = 0; i < topCount; ++i)
+  {
+    const ParseCost::Cost& cost = nodeCosts[ids[i]];
+    fprintf(stdout, "%12.1f %12.1f %8u %10.1f  \"%s\"\n", toMs(cost.inclusiveUs),
+            toMs(cost.exclusiveUs), cost.parseCount, averageMs(cost), graph.name(ids[i]));
+  }
+  Common::printSeparator(2);
+}
+
+static void printCycle(const vector<string>& cycle)
+{
+  cout << "   ";
+  for (const string& header : cycle)
+  {
+    cout << "\"" << header << "\" ";
+  }
+  cout << endl;
+}
+
+/**
+ * Load baseline circles, from a baseline file or by solving a snapshot
+ * @return true on success
+ */
+static bool loadBaseline(const string& baselinePath, CycleBaseline::CycleList& baseline)
+{
+  if (!GraphSnapshot::isSnapshot(baselinePath))
+  {
+    return CycleBaseline::load(baselinePath, baseline);
+  }
+
+  GraphSnapshot snapshot;
+  if (!snapshot.open(baselinePath))
+  {
+    return false;
+  }
+
+  TarjanSolver solver(snapshot.graph());
+  set<set<string> > solution;
+  SccNameCollector collector(solver, solution);
+  if (!solver.solve(collector))
+  {
+    return false;
+  }
+  CycleBaseline::fromSolution(solution, baseline);
+  return true;
+}
+
+/**
+ * Report circles regressed since baseline
+ * @return exit code, 4 on regression
+ */
+static int runBaselineReport(const string& baselinePath, const CycleBaseline::CycleList& current)
+{
+  CycleBaseline::CycleList baseline;
+  if (!loadBaseline(baselinePath, baseline))
+  {
+    LOG_ERROR("Error loading baseline " << baselinePath);
+    return 1;
+  }
+
+  CycleBaseline::Diff diff;
+  CycleBaseline::diff(baseline, current, diff);
+
+  Common::printSeparator(2);
+  cout << "Compared to " << baselinePath << ": " << diff.knownCount << " known, "
+       << diff.newCycles.size() << " new, " << diff.grownCycles.size() << " grown, "
+       << diff.fixedCount << " fixed circle(s)" << endl;
+  if (!diff.newCycles.empty())
+  {
+    cout << endl << "++ New circle(s):" << endl;
+    for (const size_t i : diff.newCycles)
+    {
+      printCycle(current[i]);
+    }
+  }
+  if (!diff.grownCycles.empty())
+  {
+    cout << endl << "++ Grown circle(s):" << endl;
+    for (size_t i = 0; i < diff.grownCycles.size(); ++i)
+    {
+      printCycle(current[diff.grownCycles[i]]);
+      cout << "     was";
+      printCycle(baseline[diff.grownFrom[i]]);
+    }
+  }
+  if (!diff.hasRegression())
+  {
+    cout << "-- No new circle found" << endl;
+  }
+  Common::printSeparator(2);
+
+  return diff.hasRegression() ? 4 : 0;
+}
+
+/**
+ * Evaluate every project of a manifest, 1 circle list file each
+ * @return exit code, 1 if any project failed
+ */
+static int runBatch(const string& manifestPath, const string& outDir, unsigned jobCount,
+                    bool scanSources)
+{
+  ConfigFile manifest(manifestPath);
+  if (!manifest.parse())
+  {
+    LOG_ERROR("Error parsing " << manifestPath);
+    return 1;
+  }
+  if (manifest.sections().empty())
+  {
+    LOG_ERROR(manifestPath << " has no [name] section");
+    return 1;
+  }
+
+  g_runStats.enter(RunStats::PHASE_SCAN);
+  vector<BatchRunner::Result> results;
+  size_t failCount = BatchRunner::run(manifest.sections(), jobCount, scanSources, results);
+  g_runStats.enter(RunStats::PHASE_REPORT);
+  Logger::flush();
+
+  Common::printSeparator(2);
+  for (const auto& result : results)
+  {
+    const string resultPath = outDir + "/" + result.name + ".txt";
+    if (result.isOk() && !CycleBaseline::save(resultPath, result.cycles))
+    {
+      LOG_ERROR("Error saving " << resultPath);
+      ++failCount;
+    }
+
+    Logger::flush();
+    cout << result.name << ": ";
+    if (result.isOk())
+    {
+      cout << result.headerCount << " headers, " << result.sourceCount << " sources, "
+           << result.cycles.size() << " circle(s)";
+    }
+    else
+    {
+      cout << "FAILED";
+    }
+    cout << ", " << result.seconds << "s" << endl;
+  }
+  Common::printSeparator(2);
+  cout << results.size() - failCount << "/" << results.size() << " projects done" << endl;
+
+  return (failCount > 0) ? 1 : 0;
+}
+
+/**
+ * Keep graph resident and answer queries on socketPath until a signal
+ * @return exit code
+ */
+static int runServer(CompactGraph& graph, const string& socketPath)
+{
+  QueryServer server(graph);
+  if (!server.prepare() || !server.listen(socketPath))
+  {
+    return 1;
+  }
+
+  cout << "Serving " << graph.size() << " files on " << socketPath << endl;
+  Logger::flush();
+  g_server = &server;
+  signal(SIGTERM, sigHandler);
+  server.serve();
+  g_server = nullptr;
+  return 0;
+}
+
+/**
+ * Print one response of a --serve server
+ * @return 0 on success
+ */
+static int printResponse(const string& title, const QueryServer::Response& response)
+{
+  if (QueryServer::STATUS_OK != response.status)
+  {
+    LOG_ERROR(title << ": " << ((QueryServer::STATUS_NOT_FOUND == response.status)
+                                ? "not found" : "bad request"));
+    return 1;
+  }
+
+  Logger::flush();
+  cout << title << ":" << endl;
+  for (const auto& record : response.records)
+  {
+    cout << "  ";
+    for (const string& item : record)
+    {
+      cout << " \"" << item << "\"";
+    }
+    cout << endl;
+  }
+  return 0;
+}
+
+/**
+ * Ask a --serve server instead of parsing
+ * @return exit code, 1 if a query failed
+ */
+static int runClient(const string& socketPath, const vector<string>& closureQueries,
+                     const vector<string>& changedFiles,
+                     const vector<std::pair<string, string> >& chainQueries, bool isStatsQuery)
+{
+  vector<std::pair<QueryServer::Op, vector<string> > > requests;
+  for (const string& header : closureQueries)
+  {
+    requests.push_back(std::make_pair(QueryServer::OP_CLOSURE, vector<string>(1, header)));
+  }
+  if (!changedFiles.empty())
+  {
+    requests.push_back(std::make_pair(QueryServer::OP_IMPACT, changedFiles));
+  }
+  for (const auto& query : chainQueries)
+  {
+    requests.push_back(std::make_pair(QueryServer::OP_CHAIN,
+                                      vector<string>({query.first, query.second})));
+  }
+  if (isStatsQuery)
+  {
+    requests.push_back(std::make_pair(QueryServer::OP_STATS, vector<string>()));
+  }
+  if (requests.empty())
+  {
+    requests.push_back(std::make_pair(QueryServer::OP_CYCLES, vector<string>()));
+  }
+
+  static const char* titles[] = {"", "Circles", "Impact", "Include closure", "Shortest chain",
+                                 "Server stats"};
+  int retVal = 0;
+  for (const auto& request : requests)
+  {
+    QueryServer::Response response;
+    if (!QueryServer::ask(socketPath, request.first, request.second, response))
+    {
+      return 2;
+    }
+
+    string title = titles[request.first];
+    for (const string& arg : request.second)
+    {
+      title += " \"" + arg + "\"";
+    }
+    retVal |= printResponse(title, response);
+  }
+  return retVal;
 }
 
 static void exportDefaultCfgFile()
@@ -94,15 +731,207 @@ int main(int argc, char** argv)
   string cfgFilePath;
   ConfigData cfgData;
   cfgData.projDirs.clear();
+  vector<std::pair<string, string> > includeQueries;
+  vector<string> closureQueries;
+  vector<string> changedFiles;
+  vector<std::pair<string, string> > chainQueries;
+  string servePath, connectPath;
+  bool isStatsQuery = false;
+  vector<string> depfilePaths;
+  string ninjaDepsPath;
+  vector<string> traceFilePaths;
+  bool scanSources = false;
+  size_t fanoutCount = 0;
+  string baselinePath, saveBaselinePath;
+  string snapshotPath, loadPath;
+  bool compressSnapshot = false;
+  string batchPath, batchOutDir = ".";
+  unsigned jobCount = 0;
 
   /**
-   * Getopt parser
+   * Getopt parser, long options don't have a short form
    */
+  enum
+  {
+    OPT_INCLUDES = 256,
+    OPT_CLOSURE,
+    OPT_IMPACT,
+    OPT_FANOUT,
+    OPT_BASELINE,
+    OPT_SAVE_BASELINE,
+    OPT_SNAPSHOT,
+    OPT_LOAD,
+    OPT_COMPRESS,
+    OPT_STATS,
+    OPT_PERF_COUNTERS,
+    OPT_TRACE,
+    OPT_BATCH,
+    OPT_BATCH_OUT,
+    OPT_CHAIN,
+    OPT_SERVE,
+    OPT_CONNECT,
+    OPT_SERVER_STATS,
+    OPT_DEPFILES,
+    OPT_NINJA_DEPS,
+    OPT_TIME_TRACE
+  };
+  static const struct option longOptions[] =
+  {
+    {"includes", required_argument, nullptr, OPT_INCLUDES},
+    {"closure",  required_argument, nullptr, OPT_CLOSURE},
+    {"impact",   required_argument, nullptr, OPT_IMPACT},
+    {"fanout",   required_argument, nullptr, OPT_FANOUT},
+    {"baseline", required_argument, nullptr, OPT_BASELINE},
+    {"save-baseline", required_argument, nullptr, OPT_SAVE_BASELINE},
+    {"snapshot", required_argument, nullptr, OPT_SNAPSHOT},
+    {"load",     required_argument, nullptr, OPT_LOAD},
+    {"compress", no_argument,       nullptr, OPT_COMPRESS},
+    {"stats",    optional_argument, nullptr, OPT_STATS},
+    {"perf-counters", no_argument,  nullptr, OPT_PERF_COUNTERS},
+    {"trace",    required_argument, nullptr, OPT_TRACE},
+    {"batch",    required_argument, nullptr, OPT_BATCH},
+    {"batch-out", required_argument, nullptr, OPT_BATCH_OUT},
+    {"chain",    required_argument, nullptr, OPT_CHAIN},
+    {"serve",    required_argument, nullptr, OPT_SERVE},
+    {"connect",  required_argument, nullptr, OPT_CONNECT},
+    {"server-stats", no_argument,   nullptr, OPT_SERVER_STATS},
+    {"depfiles", required_argument, nullptr, OPT_DEPFILES},
+    {"ninja-deps", required_argument, nullptr, OPT_NINJA_DEPS},
+    {"time-trace", required_argument, nullptr, OPT_TIME_TRACE},
+    {nullptr, 0, nullptr, 0}
+  };
+
   int command = -1;
-  while ((command = getopt(argc, argv, "c:gDvh")) != -1)
+  while ((command = getopt_long(argc, argv, "c:gDvtj:h", longOptions, nullptr)) != -1)
   {
     switch (command)
     {
+    case OPT_INCLUDES:
+    {
+      const string query = optarg;
+      const size_t comma = query.find(',');
+      if (comma == string::npos)
+      {
+        LOG_ERROR("--includes expects a,b");
+        usage(argc, argv);
+      }
+      includeQueries.push_back(std::make_pair(query.substr(0, comma), query.substr(comma + 1)));
+      break;
+    }
+    case OPT_CLOSURE:
+      closureQueries.push_back(optarg);
+      break;
+    case OPT_CHAIN:
+    {
+      const string query = optarg;
+      const size_t comma = query.find(',');
+      if (comma == string::npos)
+      {
+        LOG_ERROR("--chain expects a,b");
+        usage(argc, argv);
+      }
+      chainQueries.push_back(std::make_pair(query.substr(0, comma), query.substr(comma + 1)));
+      break;
+    }
+    case OPT_SERVE:
+      servePath = optarg;
+      break;
+    case OPT_CONNECT:
+      connectPath = optarg;
+      break;
+    case OPT_SERVER_STATS:
+      isStatsQuery = true;
+      break;
+    case OPT_DEPFILES:
+      if (!addInputPaths(optarg, ".d", depfilePaths))
+      {
+        safeExit(1);
+      }
+      break;
+    case OPT_NINJA_DEPS:
+      ninjaDepsPath = optarg;
+      break;
+    case OPT_TIME_TRACE:
+      if (!addInputPaths(optarg, ".json", traceFilePaths))
+      {
+        safeExit(1);
+      }
+      break;
+    case OPT_IMPACT:
+      if (string("-") == optarg)
+      {
+        string line;
+        while (std::getline(std::cin, line))
+        {
+          line.erase(remove_if(line.begin(), line.end(), isspace), line.end());
+          if (!line.empty())
+          {
+            changedFiles.push_back(line);
+          }
+        }
+      }
+      else
+      {
+        changedFiles.push_back(optarg);
+      }
+      break;
+    case OPT_FANOUT:
+      fanoutCount = strtoul(optarg, nullptr, 10);
+      scanSources = true;
+      break;
+    case OPT_BASELINE:
+      baselinePath = optarg;
+      break;
+    case OPT_SAVE_BASELINE:
+      saveBaselinePath = optarg;
+      break;
+    case OPT_SNAPSHOT:
+      snapshotPath = optarg;
+      break;
+    case OPT_LOAD:
+      loadPath = optarg;
+      break;
+    case OPT_COMPRESS:
+      compressSnapshot = true;
+      break;
+    case OPT_STATS:
+      if (!optarg)
+      {
+        g_statsFormat = STATS_TEXT;
+      }
+      else if (string("json") == optarg)
+      {
+        g_statsFormat = STATS_JSON;
+      }
+      else
+      {
+        LOG_ERROR("--stats only knows json format");
+        usage(argc, argv);
+      }
+      break;
+    case OPT_TRACE:
+      g_tracePath = optarg;
+      Trace::start();
+      break;
+    case OPT_PERF_COUNTERS:
+      g_runStats.openCounters();
+      if (STATS_NONE == g_statsFormat)
+      {
+        g_statsFormat = STATS_TEXT;
+      }
+      break;
+    case OPT_BATCH:
+      batchPath = optarg;
+      break;
+    case OPT_BATCH_OUT:
+      batchOutDir = optarg;
+      break;
+    case 'j':
+      jobCount = strtoul(optarg, nullptr, 10);
+      break;
+    case 't':
+      scanSources = true;
+      break;
     case 'c':
       cfgFilePath = optarg;
       break;
@@ -146,69 +975,218 @@ int main(int argc, char** argv)
   signal(SIGFPE, errorHandler);
   signal(SIGPIPE, errorHandler);
 
-  // Now see if cfgFile is specified, if so use it instead of inputs
-  if (!cfgFilePath.empty())
+  // A running server answers instead
+  if (!connectPath.empty())
+  {
+    safeExit(runClient(connectPath, closureQueries, changedFiles, chainQueries, isStatsQuery));
+  }
+
+  // A manifest replaces the single project
+  if (!batchPath.empty())
   {
-    ConfigFile cfgFile(cfgFilePath);
-    if (!cfgFile.parse())
+    safeExit(runBatch(batchPath, batchOutDir, jobCount, scanSources));
+  }
+
+  // A snapshot replaces parsing the project
+  Graph headerFileGraph, detailHeaderFileGraph;
+  ProjectParser::HeaderLocationMap headerPathMap;
+  CompactGraph parsedGraph;
+  GraphSnapshot snapshot;
+  CompactGraph* graph = &parsedGraph;
+  if (!loadPath.empty())
+  {
+    g_runStats.enter(RunStats::PHASE_LOAD);
+    if (!snapshot.open(loadPath))
+    {
+      LOG_ERROR("Error loading snapshot " << loadPath << ", exiting...");
+      safeExit(1);
+    }
+    graph = &snapshot.graph();
+    snapshot.getLocationMap(headerPathMap);
+    Logger::flush();
+    cout << "Loaded " << loadPath << ": " << graph->size() << " files, "
+         << graph->edgeCount() << " includes" << endl;
+  }
+  else if (!depfilePaths.empty())
+  {
+    g_runStats.enter(RunStats::PHASE_SCAN);
+    const int badFileCount = DepfileLoader::load(depfilePaths, parsedGraph);
+    if (badFileCount < 0 || (size_t) badFileCount == depfilePaths.size())
     {
-      LOG_ERROR("Error parsing " << cfgFilePath << ", exiting...");
+      LOG_ERROR("Error loading depfiles, exiting...");
       safeExit(1);
     }
+    Logger::flush();
+    cout << "Loaded " << depfilePaths.size() - badFileCount << " depfiles: " << graph->size()
+         << " files, " << graph->edgeCount() << " includes" << endl;
+    LOG_WARN("Depfiles only list the headers of each translation unit, circles between"
+             " headers can't be found from them");
+  }
+  else if (!ninjaDepsPath.empty())
+  {
+    g_runStats.enter(RunStats::PHASE_SCAN);
+    if (!NinjaDepsLoader::load(ninjaDepsPath, parsedGraph))
+    {
+      LOG_ERROR("Error loading ninja deps log, exiting...");
+      safeExit(1);
+    }
+    Logger::flush();
+    cout << "Loaded ninja deps log " << ninjaDepsPath << ": " << graph->size()
+         << " files, " << graph->edgeCount() << " includes" << endl;
+    LOG_WARN("The ninja deps log only lists the headers of each translation unit, circles"
+             " between headers can't be found from it");
+  }
+  else
+  {
+    // Now see if cfgFile is specified, if so use it instead of inputs
+    if (!cfgFilePath.empty())
+    {
+      ConfigFile cfgFile(cfgFilePath);
+      if (!cfgFile.parse())
+      {
+        LOG_ERROR("Error parsing " << cfgFilePath << ", exiting...");
+        safeExit(1);
+      }
+
+      cfgData = cfgFile.data();
+    }
 
-    cfgData = cfgFile.data();
+    // Report cfg data
+    Logger::flush();
+    cout << "Config data:\n";
+    Common::printSeparator();
+    cfgData.dump(stdout);
+    Common::printSeparator();
+
+    // Get all excluded header files
+    g_runStats.enter(RunStats::PHASE_EXCLUDE_INDEX);
+    // Glob entries are compiled into one matcher instead
+    set<string> allExcludedFiles, excludedDirs, excludedFiles;
+    PathMatcher excludedPaths;
+    ProjectParser::splitExcludes(cfgData.excludedDirs, excludedDirs, excludedPaths);
+    ProjectParser::splitExcludes(cfgData.excludedFiles, excludedFiles, excludedPaths);
+    if (0 != ProjectParser::generateHeaderList(excludedDirs, allExcludedFiles))
+    {
+      LOG_ERROR("Error generating excluded files from excluded dirs, ignoring these dirs");
+      allExcludedFiles.clear();
+    }
+    allExcludedFiles.insert(excludedFiles.begin(), excludedFiles.end());
+    LOG_DEBUG("Excluding " << allExcludedFiles.size() << " headers");
+
+    // Get all target header files
+    int parseCode = ProjectParser::parse(cfgData.projDirs, allExcludedFiles,
+                                         headerFileGraph, detailHeaderFileGraph, headerPathMap,
+                                         scanSources, getRunStats(),
+                                         excludedPaths.empty() ? nullptr : &excludedPaths);
+    if (0 > parseCode)
+    {
+      LOG_ERROR("Critical error code " << parseCode << " while getting input headers");
+      safeExit(2);
+    }
+    else if (parseCode > 0)
+    {
+      LOG_DEBUG("Warning code " << parseCode << " while getting input headers");
+    }
+
+    g_runStats.enter(RunStats::PHASE_CONVERT);
+    parsedGraph.assign(headerFileGraph);
   }
 
-  // Report cfg data
-  cout << "Config data:\n";
-  Common::printSeparator();
-  cfgData.dump(stdout);
-  Common::printSeparator();
+  if (loadPath.empty() && !snapshotPath.empty())
+  {
+    if (!GraphSnapshot::write(snapshotPath, parsedGraph, headerPathMap, compressSnapshot))
+    {
+      safeExit(1);
+    }
+    Logger::flush();
+    cout << "Saved snapshot " << snapshotPath << endl;
+  }
 
-  // Get all excluded header files
-  set<string> allExcludedFiles;
-  if (0 != ProjectParser::generateHeaderList(cfgData.excludedDirs, allExcludedFiles))
+  // Parse times become node weights for the circle report
+  vector<ParseCost::Cost> nodeCosts;
+  if (!traceFilePaths.empty())
   {
-    LOG_ERROR("Error generating excluded files from excluded dirs, ignoring these dirs");
-    allExcludedFiles.clear();
+    g_runStats.enter(RunStats::PHASE_LOAD);
+    ParseCost::CostMap costs;
+    const size_t badFileCount = ParseCost::load(traceFilePaths, costs);
+    if (badFileCount == traceFilePaths.size())
+    {
+      LOG_ERROR("No time trace could be read, exiting...");
+      safeExit(1);
+    }
+    if (badFileCount > 0)
+    {
+      LOG_WARN("Skipped " << badFileCount << " file(s) that aren't time traces");
+    }
+    const size_t unknownCount = ParseCost::getNodeCosts(*graph, costs, nodeCosts);
+    Logger::flush();
+    cout << "Loaded " << traceFilePaths.size() - badFileCount << " time traces: "
+         << costs.size() << " headers, " << unknownCount << " not in the include graph" << endl;
   }
-  allExcludedFiles.insert(cfgData.excludedFiles.begin(), cfgData.excludedFiles.end());
-  LOG_DEBUG("Excluding " << allExcludedFiles.size() << " headers");
 
-  // Get all target header files
-  Graph headerFileGraph, detailHeaderFileGraph;
-  ProjectParser::HeaderLocationMap headerPathMap;
-  int parseCode = ProjectParser::parse(cfgData.projDirs, allExcludedFiles,
-                                       headerFileGraph, detailHeaderFileGraph, headerPathMap);
-  if (0 > parseCode)
+  // Logs are written asynchronously, drain them before the report
+  Logger::flush();
+  g_runStats.nodeCount = graph->size();
+  g_runStats.edgeCount = graph->edgeCount();
+  g_runStats.enter(RunStats::PHASE_SCC);
+
+  // Serving or queries replace the circle report
+  if (!servePath.empty())
+  {
+    safeExit(runServer(*graph, servePath));
+  }
+  else if (!includeQueries.empty() || !closureQueries.empty() || !changedFiles.empty()
+           || !chainQueries.empty())
   {
-    LOG_ERROR("Critical error code " << parseCode << " while getting input headers");
-    safeExit(2);
+    safeExit(runQueries(*graph, includeQueries, closureQueries, changedFiles, chainQueries));
   }
-  else if (parseCode > 0)
+  else if (fanoutCount > 0)
   {
-    LOG_DEBUG("Warning code " << parseCode << " while getting input headers");
+    runFanoutReport(*graph, headerPathMap, fanoutCount);
+    safeExit(0);
   }
 
   // Now spawn the mighty solver ----------------------------------------
-  TarjanSolver solver(headerFileGraph);
-  if (!solver.solve())
+  // Circles are streamed out of the solver, 1 node sets never leave it
+  TarjanSolver solver(*graph);
+  solver.setStats(getRunStats());
+  set<set<string> > solution;
+  SccNameCollector collector(solver, solution);
+  if (!solver.solve(collector))
   {
     LOG_ERROR("Cannot solve!");
     safeExit(3);
   }
   else
   {
-    cout << "Processed " << headerFileGraph.size() << " header files" << endl;
+    g_runStats.enter(RunStats::PHASE_REPORT);
+    Logger::flush();
+    size_t sourceCount = 0;
+    for (unsigned id = 0; id < graph->size(); ++id)
+    {
+      sourceCount += ProjectParser::isSourceFile(graph->name(id));
+    }
+    cout << "Processed " << graph->size() - sourceCount << " header files";
+    if (scanSources || sourceCount > 0)
+    {
+      cout << ", " << sourceCount << " source files";
+    }
+    cout << endl;
   }
 
-  // Don't use 1 element solution set
-  auto solution = solver.getSolution();
-  for (const auto& oneSet : solution)
+  if (!saveBaselinePath.empty() || !baselinePath.empty())
   {
-    if (oneSet.size() <=1)
+    CycleBaseline::CycleList cycles;
+    CycleBaseline::fromSolution(solution, cycles);
+    if (!saveBaselinePath.empty() && !CycleBaseline::save(saveBaselinePath, cycles))
+    {
+      LOG_ERROR("Error saving baseline " << saveBaselinePath);
+      safeExit(1);
+    }
+
+    if (!baselinePath.empty())
     {
-      solution.erase(oneSet);
+      safeExit(runBaselineReport(baselinePath, cycles));
     }
   }
   // --------------------------------------------------------------------
@@ -233,14 +1211,14 @@ int main(int argc, char** argv)
       cout << endl;
 
       // Report detailed path
-      for (const auto header : oneSet)
+      for (const auto& header : oneSet)
       {
         const auto headerPathSetIt = headerPathMap.find(header);
         if (Common::isVerboseMode()
             && headerPathMap.end() != headerPathSetIt
             && !headerPathSetIt->second.empty())
         {
-          for (const auto path: headerPathSetIt->second)
+          for (const auto& path: headerPathSetIt->second)
           {
             if (path == *(headerPathSetIt->second.begin()))
             {
@@ -252,31 +1230,61 @@ int main(int argc, char** argv)
             }
             std::cerr << path << endl;
 
-            // print relevant included headers from path
-            const auto pathRealNodeIt = detailHeaderFileGraph.find(Node(path));
-            if (pathRealNodeIt == detailHeaderFileGraph.end())
-            {
-              LOG_ERROR("Can't find included headers for "<< path);
-            }
-            else
+            // print relevant included headers from path,
+            // a snapshot only keeps them merged per header
+            if (loadPath.empty())
             {
-              for (const string& childHeader : pathRealNodeIt->childNodes)
+              const auto pathRealNodeIt = detailHeaderFileGraph.find(Node(path));
+              if (pathRealNodeIt == detailHeaderFileGraph.end())
               {
-                if (oneSet.end() != oneSet.find(childHeader))
+                LOG_ERROR("Can't find included headers for "<< path);
+                Logger::flush();
+              }
+              else
+              {
+                for (const string& childHeader : pathRealNodeIt->childNodes)
                 {
-                  cout << "          |_ " << childHeader << endl;
+                  if (oneSet.end() != oneSet.find(childHeader))
+                  {
+                    const auto lineIt = pathRealNodeIt->childLines.find(childHeader);
+                    cout << "          |_ " << childHeader;
+                    if (lineIt != pathRealNodeIt->childLines.end())
+                    {
+                      cout << " (line " << lineIt->second << ")";
+                    }
+                    cout << endl;
+                  }
                 }
               }
             }
           }
+
+          unsigned id;
+          if (!loadPath.empty() && graph->findId(header, id))
+          {
+            EdgeCursor children = graph->children(id), lines = graph->childLines(id);
+            unsigned child, line;
+            while (children.next(child) && lines.next(line))
+            {
+              if (oneSet.end() != oneSet.find(graph->name(child)))
+              {
+                cout << "          |_ " << graph->name(child) << " (line " << line << ")" << endl;
+              }
+            }
+          }
           std::cerr << endl;
         }
       }
     }
   }
   Common::printSeparator(2);
+  if (!nodeCosts.empty())
+  {
+    runCostReport(*graph, solution, nodeCosts);
+  }
   // --------------------------------------------------------------------
 
+  finishRun();
   return 0;
 }
 
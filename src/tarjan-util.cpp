@@ -28,6 +28,8 @@
 #include <fstream>
 
 #include "TarjanSolver.h"
+#include "GraphSnapshot.h"
+#include "EdgeListLoader.h"
 
 static void usage(int /*argc*/, char * argv[])
 {
@@ -48,48 +50,62 @@ static void usage(int /*argc*/, char * argv[])
       << "  b can go to d" << endl
       << "  and so on" << endl << endl
 
+      << " SNAP edge lists (from to, # comments) and DIMACS files (p, a, e lines)" << endl
+      << " are accepted too, as well as snapshots written by spinclude --snapshot" << endl << endl
+
       << "  Option:" << endl
-      << "    -v  verbose mode" << endl
-      << "    -h  This message, (version " __DATE__ << " " << __TIME__ << ")" << endl << endl;
+      << "    -f {format}  input format: auto (default), adj, snap or dimacs" << endl
+      << "    -v           verbose mode" << endl
+      << "    -h           This message, (version " __DATE__ << " " << __TIME__ << ")" << endl << endl;
 
   exit(1);
 }
 
 static void safeExit(int errCode = 0)
 {
+  Logger::flush();
   exit(errCode);
 }
 
 static void sigHandler(int signo)
 {
-  cout << " Caught signal " << signo << endl;
-  safeExit(0);
+  // Nothing that locks is safe here, queued log lines are dropped
+  Common::printSignal(" Caught signal ", signo);
+  _exit(0);
 }
 
 static void errorHandler(int signo)
 {
-  cout << " Caught error signal " << signo << endl;
+  Common::printSignal(" Caught error signal ", signo);
   void *array[10];
   size_t size = backtrace(array, 10);
 
   // print out all the frames to stderr
   backtrace_symbols_fd(array, size, STDERR_FILENO);
 
-  safeExit(signo);
+  _exit(signo);
 }
 
 int main(int argc, char** argv)
 {
   set<string> inputFiles;
+  EdgeListLoader::Format format = EdgeListLoader::FORMAT_AUTO;
 
   /**
    * Getopt parser
    */
   int command = -1;
-  while ((command = getopt(argc, argv, "Dvh")) != -1)
+  while ((command = getopt(argc, argv, "f:Dvh")) != -1)
   {
     switch (command)
     {
+    case 'f':
+      if (!EdgeListLoader::parseFormat(optarg, format))
+      {
+        LOG_ERROR("Unknown format " << optarg);
+        usage(argc, argv);
+      }
+      break;
     case 'v':
       Common::setVerboseMode(true);
       break;
@@ -137,60 +153,40 @@ int main(int argc, char** argv)
       continue;
     }
 
-    // Parse each line of file to graph
-    Graph graph;
+    // Map a snapshot as is, or load an edge list straight to compact form
+    GraphSnapshot snapshot;
+    CompactGraph loadedGraph;
+    const CompactGraph* compactGraph = &loadedGraph;
+    if (GraphSnapshot::isSnapshot(filePath))
     {
-      std::ifstream file(filePath);
-      string line;
-      while (std::getline(file, line))
+      if (!snapshot.open(filePath))
       {
-        // Get node id
-        std::istringstream ss(line);
-        string id;
-        if (!(ss >> id))
-        {
-          // empty line
-          continue;
-        }
-        else
-        {
-          Node node(id);
-
-          // now get child ids
-          while(ss>>id)
-          {
-            node.childNodes.insert(id);
-          }
-
-          graph.insert(node);
-        }
+        continue;
       }
-
-      file.close();
+      compactGraph = &snapshot.graph();
+    }
+    else if (!EdgeListLoader::load(filePath, loadedGraph, format))
+    {
+      LOG_ERROR("Cannot load " << filePath);
+      continue;
     }
-
 
     // Now spawn the mighty solver ----------------------------------------
-    TarjanSolver solver(graph);
-    if (!solver.solve())
+    // Circles are streamed out of the solver, 1 node sets never leave it
+    TarjanSolver solver(*compactGraph);
+    set<set<string> > solution;
+    SccNameCollector collector(solver, solution);
+    if (!solver.solve(collector))
     {
       LOG_ERROR("Cannot solve!");
       safeExit(3);
     }
     else
     {
-      cout << "Found " << graph.size() << " nodes" << endl;
+      Logger::flush();
+      cout << "Found " << compactGraph->size() << " nodes" << endl;
     }
 
-    // Don't use 1 element solution set
-    auto solution = solver.getSolution();
-    for (const auto& oneSet : solution)
-    {
-      if (oneSet.size() <=1)
-      {
-        solution.erase(oneSet);
-      }
-    }
     // --------------------------------------------------------------------
 
     // Report result -------------------------------------------------------
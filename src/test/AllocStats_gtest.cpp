@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "AllocStats.h"
+#include "RunStats.h"
+
+// Most of this only bites in a make ALLOC_STATS=1 build
+TEST(AllocStatsTest, TestCounting)
+{
+  AllocStats::Counters before, after;
+  AllocStats::read(before);
+  AllocStats::resetPeak();
+  // Direct calls, a new expression pair may be optimized away
+  void* small = ::operator new(24);
+  void* big = ::operator new(1 << 20);
+  ::operator delete(big);
+  ::operator delete(small);
+  AllocStats::read(after);
+
+  if (!AllocStats::isEnabled())
+  {
+    EXPECT_EQ(0u, after.allocations);
+    EXPECT_EQ(0u, after.peakLiveBytes);
+    return;
+  }
+
+  EXPECT_EQ(before.allocations + 2, after.allocations);
+  EXPECT_EQ(before.frees + 2, after.frees);
+  EXPECT_EQ(before.bytes + 24 + (1 << 20), after.bytes);
+  EXPECT_EQ(before.liveBytes, after.liveBytes);
+  EXPECT_GE(after.peakLiveBytes, before.liveBytes + (1 << 20));
+}
+
+TEST(AllocStatsTest, TestPerPhase)
+{
+  RunStats stats;
+  stats.enter(RunStats::PHASE_SCAN);
+  vector<string> strings(1000, string(100, 's'));
+  stats.enter(RunStats::PHASE_MERGE);
+  strings.clear();
+  strings.shrink_to_fit();
+  stats.stop();
+
+  const AllocStats::Counters& scan = stats.getAllocs(RunStats::PHASE_SCAN);
+  const AllocStats::Counters& merge = stats.getAllocs(RunStats::PHASE_MERGE);
+  std::ostringstream json;
+  stats.printJson(json);
+  if (!AllocStats::isEnabled())
+  {
+    EXPECT_EQ(0u, scan.allocations);
+    EXPECT_EQ(string::npos, json.str().find("\"allocations\":"));
+    return;
+  }
+
+  EXPECT_LE(1001u, scan.allocations);
+  EXPECT_LE(100000u, scan.bytes);
+  EXPECT_LE(100000u, scan.peakLiveBytes);
+  EXPECT_EQ(0u, merge.allocations);
+  EXPECT_LE(1001u, merge.frees);
+  EXPECT_NE(string::npos, json.str().find("\"scan\":{"));
+  EXPECT_NE(string::npos, json.str().find("\"allocations\":"));
+}
@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "BatchRunner.h"
+
+TEST(BatchRunnerTest, TestRun)
+{
+  ConfigFile::SectionList sections(3);
+  sections[0].first = "with-include";
+  sections[0].second.projDirs = {"test/asset/has-header-with-include"};
+  sections[1].first = "excluded";
+  sections[1].second = sections[0].second;
+  sections[1].second.excludedFiles.insert("1file2.hpp");
+  sections[2].first = "no-include";
+  sections[2].second.projDirs = {"test/asset/has-header-no-include"};
+
+  // Same results as projects run one by one, whatever the thread count
+  vector<BatchRunner::Result> expected;
+  for (const auto& section : sections)
+  {
+    vector<BatchRunner::Result> one;
+    ASSERT_EQ(0, BatchRunner::run({section}, 1, false, one));
+    ASSERT_EQ(1, one.size());
+    expected.push_back(one[0]);
+  }
+  EXPECT_FALSE(expected[0].cycles.empty());
+  EXPECT_TRUE(expected[1].cycles.empty());
+  EXPECT_TRUE(expected[2].cycles.empty());
+
+  for (unsigned jobCount : {1u, 3u})
+  {
+    vector<BatchRunner::Result> results;
+    ASSERT_EQ(0, BatchRunner::run(sections, jobCount, false, results));
+    ASSERT_EQ(sections.size(), results.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      EXPECT_EQ(sections[i].first, results[i].name);
+      EXPECT_TRUE(results[i].isOk());
+      EXPECT_EQ(expected[i].headerCount, results[i].headerCount);
+      EXPECT_EQ(expected[i].cycles, results[i].cycles);
+    }
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "Common.h"
+#include <libgen.h>
+#include <limits.h>
+#include <string.h>
+#include <thread>
+
+class CommonTest: public ::testing::Test
+{
+protected:
+  static const vector<string> PATHS;
+};
+
+const vector<string> CommonTest::PATHS =
+{
+  "", "/", "///", "a", "a/", "a/b", "a/b/", "a//b", "/a", "/a/b.h", "//a//b.hpp//",
+  "../x.tar.h", "./.hidden", "dir.d/file", "a/b/c.cpp"
+};
+
+TEST_F(CommonTest, TestBaseDirNameMatchLibc)
+{
+  for (const string& path : PATHS)
+  {
+    char buffer[PATH_MAX];
+    strcpy(buffer, path.c_str());
+    EXPECT_EQ(string(basename(buffer)), Common::getBaseName(path)) << path;
+    strcpy(buffer, path.c_str());
+    EXPECT_EQ(string(dirname(buffer)), Common::getDirName(path)) << path;
+  }
+
+  // POSIX leaves a leading "//" up to the implementation, glibc keeps it
+  EXPECT_EQ("/", Common::getDirName("//"));
+  EXPECT_EQ("/", Common::getBaseName("//"));
+}
+
+TEST_F(CommonTest, TestGetExtension)
+{
+  EXPECT_EQ(".h", Common::getExtension("a/b.h"));
+  EXPECT_EQ(".hpp", Common::getExtension("//a//b.hpp//"));
+  EXPECT_EQ(".h", Common::getExtension("../x.tar.h"));
+  EXPECT_EQ("", Common::getExtension("./.hidden"));
+  EXPECT_EQ("", Common::getExtension("dir.d/file"));
+  EXPECT_EQ("", Common::getExtension(""));
+
+  // Views point into the argument
+  const string path = "src/Common.cpp";
+  EXPECT_EQ(path.data() + 10, Common::getExtension(path).data());
+}
+
+TEST_F(CommonTest, TestCanonicalize)
+{
+  string output = "untouched";
+  EXPECT_FALSE(Common::canonicalize("test/asset/not-exist", output));
+  EXPECT_EQ("untouched", output);
+  EXPECT_EQ("test/asset/not-exist", Common::getRealPath("test/asset/not-exist"));
+
+  ASSERT_TRUE(Common::canonicalize("test/../test/asset", output));
+  EXPECT_EQ('/', output[0]);
+  EXPECT_EQ("asset", Common::getBaseName(output));
+  EXPECT_EQ("test", Common::getBaseName(Common::getDirName(output)));
+}
+
+TEST_F(CommonTest, TestThreadSafe)
+{
+  string expected;
+  ASSERT_TRUE(Common::canonicalize("test/asset", expected));
+
+  vector<std::thread> threads;
+  vector<int> mismatches(4, 0);
+  for (size_t index = 0; index < mismatches.size(); ++index)
+  {
+    threads.push_back(std::thread([&expected, &mismatches, index]()
+    {
+      const string path = "test/x" + std::to_string(index) + "/file" + std::to_string(index) + ".h";
+      for (int round = 0; round < 1000; ++round)
+      {
+        string real;
+        mismatches[index] += (Common::getBaseName(path) != "file" + std::to_string(index) + ".h");
+        mismatches[index] += (Common::getDirName(path) != "test/x" + std::to_string(index));
+        mismatches[index] += !Common::canonicalize("test/asset", real) || (real != expected);
+      }
+    }));
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  EXPECT_EQ(vector<int>(mismatches.size(), 0), mismatches);
+}
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "ConfigFile.h"
+#include <stdio.h>
+
+class ConfigFileTest: public ::testing::Test
+{
+protected:
+  void TearDown()
+  {
+    remove(CFG_PATH);
+  }
+
+  void writeCfg(const char* content)
+  {
+    FILE* file = fopen(CFG_PATH, "w");
+    ASSERT_NE(nullptr, file);
+    fputs(content, file);
+    fclose(file);
+  }
+
+  static constexpr const char* CFG_PATH = "test/_config_test.cfg";
+};
+
+TEST_F(ConfigFileTest, TestPlain)
+{
+  writeCfg("# comment\n"
+           "PROJECT_DIRS = a, b # trailing\n"
+           "EXCLUDE_FILES = x.h\n");
+  ConfigFile cfgFile(CFG_PATH);
+  ASSERT_TRUE(cfgFile.parse());
+  EXPECT_EQ(set<string>({"a", "b"}), cfgFile.data().projDirs);
+  EXPECT_EQ(set<string>({"x.h"}), cfgFile.data().excludedFiles);
+  EXPECT_EQ(ConfigData().excludedDirs, cfgFile.data().excludedDirs);
+  EXPECT_TRUE(cfgFile.sections().empty());
+
+  EXPECT_FALSE(ConfigFile("test/_not_exist.cfg").parse());
+}
+
+TEST_F(ConfigFileTest, TestSections)
+{
+  writeCfg("EXCLUDE_DIRS = /usr/include\n"
+           "EXCLUDE_FILES = x.h\n"
+           "[second]\n"
+           "PROJECT_DIRS = b\n"
+           "EXCLUDE_FILES = y.h\n"
+           "[ first ]\n"
+           "PROJECT_DIRS = a\n");
+  ConfigFile cfgFile(CFG_PATH);
+  ASSERT_TRUE(cfgFile.parse());
+
+  // File order, top level keys are defaults
+  const ConfigFile::SectionList& sections = cfgFile.sections();
+  ASSERT_EQ(2, sections.size());
+  EXPECT_EQ("second", sections[0].first);
+  EXPECT_EQ(set<string>({"b"}), sections[0].second.projDirs);
+  EXPECT_EQ(set<string>({"/usr/include"}), sections[0].second.excludedDirs);
+  EXPECT_EQ(set<string>({"y.h"}), sections[0].second.excludedFiles);
+  EXPECT_EQ("first", sections[1].first);
+  EXPECT_EQ(set<string>({"a"}), sections[1].second.projDirs);
+  EXPECT_EQ(set<string>({"x.h"}), sections[1].second.excludedFiles);
+}
+
+TEST_F(ConfigFileTest, TestBadSections)
+{
+  for (const char* content : {"[]\n", "[a\n", "[a/b]\n", "[a]\n[a]\n"})
+  {
+    writeCfg(content);
+    EXPECT_FALSE(ConfigFile(CFG_PATH).parse()) << content;
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "CycleBaseline.h"
+
+class CycleBaselineTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    mBaseline = {{"a.h", "b.h"}, {"c.h", "d.h", "e.h"}, {"x.h", "y.h"}};
+  }
+
+  void TearDown()
+  {
+    Common::setDebugMode(false);
+    remove(BASELINE_FILE);
+  }
+
+  static constexpr const char* BASELINE_FILE = "test/_cycle_baseline.txt";
+  CycleBaseline::CycleList mBaseline;
+};
+
+TEST_F(CycleBaselineTest, TestSaveLoad)
+{
+  set<set<string> > solution = {{"b.h", "a.h"}, {"lonely.h"}, {"e.h", "c.h", "d.h"}, {"x.h", "y.h"}};
+  CycleBaseline::CycleList cycles, loaded;
+  CycleBaseline::fromSolution(solution, cycles);
+  EXPECT_EQ(mBaseline, cycles);
+
+  ASSERT_TRUE(CycleBaseline::save(BASELINE_FILE, cycles));
+  ASSERT_TRUE(CycleBaseline::load(BASELINE_FILE, loaded));
+  EXPECT_EQ(cycles, loaded);
+
+  EXPECT_FALSE(CycleBaseline::load("test/asset/has-header-no-include/file1.hpp", loaded));
+}
+
+TEST_F(CycleBaselineTest, TestNoRegression)
+{
+  // Same, shrunk and fixed circles aren't regressions
+  CycleBaseline::CycleList current = {{"a.h", "b.h"}, {"c.h", "d.h"}};
+  CycleBaseline::Diff diff;
+  CycleBaseline::diff(mBaseline, current, diff);
+
+  EXPECT_FALSE(diff.hasRegression());
+  EXPECT_EQ(2, diff.knownCount);
+  EXPECT_EQ(1, diff.fixedCount);
+}
+
+TEST_F(CycleBaselineTest, TestRegression)
+{
+  CycleBaseline::CycleList current = {{"a.h", "b.h", "f.h"},     // grown
+                                      {"c.h", "d.h", "x.h"},     // merged
+                                      {"m.h", "n.h"},            // new
+                                      {"y.h", "z.h"}};           // moved member
+  CycleBaseline::Diff diff;
+  CycleBaseline::diff(mBaseline, current, diff);
+
+  EXPECT_TRUE(diff.hasRegression());
+  EXPECT_EQ(vector<size_t>({2}), diff.newCycles);
+  EXPECT_EQ(vector<size_t>({0, 1, 3}), diff.grownCycles);
+  EXPECT_EQ(0, diff.knownCount);
+  EXPECT_EQ(0, diff.fixedCount);
+}
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "DepfileLoader.h"
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class DepfileLoaderTest: public ::testing::Test
+{
+protected:
+  /**
+   * Edges of graph as from:to names, sorted
+   */
+  static set<string> getEdges(const CompactGraph& graph)
+  {
+    set<string> retVal;
+    for (unsigned id = 0; id < graph.size(); ++id)
+    {
+      for (const unsigned* child = graph.childBegin(id); child != graph.childEnd(id); ++child)
+      {
+        retVal.insert(string(graph.name(id)) + ":" + graph.name(*child));
+      }
+    }
+    return retVal;
+  }
+
+  static set<string> parse(const vector<string>& contents)
+  {
+    vector<GraphBuilder::Part> parts(contents.size());
+    for (size_t i = 0; i < contents.size(); ++i)
+    {
+      DepfileLoader::parse(contents[i].data(), contents[i].size(), parts[i]);
+    }
+
+    CompactGraph graph;
+    EXPECT_TRUE(GraphBuilder::build(parts, graph));
+    return getEdges(graph);
+  }
+};
+
+TEST_F(DepfileLoaderTest, TestParse)
+{
+  // Continuations with \r\n, the TU repeated in the list and -MP phony rules
+  set<string> expected = {"a.cpp:x.h", "a.cpp:y.h", "a.cpp:z.h"};
+  EXPECT_EQ(expected, parse({"out/a.o: a.cpp x.h \\\n  y.h \\\r\n z.h a.cpp\n\nx.h:\ny.h:\n"}));
+
+  // Only a blank or end of line ends the targets, not a drive letter
+  expected = {"b.cpp:C:/inc/b.h"};
+  EXPECT_EQ(expected, parse({"b.o : b.cpp C:/inc/b.h\n"}));
+
+  // No prerequisites but the TU
+  EXPECT_TRUE(parse({"c.o: c.cpp\n", "", "\n\n"}).empty());
+}
+
+TEST_F(DepfileLoaderTest, TestEscapes)
+{
+  set<string> expected = {"a.cpp:my file.h", "a.cpp:lib#1/x.h", "a.cpp:$(dir)/y.h", "a.cpp:c\\d.h"};
+  EXPECT_EQ(expected, parse({"# comment: not.h\n"
+                             "a.o: a.cpp my\\ file.h lib\\#1/x.h $$(dir)/y.h c\\d.h # z.h\n"}));
+}
+
+TEST_F(DepfileLoaderTest, TestMerge)
+{
+  // Headers shared by 2 depfiles get one node, the same rule twice one edge
+  set<string> expected = {"a.cpp:common.h", "a.cpp:a.h", "b.cpp:common.h"};
+  EXPECT_EQ(expected, parse({"a.o: a.cpp common.h a.h\n", "b.o: b.cpp common.h\n",
+                             "a.o: a.cpp common.h\n"}));
+}
+
+TEST_F(DepfileLoaderTest, TestLoad)
+{
+  static const char* DIR = "test/_depfiles";
+  static const char* SUB_DIR = "test/_depfiles/sub";
+  static const char* FILES[] = {"test/_depfiles/b.d", "test/_depfiles/sub/a.d",
+                                "test/_depfiles/sub/a.o"};
+  mkdir(DIR, 0755);
+  mkdir(SUB_DIR, 0755);
+  std::ofstream(FILES[0]) << "b.o: b.cpp b.h \\\n common.h\n";
+  std::ofstream(FILES[1]) << "a.o: a.cpp common.h\n";
+  std::ofstream(FILES[2]) << "not a depfile";
+
+  vector<string> paths;
+  EXPECT_TRUE(DepfileLoader::findDepfiles(DIR, paths));
+  EXPECT_EQ(vector<string>({FILES[0], FILES[1]}), paths);
+
+  CompactGraph graph;
+  paths.push_back("test/_no_such_depfile.d");
+  EXPECT_EQ(1, DepfileLoader::load(paths, graph));
+  set<string> expected = {"a.cpp:common.h", "b.cpp:b.h", "b.cpp:common.h"};
+  EXPECT_EQ(expected, getEdges(graph));
+
+  for (const char* file : FILES)
+  {
+    remove(file);
+  }
+  rmdir(SUB_DIR);
+  rmdir(DIR);
+  EXPECT_FALSE(DepfileLoader::findDepfiles(DIR, paths));
+}
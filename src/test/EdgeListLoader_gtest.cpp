@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "EdgeListLoader.h"
+#include <fstream>
+
+class EdgeListLoaderTest: public ::testing::Test
+{
+protected:
+  void TearDown()
+  {
+    Common::setDebugMode(false);
+  }
+
+  /**
+   * Edges of graph as from:to names, sorted
+   */
+  static set<string> getEdges(const CompactGraph& graph)
+  {
+    set<string> retVal;
+    for (unsigned id = 0; id < graph.size(); ++id)
+    {
+      for (const unsigned* child = graph.childBegin(id); child != graph.childEnd(id); ++child)
+      {
+        retVal.insert(string(graph.name(id)) + ":" + graph.name(*child));
+      }
+    }
+    return retVal;
+  }
+
+  static bool load(const string& content, CompactGraph& graph,
+                   EdgeListLoader::Format format = EdgeListLoader::FORMAT_AUTO)
+  {
+    return EdgeListLoader::load(content.data(), content.size(), graph, format);
+  }
+};
+
+TEST_F(EdgeListLoaderTest, TestDetectFormat)
+{
+  auto detect = [](const string& content)
+  {
+    return EdgeListLoader::detectFormat(content.data(), content.size());
+  };
+
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect("a b c\nb d\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect("\n\nc d\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect("p q\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_SNAP, detect("# Directed graph\n# FromNodeId\tToNodeId\n0\t1\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_DIMACS, detect("c comment\nc\np sp 3 2\na 1 2 7\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect(""));
+
+  // p lines that aren't problem lines name a node p
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect("p a b c\na p\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect("p sp 3 x\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_ADJACENCY, detect("p sp 3 2 1\n"));
+  EXPECT_EQ(EdgeListLoader::FORMAT_DIMACS, detect("p edge 3 2\ne 1 2\n"));
+
+  EdgeListLoader::Format format;
+  EXPECT_TRUE(EdgeListLoader::parseFormat("dimacs", format));
+  EXPECT_EQ(EdgeListLoader::FORMAT_DIMACS, format);
+  EXPECT_FALSE(EdgeListLoader::parseFormat("csv", format));
+}
+
+TEST_F(EdgeListLoaderTest, TestAdjacency)
+{
+  // Same node on 2 lines is merged, a lone node is kept
+  CompactGraph graph;
+  ASSERT_TRUE(load("a b c\r\nb d\n\n  d\te  \na b f\nlonely", graph));
+  set<string> expected = {"a:b", "a:c", "a:f", "b:d", "d:e"};
+  EXPECT_EQ(expected, getEdges(graph));
+  ASSERT_EQ(7u, graph.size());
+  EXPECT_STREQ("a", graph.name(0));
+  EXPECT_STREQ("lonely", graph.name(6));
+  EXPECT_EQ(0u, *graph.childLineBegin(0));
+}
+
+TEST_F(EdgeListLoaderTest, TestAdjacencyNodeP)
+{
+  // First node named p with 3 children looks like a DIMACS problem line
+  CompactGraph graph;
+  ASSERT_TRUE(load("p a b c\na p\n", graph));
+  set<string> expected = {"p:a", "p:b", "p:c", "a:p"};
+  EXPECT_EQ(expected, getEdges(graph));
+  EXPECT_EQ(4u, graph.size());
+}
+
+TEST_F(EdgeListLoaderTest, TestSnap)
+{
+  // Extra columns like timestamps are ignored
+  CompactGraph graph;
+  ASSERT_TRUE(load("# Nodes: 3 Edges: 3\n0\t1\t1082040961\n1\t2\n2\t0\n2\t0\n", graph));
+  set<string> expected = {"0:1", "1:2", "2:0"};
+  EXPECT_EQ(expected, getEdges(graph));
+  EXPECT_EQ(3u, graph.size());
+}
+
+TEST_F(EdgeListLoaderTest, TestDimacs)
+{
+  // Node 4 has no edges, e edges go both ways
+  CompactGraph graph;
+  ASSERT_TRUE(load("c sample\np sp 4 3\na 1 2 10\na 2 3 5\ne 3 1\nx bad\n", graph));
+  set<string> expected = {"1:2", "2:3", "3:1", "1:3"};
+  EXPECT_EQ(expected, getEdges(graph));
+  unsigned id;
+  EXPECT_EQ(4u, graph.size());
+  EXPECT_TRUE(graph.findId("4", id));
+}
+
+TEST_F(EdgeListLoaderTest, TestDimacsNodeCountTooBig)
+{
+  CompactGraph graph;
+  EXPECT_FALSE(load("p sp 99999999999999 1\n", graph, EdgeListLoader::FORMAT_DIMACS));
+  EXPECT_FALSE(load("p sp 4294967297 1\n", graph, EdgeListLoader::FORMAT_DIMACS));
+  EXPECT_FALSE(load("p sp 4000000000 1\na 1 2\n", graph));
+  EXPECT_FALSE(load("p sp 99999999999999999999999 1\n", graph));
+
+  // Nodes without edges still make a small input
+  ASSERT_TRUE(load("p sp 1000 1\na 1 2\n", graph));
+  EXPECT_EQ(1000u, graph.size());
+}
+
+TEST_F(EdgeListLoaderTest, TestSplitChunks)
+{
+  // Big enough for several parser threads, chunk borders fall mid line
+  Graph expectedGraph;
+  string content;
+  for (unsigned i = 0; i < 200000; ++i)
+  {
+    const string from = "node_" + std::to_string(i);
+    const string to = "node_" + std::to_string((i * 7919) % 200000);
+    content += from + " " + to + "\n";
+    Node node(from);
+    node.childNodes.insert(to);
+    expectedGraph.insert(node);
+  }
+
+  CompactGraph graph, expected(expectedGraph);
+  ASSERT_TRUE(load(content, graph, EdgeListLoader::FORMAT_ADJACENCY));
+  ASSERT_EQ(expected.size(), graph.size());
+  ASSERT_EQ(expected.edgeCount(), graph.edgeCount());
+  for (unsigned id = 0; id < graph.size(); ++id)
+  {
+    ASSERT_STREQ(expected.name(id), graph.name(id));
+    ASSERT_EQ(vector<unsigned>(expected.childBegin(id), expected.childEnd(id)),
+              vector<unsigned>(graph.childBegin(id), graph.childEnd(id)));
+  }
+}
+
+TEST_F(EdgeListLoaderTest, TestFile)
+{
+  static const char* GRAPH_FILE = "test/_edge_list.txt";
+  {
+    std::ofstream file(GRAPH_FILE);
+    file << "# snap\n1 2\n2 1\n";
+  }
+
+  CompactGraph graph;
+  EXPECT_FALSE(EdgeListLoader::load("test/_no_such_graph.txt", graph));
+  EXPECT_TRUE(EdgeListLoader::load(GRAPH_FILE, graph));
+  remove(GRAPH_FILE);
+  set<string> expected = {"1:2", "2:1"};
+  EXPECT_EQ(expected, getEdges(graph));
+}
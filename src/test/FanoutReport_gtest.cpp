@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "FanoutReport.h"
+
+class FanoutTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+  }
+
+  void TearDown()
+  {
+    Common::setDebugMode(false);
+  }
+
+  /**
+   * 150 translation units all include top.h, every 3rd one includes
+   * mid.h directly, top.h <-> mid.h is a circle and mid.h -> leaf.h
+   */
+  void buildGraph(Graph& graph)
+  {
+    Node top("top.h"), mid("mid.h"), leaf("leaf.h");
+    top.childNodes.insert("mid.h");
+    mid.childNodes.insert("top.h");
+    mid.childNodes.insert("leaf.h");
+    graph.insert(top);
+    graph.insert(mid);
+    graph.insert(leaf);
+
+    for (int i = 0; i < 150; ++i)
+    {
+      Node tu("tu" + std::to_string(i) + ".cpp");
+      tu.childNodes.insert(i % 3 ? "top.h" : "mid.h");
+      graph.insert(tu);
+    }
+  }
+
+  const FanoutReport::Score& findScore(const CompactGraph& graph, const FanoutReport& report,
+                                      const string& name)
+  {
+    unsigned id = 0;
+    EXPECT_TRUE(graph.findId(name, id));
+    for (const auto& score : report.getScores())
+    {
+      if (score.node == id)
+      {
+        return score;
+      }
+    }
+    return report.getScores().front();
+  }
+};
+
+TEST_F(FanoutTest, TestScores)
+{
+  Graph input;
+  buildGraph(input);
+  CompactGraph graph(input);
+  Condensation dag(graph);
+  ASSERT_TRUE(dag.solve());
+
+  vector<bool> isSource(graph.size(), true);
+  vector<uint64_t> nodeBytes(graph.size(), 10);
+  unsigned id;
+  for (const char* header : {"top.h", "mid.h", "leaf.h"})
+  {
+    ASSERT_TRUE(graph.findId(header, id));
+    isSource[id] = false;
+    nodeBytes[id] = 100;
+  }
+
+  // 1st with a single column block, then with 1 word per block
+  FanoutReport report(dag, isSource, nodeBytes);
+  FanoutReport smallReport(dag, isSource, nodeBytes, 0);
+  ASSERT_TRUE(report.solve());
+  ASSERT_TRUE(smallReport.solve());
+
+  for (const FanoutReport* oneReport : {&report, &smallReport})
+  {
+    ASSERT_EQ(3, oneReport->getScores().size());
+    EXPECT_EQ(150, findScore(graph, *oneReport, "top.h").tuCount);
+    EXPECT_EQ(150, findScore(graph, *oneReport, "mid.h").tuCount);
+    EXPECT_EQ(150, findScore(graph, *oneReport, "leaf.h").tuCount);
+
+    // Each translation unit parses itself plus 3 headers
+    EXPECT_EQ(150 * 310, findScore(graph, *oneReport, "leaf.h").rebuildBytes);
+  }
+}
+
+TEST_F(FanoutTest, TestRanking)
+{
+  Graph input;
+  buildGraph(input);
+  Node lonely("lonely.h");
+  input.insert(lonely);
+  Node other("other.h");
+  other.childNodes.insert("lonely.h");
+  input.insert(other);
+  Node tu("other.cpp");
+  tu.childNodes.insert("other.h");
+  input.insert(tu);
+
+  CompactGraph graph(input);
+  Condensation dag(graph);
+  ASSERT_TRUE(dag.solve());
+
+  vector<bool> isSource(graph.size(), false);
+  vector<uint64_t> nodeBytes(graph.size(), 1);
+  for (unsigned id = 0; id < graph.size(); ++id)
+  {
+    isSource[id] = string(graph.name(id)).find(".cpp") != string::npos;
+  }
+
+  FanoutReport report(dag, isSource, nodeBytes);
+  ASSERT_TRUE(report.solve());
+  const auto& scores = report.getScores();
+  ASSERT_EQ(5, scores.size());
+  EXPECT_EQ(150, scores[0].tuCount);
+  EXPECT_EQ(1, scores[3].tuCount);
+  EXPECT_EQ(1, scores[4].tuCount);
+  EXPECT_EQ(3, scores[4].rebuildBytes);
+}
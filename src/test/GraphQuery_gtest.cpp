@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "GraphQuery.h"
+#include "ProjectParser.h"
+
+class GraphQueryTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    mAssetDir = "test/asset/has-source-with-include";
+    set<string> excludeFiles = {"stdio.h"};
+    Graph detailGraph;
+    ProjectParser::HeaderLocationMap locationMap;
+    ASSERT_EQ(0, ProjectParser::parse({mAssetDir}, excludeFiles, mGraph, detailGraph,
+                                      locationMap, true));
+  }
+
+  void TearDown()
+  {
+    Common::setDebugMode(false);
+  }
+
+  vector<string> getDependents(const vector<string>& changedFiles)
+  {
+    CompactGraph graph(mGraph);
+    graph.generateParents();
+
+    vector<unsigned> changedIds, affectedIds;
+    for (const string& file : changedFiles)
+    {
+      unsigned id;
+      EXPECT_TRUE(graph.findId(file, id));
+      changedIds.push_back(id);
+    }
+    GraphQuery::getDependents(graph, changedIds, affectedIds);
+
+    vector<string> retVal;
+    for (const unsigned id : affectedIds)
+    {
+      retVal.push_back(graph.name(id));
+    }
+    return retVal;
+  }
+
+  string mAssetDir;
+  Graph mGraph;
+};
+
+TEST_F(GraphQueryTest, TestLeafHeader)
+{
+  const vector<string> expected = {"a.hpp", mAssetDir + "/main.cpp",
+                                   mAssetDir + "/sub/main.cpp", mAssetDir + "/sub/util.c"};
+  EXPECT_EQ(expected, getDependents({"b.hpp"}));
+}
+
+TEST_F(GraphQueryTest, TestSeveralHeaders)
+{
+  const vector<string> expected = {mAssetDir + "/main.cpp", mAssetDir + "/sub/main.cpp"};
+  EXPECT_EQ(expected, getDependents({"a.hpp"}));
+  EXPECT_EQ(4, getDependents({"a.hpp", "b.hpp"}).size());
+  EXPECT_TRUE(getDependents({mAssetDir + "/main.cpp"}).empty());
+}
+
+TEST(GraphQueryChainTest, TestShortestChain)
+{
+  // a -> b -> c -> d -> b, a -> e -> c
+  Graph input;
+  const vector<std::pair<string, set<string> > > edges = {
+    {"a", {"b", "e"}}, {"b", {"c"}}, {"c", {"d"}}, {"d", {"b"}}, {"e", {"c"}}};
+  for (const auto& edge : edges)
+  {
+    Node node(edge.first);
+    node.childNodes = edge.second;
+    input.insert(node);
+  }
+  CompactGraph graph(input);
+
+  auto getChain = [&graph](const string& from, const string& to)
+  {
+    unsigned fromId, toId;
+    EXPECT_TRUE(graph.findId(from, fromId) && graph.findId(to, toId));
+    vector<unsigned> chain;
+    vector<string> retVal;
+    if (GraphQuery::getShortestChain(graph, fromId, toId, chain))
+    {
+      for (const unsigned id : chain)
+      {
+        retVal.push_back(graph.name(id));
+      }
+    }
+    return retVal;
+  };
+
+  EXPECT_EQ(vector<string>({"a", "b"}), getChain("a", "b"));
+  EXPECT_EQ(vector<string>({"a", "b", "c", "d"}), getChain("a", "d"));
+  EXPECT_EQ(vector<string>({"b", "c", "d", "b"}), getChain("b", "b"));
+  EXPECT_TRUE(getChain("d", "a").empty());
+  EXPECT_TRUE(getChain("a", "a").empty());
+}
@@ -0,0 +1,230 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "GraphSnapshot.h"
+#include "TarjanSolver.h"
+#include <cstring>
+#include <fstream>
+
+class GraphSnapshotTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    // a.h -> b.h -> c.h -> a.h, main.cpp -> a.h
+    Node a("a.h"), b("b.h"), c("c.h"), main("src/main.cpp");
+    a.childNodes = {"b.h"};
+    a.childLines = {{"b.h", 3}};
+    b.childNodes = {"c.h"};
+    b.childLines = {{"c.h", 5}};
+    c.childNodes = {"a.h"};
+    c.childLines = {{"a.h", 7}};
+    main.childNodes = {"a.h"};
+    main.childLines = {{"a.h", 1}};
+    mGraph = {a, b, c, main};
+    mLocationMap = {{"a.h", {"inc/a.h", "other/a.h"}}, {"b.h", {"inc/b.h"}}, {"c.h", {"inc/c.h"}}};
+  }
+
+  void TearDown()
+  {
+    Common::setDebugMode(false);
+    remove(SNAPSHOT_FILE);
+  }
+
+  static constexpr const char* SNAPSHOT_FILE = "test/_graph.snap";
+  Graph mGraph;
+  ProjectParser::HeaderLocationMap mLocationMap;
+};
+
+TEST_F(GraphSnapshotTest, TestRoundTrip)
+{
+  CompactGraph graph(mGraph);
+  ASSERT_TRUE(GraphSnapshot::write(SNAPSHOT_FILE, graph, mLocationMap));
+  EXPECT_TRUE(GraphSnapshot::isSnapshot(SNAPSHOT_FILE));
+  EXPECT_FALSE(GraphSnapshot::isSnapshot("test/asset/has-header-no-include/file1.hpp"));
+
+  GraphSnapshot snapshot;
+  ASSERT_TRUE(snapshot.open(SNAPSHOT_FILE));
+  const CompactGraph& loaded = snapshot.graph();
+  ASSERT_EQ(graph.size(), loaded.size());
+  ASSERT_EQ(graph.edgeCount(), loaded.edgeCount());
+  EXPECT_TRUE(loaded.hasParents());
+  for (unsigned id = 0; id < loaded.size(); ++id)
+  {
+    EXPECT_STREQ(graph.name(id), loaded.name(id));
+    EXPECT_EQ(vector<unsigned>(graph.childBegin(id), graph.childEnd(id)),
+              vector<unsigned>(loaded.childBegin(id), loaded.childEnd(id)));
+    EXPECT_EQ(vector<unsigned>(graph.parentBegin(id), graph.parentEnd(id)),
+              vector<unsigned>(loaded.parentBegin(id), loaded.parentEnd(id)));
+  }
+
+  unsigned id;
+  ASSERT_TRUE(loaded.findId("b.h", id));
+  ASSERT_EQ(1, loaded.childEnd(id) - loaded.childBegin(id));
+  EXPECT_STREQ("c.h", loaded.name(*loaded.childBegin(id)));
+  EXPECT_EQ(5u, *loaded.childLineBegin(id));
+
+  ASSERT_TRUE(loaded.findId("src/main.cpp", id));
+  EXPECT_EQ(1u, *loaded.childLineBegin(id));
+  EXPECT_EQ(0u, snapshot.pathCount(id));
+
+  ASSERT_TRUE(loaded.findId("a.h", id));
+  ASSERT_EQ(2u, snapshot.pathCount(id));
+  EXPECT_STREQ("inc/a.h", snapshot.path(id, 0));
+  EXPECT_STREQ("other/a.h", snapshot.path(id, 1));
+
+  ProjectParser::HeaderLocationMap locationMap;
+  snapshot.getLocationMap(locationMap);
+  EXPECT_EQ(mLocationMap, locationMap);
+}
+
+TEST_F(GraphSnapshotTest, TestSolveSnapshot)
+{
+  CompactGraph graph(mGraph);
+  ASSERT_TRUE(GraphSnapshot::write(SNAPSHOT_FILE, graph, mLocationMap));
+
+  GraphSnapshot snapshot;
+  ASSERT_TRUE(snapshot.open(SNAPSHOT_FILE));
+  TarjanSolver solver(snapshot.graph());
+  set<set<string> > solution;
+  SccNameCollector collector(solver, solution);
+  ASSERT_TRUE(solver.solve(collector));
+
+  set<set<string> > expected = {{"a.h", "b.h", "c.h"}};
+  EXPECT_EQ(expected, solution);
+
+  // Legacy solve() needs a Graph
+  EXPECT_FALSE(solver.solve());
+}
+
+TEST_F(GraphSnapshotTest, TestCompressed)
+{
+  // Ids far apart need multi byte varints
+  for (unsigned i = 0; i < 300; ++i)
+  {
+    Node node("n" + std::to_string(i));
+    node.childNodes = {"n" + std::to_string((i * 7) % 300), "n" + std::to_string((i + 150) % 300)};
+    node.childLines = {{"n" + std::to_string((i * 7) % 300), i * 1000}};
+    mGraph.insert(node);
+  }
+
+  CompactGraph graph(mGraph);
+  ASSERT_TRUE(GraphSnapshot::write(SNAPSHOT_FILE, graph, mLocationMap, true));
+  GraphSnapshot snapshot;
+  ASSERT_TRUE(snapshot.open(SNAPSHOT_FILE));
+  const CompactGraph& loaded = snapshot.graph();
+  EXPECT_TRUE(loaded.isEncoded());
+  EXPECT_TRUE(loaded.hasParents());
+  ASSERT_EQ(graph.size(), loaded.size());
+  ASSERT_EQ(graph.edgeCount(), loaded.edgeCount());
+
+  auto getValues = [](EdgeCursor cursor)
+  {
+    vector<unsigned> values;
+    unsigned value;
+    while (cursor.next(value))
+    {
+      values.push_back(value);
+    }
+    return values;
+  };
+  for (unsigned id = 0; id < loaded.size(); ++id)
+  {
+    EXPECT_STREQ(graph.name(id), loaded.name(id));
+    EXPECT_EQ(getValues(graph.children(id)), getValues(loaded.children(id)));
+    EXPECT_EQ(getValues(graph.childLines(id)), getValues(loaded.childLines(id)));
+    EXPECT_EQ(getValues(graph.parents(id)), getValues(loaded.parents(id)));
+  }
+
+  // Solver walks the encoded lists as is
+  TarjanSolver solver(loaded);
+  set<set<string> > solution;
+  SccNameCollector collector(solver, solution);
+  ASSERT_TRUE(solver.solve(collector));
+  EXPECT_EQ(1u, solution.count({"a.h", "b.h", "c.h"}));
+
+  // Round trip through a plain snapshot keeps everything
+  static const char* PLAIN_FILE = "test/_graph_plain.snap";
+  CompactGraph& encoded = snapshot.graph();
+  ASSERT_TRUE(GraphSnapshot::write(PLAIN_FILE, encoded, mLocationMap));
+  GraphSnapshot plain;
+  ASSERT_TRUE(plain.open(PLAIN_FILE));
+  remove(PLAIN_FILE);
+  EXPECT_FALSE(plain.graph().isEncoded());
+  for (unsigned id = 0; id < loaded.size(); ++id)
+  {
+    EXPECT_EQ(getValues(graph.children(id)), getValues(plain.graph().children(id)));
+    EXPECT_EQ(getValues(graph.childLines(id)), getValues(plain.graph().childLines(id)));
+  }
+}
+
+TEST_F(GraphSnapshotTest, TestCorrupted)
+{
+  CompactGraph graph(mGraph);
+  ASSERT_TRUE(GraphSnapshot::write(SNAPSHOT_FILE, graph, mLocationMap));
+
+  string content;
+  {
+    std::ifstream file(SNAPSHOT_FILE, std::ifstream::binary);
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  // Truncated file has sections out of bounds
+  {
+    std::ofstream file(SNAPSHOT_FILE, std::ofstream::binary | std::ofstream::trunc);
+    file.write(content.data(), content.size() - 4);
+  }
+  GraphSnapshot snapshot;
+  EXPECT_FALSE(snapshot.open(SNAPSHOT_FILE));
+  EXPECT_EQ(0u, snapshot.graph().size());
+
+  // Unknown version
+  content[8] = 99;
+  {
+    std::ofstream file(SNAPSHOT_FILE, std::ofstream::binary | std::ofstream::trunc);
+    file.write(content.data(), content.size());
+  }
+  EXPECT_TRUE(GraphSnapshot::isSnapshot(SNAPSHOT_FILE));
+  EXPECT_FALSE(snapshot.open(SNAPSHOT_FILE));
+
+  EXPECT_FALSE(snapshot.open("test/_no_such.snap"));
+
+  // Varint running past the end of its list
+  ASSERT_TRUE(GraphSnapshot::write(SNAPSHOT_FILE, graph, mLocationMap, true));
+  ASSERT_TRUE(snapshot.open(SNAPSHOT_FILE));
+  snapshot.close();
+  {
+    std::ifstream file(SNAPSHOT_FILE, std::ifstream::binary);
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  const size_t edgeSection = 8 + 4 * 4 + 3 * 8 + 3 * 16;
+  uint64_t edgeBytesOffset;
+  memcpy(&edgeBytesOffset, content.data() + edgeSection, sizeof(edgeBytesOffset));
+  content[edgeBytesOffset] |= 0x80;
+  {
+    std::ofstream file(SNAPSHOT_FILE, std::ofstream::binary | std::ofstream::trunc);
+    file.write(content.data(), content.size());
+  }
+  EXPECT_FALSE(snapshot.open(SNAPSHOT_FILE));
+}
@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+// Debug messages compiled out in this file only, see TestCompiledOutLevel
+#undef SPINCLUDE_LOG_LEVEL
+#define SPINCLUDE_LOG_LEVEL 1
+
+#include "gtest/gtest.h"
+#include "Common.h"
+#include <cstdio>
+#include <thread>
+
+class LoggerTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    mOut = tmpfile();
+    mErr = tmpfile();
+    ASSERT_TRUE(mOut != nullptr && mErr != nullptr);
+    Logger::setOutput(mOut, mErr);
+  }
+
+  void TearDown()
+  {
+    Logger::setOutput(nullptr, nullptr);
+    fclose(mOut);
+    fclose(mErr);
+    Common::setVerboseMode(false);
+  }
+
+  /**
+   * Everything logged to file so far, one entry per line
+   */
+  static vector<string> readLines(FILE* file)
+  {
+    Logger::flush();
+    vector<string> retVal;
+    rewind(file);
+    string line;
+    int c;
+    while ((c = fgetc(file)) != EOF)
+    {
+      if (c == '\n')
+      {
+        retVal.push_back(line);
+        line.clear();
+      }
+      else
+      {
+        line.push_back((char) c);
+      }
+    }
+    return retVal;
+  }
+
+  FILE* mOut;
+  FILE* mErr;
+};
+
+TEST_F(LoggerTest, TestStreams)
+{
+  LOG_ERROR("error " << 1);
+  LOG_WARN("warning " << 2.5);
+  LOG_LINE_(Logger::STREAM_OUT, "out " << 'x');
+
+  const vector<string> errLines = readLines(mErr);
+  ASSERT_EQ(2u, errLines.size());
+  EXPECT_EQ("[ERROR] error 1", errLines[0]);
+  EXPECT_EQ("[WARNING] warning 2.5", errLines[1]);
+  const vector<string> outLines = readLines(mOut);
+  ASSERT_EQ(1u, outLines.size());
+  EXPECT_EQ("out x", outLines[0]);
+}
+
+TEST_F(LoggerTest, TestThreadOrder)
+{
+  // Way more than a ring holds, writers block on the background thread
+  const unsigned THREADS = 4, LINES = 20000;
+  vector<std::thread> threads;
+  for (unsigned i = 0; i < THREADS; ++i)
+  {
+    threads.emplace_back([i, LINES]()
+    {
+      for (unsigned n = 0; n < LINES; ++n)
+      {
+        LOG_ERROR(i << " " << n);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  vector<unsigned> next(THREADS, 0);
+  const vector<string> lines = readLines(mErr);
+  EXPECT_EQ(THREADS * LINES, lines.size());
+  for (const string& line : lines)
+  {
+    unsigned i, n;
+    ASSERT_EQ(2, sscanf(line.c_str(), "[ERROR] %u %u", &i, &n)) << line;
+    ASSERT_LT(i, THREADS);
+    ASSERT_EQ(next[i], n);
+    ++next[i];
+  }
+}
+
+TEST_F(LoggerTest, TestHugeMessage)
+{
+  const string huge(300000, 'h');
+  LOG_ERROR("before");
+  LOG_ERROR(huge);
+  LOG_ERROR("after");
+
+  const vector<string> lines = readLines(mErr);
+  ASSERT_EQ(3u, lines.size());
+  EXPECT_EQ("[ERROR] before", lines[0]);
+  EXPECT_EQ("[ERROR] " + huge, lines[1]);
+  EXPECT_EQ("[ERROR] after", lines[2]);
+}
+
+TEST_F(LoggerTest, TestSeparatorAfterQueuedLines)
+{
+  // A separator is written straight to the file, queued lines must land first
+  for (unsigned n = 0; n < 100; ++n)
+  {
+    LOG_ERROR("line " << n);
+    Common::printSeparatorFd(1, mErr);
+  }
+
+  const vector<string> lines = readLines(mErr);
+  ASSERT_EQ(200u, lines.size());
+  for (unsigned n = 0; n < 100; ++n)
+  {
+    EXPECT_EQ("[ERROR] line " + std::to_string(n), lines[2 * n]);
+    EXPECT_EQ(string(80, '-'), lines[2 * n + 1]);
+  }
+}
+
+static int logInner()
+{
+  LOG_ERROR("inner");
+  return 7;
+}
+
+TEST_F(LoggerTest, TestNestedMessage)
+{
+  LOG_ERROR("outer " << logInner());
+
+  const vector<string> lines = readLines(mErr);
+  ASSERT_EQ(2u, lines.size());
+  EXPECT_EQ("[ERROR] inner", lines[0]);
+  EXPECT_EQ("[ERROR] outer 7", lines[1]);
+}
+
+TEST_F(LoggerTest, TestCompiledOutLevel)
+{
+  Common::setVerboseMode(true);
+  int evaluated = 0;
+  LOG_DEBUG("debug " << ++evaluated);
+  EXPECT_EQ(0, evaluated);
+  LOG_WARN("warning " << ++evaluated);
+  EXPECT_EQ(1, evaluated);
+
+  EXPECT_TRUE(readLines(mOut).empty());
+  EXPECT_EQ(1u, readLines(mErr).size());
+}
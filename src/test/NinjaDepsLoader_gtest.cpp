@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "NinjaDepsLoader.h"
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Writes deps logs the way ninja does
+ */
+class NinjaDepsLog
+{
+public:
+  explicit NinjaDepsLog(uint32_t version = 4): mVersion(version), mPathCount(0)
+  {
+    mData = "# ninjadeps\n";
+    addU32_(version);
+  }
+
+  unsigned addPath(const string& path)
+  {
+    const size_t padding = (4 - path.size() % 4) % 4;
+    addU32_(path.size() + padding + 4);
+    mData += path;
+    mData.append(padding, '\0');
+    addU32_(~mPathCount);
+    return mPathCount++;
+  }
+
+  void addDeps(unsigned outId, const vector<unsigned>& inputIds)
+  {
+    const uint32_t headerSize = (mVersion < 4) ? 8 : 12;
+    addU32_((headerSize + 4 * inputIds.size()) | 0x80000000u);
+    addU32_(outId);
+    addU32_(12345);
+    if (mVersion >= 4)
+    {
+      addU32_(0);
+    }
+    for (const unsigned id : inputIds)
+    {
+      addU32_(id);
+    }
+  }
+
+  string& data() { return mData; }
+
+private:
+  void addU32_(uint32_t value)
+  {
+    mData.append((const char*) &value, sizeof(value));
+  }
+
+  uint32_t mVersion;
+  uint32_t mPathCount;
+  string mData;
+};
+
+class NinjaDepsLoaderTest: public ::testing::Test
+{
+protected:
+  /**
+   * Edges of graph as from:to names, sorted
+   */
+  static set<string> getEdges(const CompactGraph& graph)
+  {
+    set<string> retVal;
+    for (unsigned id = 0; id < graph.size(); ++id)
+    {
+      for (const unsigned* child = graph.childBegin(id); child != graph.childEnd(id); ++child)
+      {
+        retVal.insert(string(graph.name(id)) + ":" + graph.name(*child));
+      }
+    }
+    return retVal;
+  }
+
+  static bool parse(const string& data, CompactGraph& graph)
+  {
+    vector<GraphBuilder::Part> parts(1);
+    return NinjaDepsLoader::parse(data.data(), data.size(), parts[0])
+        && GraphBuilder::build(parts, graph);
+  }
+};
+
+TEST_F(NinjaDepsLoaderTest, TestParse)
+{
+  // The later deps record of a.o replaces the first one, b.o has no source
+  // listed like with msvc, c.o has no deps left
+  NinjaDepsLog log;
+  const unsigned a = log.addPath("out/a.o");
+  const unsigned source = log.addPath("src/a.cpp");
+  const unsigned x = log.addPath("x.h");
+  log.addDeps(a, {source, x});
+  const unsigned y = log.addPath("inc/y.h");
+  log.addDeps(a, {source, x, y});
+  const unsigned b = log.addPath("out/b.o");
+  log.addDeps(b, {y});
+  const unsigned c = log.addPath("out/c.o");
+  log.addDeps(c, {});
+
+  CompactGraph graph;
+  ASSERT_TRUE(parse(log.data(), graph));
+  set<string> expected = {"src/a.cpp:x.h", "src/a.cpp:inc/y.h", "out/b.o:inc/y.h"};
+  EXPECT_EQ(expected, getEdges(graph));
+  EXPECT_EQ(4u, graph.size());
+}
+
+TEST_F(NinjaDepsLoaderTest, TestVersion3)
+{
+  NinjaDepsLog log(3);
+  const unsigned out = log.addPath("a.o");
+  log.addDeps(out, {log.addPath("a.c"), log.addPath("a.h")});
+
+  CompactGraph graph;
+  ASSERT_TRUE(parse(log.data(), graph));
+  set<string> expected = {"a.c:a.h"};
+  EXPECT_EQ(expected, getEdges(graph));
+}
+
+TEST_F(NinjaDepsLoaderTest, TestCorrupt)
+{
+  // Records after a bad checksum, an unknown id or a cut are dropped
+  NinjaDepsLog log;
+  const unsigned out = log.addPath("a.o");
+  log.addDeps(out, {log.addPath("a.cpp"), log.addPath("a.h")});
+  const string good = log.data();
+
+  log.addDeps(out, {0, 99});
+  CompactGraph graph;
+  set<string> expected = {"a.cpp:a.h"};
+  ASSERT_TRUE(parse(log.data(), graph));
+  EXPECT_EQ(expected, getEdges(graph));
+
+  log.data() = good;
+  log.addPath("b.h");
+  log.data()[log.data().size() - 1] ^= 1;
+  ASSERT_TRUE(parse(log.data() + "\x05", graph));
+  EXPECT_EQ(expected, getEdges(graph));
+
+  // Not a deps log, unsupported version
+  EXPECT_FALSE(parse("# ninja log v5\n", graph));
+  NinjaDepsLog newLog(5);
+  EXPECT_FALSE(parse(newLog.data(), graph));
+}
+
+TEST_F(NinjaDepsLoaderTest, TestLoad)
+{
+  static const char* DIR = "test/_ninja_build";
+  static const char* LOG_FILE = "test/_ninja_build/.ninja_deps";
+  NinjaDepsLog log;
+  const unsigned out = log.addPath("a.o");
+  log.addDeps(out, {log.addPath("a.cpp"), log.addPath("a.h")});
+  mkdir(DIR, 0755);
+  std::ofstream(LOG_FILE, std::ios::binary) << log.data();
+
+  CompactGraph graph;
+  EXPECT_TRUE(NinjaDepsLoader::load(DIR, graph));
+  set<string> expected = {"a.cpp:a.h"};
+  EXPECT_EQ(expected, getEdges(graph));
+  EXPECT_TRUE(NinjaDepsLoader::load(LOG_FILE, graph));
+  EXPECT_EQ(expected, getEdges(graph));
+
+  remove(LOG_FILE);
+  rmdir(DIR);
+  EXPECT_FALSE(NinjaDepsLoader::load(DIR, graph));
+}
@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "ParseCost.h"
+#include <fstream>
+
+class ParseCostTest: public ::testing::Test
+{
+protected:
+  static bool parse(const string& content, ParseCost::CostMap& costs)
+  {
+    return ParseCost::parse(content.data(), content.size(), costs);
+  }
+
+  static string event(const char* phase, unsigned ts, unsigned dur, const string& detail,
+                      const char* name = "Source")
+  {
+    return string("{\"pid\":1,\"tid\":1,\"ph\":\"") + phase + "\",\"ts\":" + std::to_string(ts)
+        + (dur ? ",\"dur\":" + std::to_string(dur) : string()) + ",\"name\":\"" + name + "\""
+        + (detail.empty() ? string() : ",\"args\":{\"detail\":\"" + detail + "\"}") + "}";
+  }
+};
+
+TEST_F(ParseCostTest, TestCompleteEvents)
+{
+  // a.h includes b.h & c.h, other events inside don't count as includes
+  const string trace = "{\"traceEvents\":[" + event("X", 100, 1000, "/inc/a.h") + ","
+      + event("X", 200, 300, "/inc/b.h") + "," + event("X", 250, 10, "Foo", "ParseClass") + ","
+      + event("X", 600, 100, "/inc/c.h") + "," + event("X", 0, 5000, "", "Total Source") + ","
+      + event("X", 2000, 400, "/inc/c.h") + "],\n \"beginningOfTime\": 1700000000}";
+
+  ParseCost::CostMap costs;
+  ASSERT_TRUE(parse(trace, costs));
+  ASSERT_EQ(3u, costs.size());
+  EXPECT_EQ(1000u, costs["/inc/a.h"].inclusiveUs);
+  EXPECT_EQ(600u, costs["/inc/a.h"].exclusiveUs);
+  EXPECT_EQ(300u, costs["/inc/b.h"].exclusiveUs);
+  EXPECT_EQ(500u, costs["/inc/c.h"].inclusiveUs);
+  EXPECT_EQ(2u, costs["/inc/c.h"].parseCount);
+
+  // A second TU adds up
+  ASSERT_TRUE(parse(trace, costs));
+  EXPECT_EQ(2000u, costs["/inc/a.h"].inclusiveUs);
+  EXPECT_EQ(2u, costs["/inc/a.h"].parseCount);
+}
+
+TEST_F(ParseCostTest, TestAsyncEvents)
+{
+  // Begin & end events of newer clang, only begins carry the path
+  const string trace = "{\"traceEvents\":[" + event("b", 10, 0, "a.h") + ","
+      + event("b", 20, 0, "b.h") + "," + event("e", 120, 0, "") + ","
+      + event("e", 510, 0, "") + "," + event("b", 600, 0, "open.h") + "]}";
+
+  ParseCost::CostMap costs;
+  ASSERT_TRUE(parse(trace, costs));
+  ASSERT_EQ(2u, costs.size());
+  EXPECT_EQ(500u, costs["a.h"].inclusiveUs);
+  EXPECT_EQ(400u, costs["a.h"].exclusiveUs);
+  EXPECT_EQ(100u, costs["b.h"].inclusiveUs);
+}
+
+TEST_F(ParseCostTest, TestJson)
+{
+  // Escaped paths, nested values of unknown keys, blanks
+  const string trace = "{ \"other\": [1, {\"x\": [true, null, -1.5e3]}, \"]\"],\n"
+      "  \"traceEvents\": [ " + event("X", 1, 7, "C:\\\\inc\\\\caf\\u00e9.h") + " ] }";
+  ParseCost::CostMap costs;
+  ASSERT_TRUE(parse(trace, costs));
+  ASSERT_EQ(1u, costs.size());
+  EXPECT_EQ("C:\\inc\\caf\xc3\xa9.h", costs.begin()->first);
+
+  // Not traces: no traceEvents, an array, cut short, too deep
+  EXPECT_FALSE(parse("{\"beginningOfTime\": 1}", costs));
+  EXPECT_FALSE(parse("[{\"file\": \"a.cpp\"}]", costs));
+  EXPECT_FALSE(parse(trace.substr(0, trace.size() - 10), costs));
+  EXPECT_FALSE(parse("{\"traceEvents\":[], \"x\":" + string(100, '[') + string(100, ']') + "}",
+                     costs));
+  EXPECT_FALSE(parse("", costs));
+}
+
+TEST_F(ParseCostTest, TestNodeCosts)
+{
+  Graph headerGraph;
+  Node node("a.h");
+  node.childNodes.insert("b.h");
+  headerGraph.insert(node);
+  headerGraph.insert(Node("b.h"));
+  CompactGraph graph(headerGraph);
+
+  // Paths fall back to basenames, same basenames add up
+  ParseCost::CostMap costs;
+  costs["/x/a.h"].inclusiveUs = 10;
+  costs["/y/a.h"].inclusiveUs = 5;
+  costs["b.h"].parseCount = 3;
+  costs["/usr/include/stdio.h"].parseCount = 1;
+
+  vector<ParseCost::Cost> nodeCosts;
+  EXPECT_EQ(1u, ParseCost::getNodeCosts(graph, costs, nodeCosts));
+  unsigned id;
+  ASSERT_TRUE(graph.findId("a.h", id));
+  EXPECT_EQ(15u, nodeCosts[id].inclusiveUs);
+  ASSERT_TRUE(graph.findId("b.h", id));
+  EXPECT_EQ(3u, nodeCosts[id].parseCount);
+}
+
+TEST_F(ParseCostTest, TestLoad)
+{
+  static const char* FILES[] = {"test/_trace_1.json", "test/_trace_2.json", "test/_not_trace.json"};
+  std::ofstream(FILES[0]) << "{\"traceEvents\":[" << event("X", 0, 100, "a.h") << "]}";
+  std::ofstream(FILES[1]) << "{\"traceEvents\":[" << event("X", 0, 50, "a.h") << "]}";
+  std::ofstream(FILES[2]) << "[]";
+
+  ParseCost::CostMap costs;
+  vector<string> paths(FILES, FILES + 3);
+  paths.push_back("test/_no_such_trace.json");
+  EXPECT_EQ(2u, ParseCost::load(paths, costs));
+  EXPECT_EQ(150u, costs["a.h"].inclusiveUs);
+  EXPECT_EQ(2u, costs["a.h"].parseCount);
+
+  for (const char* file : FILES)
+  {
+    remove(file);
+  }
+}
@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "PathCache.h"
+#include <unistd.h>
+
+class PathCacheTest: public ::testing::Test
+{
+protected:
+  void TearDown()
+  {
+    unlink(LINK_PATH);
+  }
+
+  static constexpr const char* LINK_PATH = "test/_pathcache_link";
+};
+
+TEST_F(PathCacheTest, TestIdentify)
+{
+  PathCache::FileId dirId, fileId, linkId;
+  PathCache::Kind kind;
+  ASSERT_TRUE(PathCache::identify("test/asset", dirId, kind));
+  EXPECT_EQ(PathCache::KIND_DIR, kind);
+  ASSERT_TRUE(PathCache::identify("test/asset/has-header-no-include/file1.hpp", fileId, kind));
+  EXPECT_EQ(PathCache::KIND_FILE, kind);
+  EXPECT_FALSE(PathCache::identify("test/asset/not-exist", fileId, kind));
+
+  // A symlink is the dir it points at
+  ASSERT_EQ(0, symlink("asset", LINK_PATH));
+  ASSERT_TRUE(PathCache::identify(LINK_PATH, linkId, kind));
+  EXPECT_EQ(PathCache::KIND_DIR, kind);
+  EXPECT_FALSE(dirId < linkId || linkId < dirId);
+}
+
+TEST_F(PathCacheTest, TestVisited)
+{
+  PathCache cache;
+  PathCache::FileId id, linkId;
+  PathCache::Kind kind;
+  ASSERT_TRUE(PathCache::identify("test/asset", id, kind));
+  ASSERT_EQ(0, symlink("asset", LINK_PATH));
+  ASSERT_TRUE(PathCache::identify(LINK_PATH, linkId, kind));
+
+  EXPECT_EQ(nullptr, cache.findVisited(id));
+  EXPECT_TRUE(cache.markVisited(id, "test/asset"));
+  EXPECT_FALSE(cache.markVisited(linkId, LINK_PATH));
+  ASSERT_NE(nullptr, cache.findVisited(linkId));
+  EXPECT_EQ("test/asset", *cache.findVisited(linkId));
+
+  cache.clear();
+  EXPECT_EQ(nullptr, cache.findVisited(id));
+}
+
+TEST_F(PathCacheTest, TestCanonicalize)
+{
+  PathCache cache;
+  string expected, output;
+  ASSERT_TRUE(Common::canonicalize("test/asset", expected));
+  ASSERT_EQ(0, symlink("asset", LINK_PATH));
+  ASSERT_TRUE(cache.canonicalize(LINK_PATH, output));
+  EXPECT_EQ(expected, output);
+
+  // Memoized, even after the link is gone
+  unlink(LINK_PATH);
+  output.clear();
+  ASSERT_TRUE(cache.canonicalize(LINK_PATH, output));
+  EXPECT_EQ(expected, output);
+
+  output = "untouched";
+  EXPECT_FALSE(cache.canonicalize("test/asset/not-exist", output));
+  EXPECT_FALSE(cache.canonicalize("test/asset/not-exist", output));
+  EXPECT_EQ("untouched", output);
+}
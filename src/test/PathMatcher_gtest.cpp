@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "PathMatcher.h"
+
+TEST(PathMatcherTest, TestIsPattern)
+{
+  EXPECT_TRUE(PathMatcher::isPattern("third_party/**"));
+  EXPECT_TRUE(PathMatcher::isPattern("file?.h"));
+  EXPECT_TRUE(PathMatcher::isPattern("[ab].h"));
+  EXPECT_FALSE(PathMatcher::isPattern("stdio.h"));
+  EXPECT_FALSE(PathMatcher::isPattern("/usr/include"));
+}
+
+TEST(PathMatcherTest, TestMatch)
+{
+  PathMatcher matcher;
+  EXPECT_TRUE(matcher.empty());
+  EXPECT_FALSE(matcher.add(""));
+  EXPECT_FALSE(matcher.add("./"));
+  ASSERT_TRUE(matcher.add("third_party/**"));
+  ASSERT_TRUE(matcher.add("*_generated.h"));
+  ASSERT_TRUE(matcher.add("**/test/**"));
+  ASSERT_TRUE(matcher.add("src/*/internal/[a-c]?.h"));
+  EXPECT_FALSE(matcher.empty());
+
+  EXPECT_TRUE(matcher.match("third_party"));
+  EXPECT_TRUE(matcher.match("third_party/zlib/zlib.h"));
+  EXPECT_TRUE(matcher.match("./third_party/x.h"));
+  EXPECT_FALSE(matcher.match("src/third_party/x.h"));
+
+  EXPECT_TRUE(matcher.match("proto_generated.h"));
+  EXPECT_TRUE(matcher.match("a/b/proto_generated.h"));
+  EXPECT_FALSE(matcher.match("a/b/proto_generated.hpp"));
+
+  EXPECT_TRUE(matcher.match("test/a.h"));
+  EXPECT_TRUE(matcher.match("lib/x/test/a.h"));
+  EXPECT_FALSE(matcher.match("lib/x/tests/a.h"));
+
+  EXPECT_TRUE(matcher.match("src/core/internal/a1.h"));
+  EXPECT_TRUE(matcher.match("src/io/internal/cz.h"));
+  EXPECT_FALSE(matcher.match("src/io/internal/d1.h"));
+  EXPECT_FALSE(matcher.match("src/io/internal/a12.h"));
+  EXPECT_FALSE(matcher.match("src/internal/a1.h"));
+  EXPECT_FALSE(matcher.match(""));
+}
+
+TEST(PathMatcherTest, TestSegmentGlobs)
+{
+  PathMatcher matcher;
+  ASSERT_TRUE(matcher.add("a*b*c"));
+  ASSERT_TRUE(matcher.add("[!x]y"));
+  ASSERT_TRUE(matcher.add("[z"));
+
+  EXPECT_TRUE(matcher.match("abc"));
+  EXPECT_TRUE(matcher.match("aXXbYYbc"));
+  EXPECT_FALSE(matcher.match("aXXbYYbcd"));
+  EXPECT_TRUE(matcher.match("ay"));
+  EXPECT_FALSE(matcher.match("xy"));
+  EXPECT_TRUE(matcher.match("[z"));
+}
+
+TEST(PathMatcherTest, TestStep)
+{
+  PathMatcher matcher;
+  ASSERT_TRUE(matcher.add("vendor/**"));
+  ASSERT_TRUE(matcher.add("src/gen/*.h"));
+
+  PathMatcher::State root, src, gen, next;
+  matcher.start(root);
+  EXPECT_TRUE(matcher.step(root, "vendor", next));
+
+  // Nothing can match under lib, its state dies out
+  EXPECT_FALSE(matcher.step(root, "lib", next));
+  EXPECT_TRUE(next.empty());
+
+  EXPECT_FALSE(matcher.step(root, "src", src));
+  EXPECT_FALSE(matcher.step(src, "gen", gen));
+  EXPECT_TRUE(matcher.step(gen, "a.h", next));
+  EXPECT_FALSE(matcher.step(gen, "a.cpp", next));
+}
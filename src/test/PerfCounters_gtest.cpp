@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "PerfCounters.h"
+#include "RunStats.h"
+
+// Counters are often not allowed in containers & CI, both ways must work
+TEST(PerfCountersTest, TestReadOrDegrade)
+{
+  PerfCounters counters;
+  uint64_t before[PerfCounters::COUNTER_COUNT], after[PerfCounters::COUNTER_COUNT];
+  const bool isOpen = counters.open();
+  EXPECT_EQ(isOpen, counters.isOpen());
+  counters.read(before);
+
+  volatile uint64_t sink = 0;
+  for (unsigned i = 0; i < 1000000; ++i)
+  {
+    sink += i;
+  }
+  counters.read(after);
+
+  for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter)
+  {
+    if (!counters.isAvailable((PerfCounters::Counter) counter))
+    {
+      EXPECT_EQ(0u, before[counter]);
+      EXPECT_EQ(0u, after[counter]);
+    }
+    else
+    {
+      EXPECT_LE(before[counter], after[counter]);
+    }
+  }
+
+  if (counters.isAvailable(PerfCounters::COUNTER_INSTRUCTIONS))
+  {
+    EXPECT_GT(after[PerfCounters::COUNTER_INSTRUCTIONS] - before[PerfCounters::COUNTER_INSTRUCTIONS],
+              1000000u);
+  }
+
+  counters.close();
+  EXPECT_FALSE(counters.isOpen());
+}
+
+TEST(PerfCountersTest, TestRunStatsColumns)
+{
+  RunStats stats;
+  const bool hasCounters = stats.openCounters();
+  stats.enter(RunStats::PHASE_SCC);
+
+  std::ostringstream json;
+  stats.printJson(json);
+  EXPECT_EQ(hasCounters, string::npos != json.str().find("\"cycles\":")
+                         || string::npos != json.str().find("\"instructions\":"));
+
+  std::ostringstream table;
+  stats.print(table);
+  EXPECT_EQ(hasCounters, string::npos != table.str().find("IPC"));
+}
@@ -23,6 +23,8 @@
  */
 #include "gtest/gtest.h"
 #include "ProjectParser.h"
+#include <sys/stat.h>
+#include <unistd.h>
 
 class ProjParserTest: public ::testing::Test
 {
@@ -33,6 +35,7 @@ protected:
     mNoHeaderDir = mAssetDirPath + "/no-header";
     mHasHeaderDir = mAssetDirPath + "/has-header-no-include";
     mHasHeaderWithIncludeDir = mAssetDirPath + "/has-header-with-include";
+    mHasSourceWithIncludeDir = mAssetDirPath + "/has-source-with-include";
   }
 
   void TearDown()
@@ -41,6 +44,7 @@ protected:
   }
 
   string mAssetDirPath, mNoHeaderDir, mHasHeaderDir, mHasHeaderWithIncludeDir;
+  string mHasSourceWithIncludeDir;
 };
 
 TEST_F(ProjParserTest, testNoHeaderDir)
@@ -84,3 +88,201 @@ TEST_F(ProjParserTest, testHasHeaderWithIncludeDir)
   ASSERT_EQ(0, ProjectParser::parse(allDirs, excludeFiles, graph, detailGraph, locationMap));
   ASSERT_EQ(6, graph.size());
 }
+
+TEST_F(ProjParserTest, testScanSources)
+{
+  set<string> allDirs = {mHasSourceWithIncludeDir};
+  set<string> excludeFiles = {"stdio.h"};
+  Graph graph, detailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+
+  ASSERT_EQ(0, ProjectParser::parse(allDirs, excludeFiles, graph, detailGraph, locationMap));
+  ASSERT_EQ(2, graph.size());
+
+  // Source files are keyed by path so both main.cpp stay apart
+  ASSERT_EQ(0, ProjectParser::parse(allDirs, excludeFiles, graph, detailGraph, locationMap, true));
+  ASSERT_EQ(5, graph.size());
+  EXPECT_EQ(2, locationMap.size());
+
+  auto mainIt = graph.find(Node(mHasSourceWithIncludeDir + "/sub/main.cpp"));
+  ASSERT_NE(graph.end(), mainIt);
+  EXPECT_EQ(set<string>({"a.hpp"}), mainIt->childNodes);
+}
+
+TEST_F(ProjParserTest, testExcludedPaths)
+{
+  set<string> allDirs = {mHasHeaderDir};
+  Graph graph, detailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+
+  // other-dir holds 1file1.hpp & 1file2.hpp
+  PathMatcher excludedPaths;
+  ASSERT_TRUE(excludedPaths.add("other-dir/**"));
+  ASSERT_EQ(0, ProjectParser::parse(allDirs, {}, graph, detailGraph, locationMap, false, nullptr,
+                                    &excludedPaths));
+  EXPECT_EQ(4, graph.size());
+  EXPECT_EQ(locationMap.end(), locationMap.find("1file1.hpp"));
+
+  ASSERT_TRUE(excludedPaths.add("*2.hpp"));
+  ASSERT_EQ(0, ProjectParser::parse(allDirs, {}, graph, detailGraph, locationMap, false, nullptr,
+                                    &excludedPaths));
+  EXPECT_EQ(3, graph.size());
+  EXPECT_EQ(locationMap.end(), locationMap.find("file2.hpp"));
+}
+
+TEST_F(ProjParserTest, testScanCache)
+{
+  set<string> allDirs = {mHasHeaderWithIncludeDir};
+  Graph graph, detailGraph, cachedGraph, cachedDetailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+  ProjectParser::ScanCache scanCache;
+  ASSERT_LE(0, ProjectParser::parse(allDirs, {}, graph, detailGraph, locationMap));
+  ASSERT_LE(0, ProjectParser::parse(allDirs, {}, cachedGraph, cachedDetailGraph, locationMap,
+                                    false, nullptr, nullptr, &scanCache));
+  const size_t missCount = scanCache.getMissCount();
+  EXPECT_EQ(detailGraph.size(), missCount);
+  EXPECT_EQ(0, scanCache.getHitCount());
+
+  // Second parse reads nothing, exclusions still apply per parse
+  cachedGraph.clear();
+  cachedDetailGraph.clear();
+  ASSERT_LE(0, ProjectParser::parse(allDirs, {}, cachedGraph, cachedDetailGraph, locationMap,
+                                    false, nullptr, nullptr, &scanCache));
+  EXPECT_EQ(missCount, scanCache.getMissCount());
+  EXPECT_EQ(missCount, scanCache.getHitCount());
+  ASSERT_EQ(graph.size(), cachedGraph.size());
+  for (const Node& node : graph)
+  {
+    const auto cachedIt = cachedGraph.find(node);
+    ASSERT_NE(cachedGraph.end(), cachedIt);
+    EXPECT_EQ(node.childNodes, cachedIt->childNodes);
+  }
+
+  ProjectParser::ScannedFile scanned;
+  EXPECT_FALSE(ProjectParser::scanFile(mAssetDirPath + "/not-exist.h", scanned));
+}
+
+TEST_F(ProjParserTest, testLinkedTreesScannedOnce)
+{
+  // real/a.h & real/b.h with an alias dir, a symlink cycle, a same named
+  // hard link and one under a new name
+  const string root = "test/_linked_tree";
+  ASSERT_EQ(0, mkdir(root.c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/real").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/other").c_str(), 0755));
+  FILE* file = fopen((root + "/real/a.h").c_str(), "w");
+  ASSERT_NE(nullptr, file);
+  fputs("#include \"b.h\"\n", file);
+  fclose(file);
+  file = fopen((root + "/real/b.h").c_str(), "w");
+  ASSERT_NE(nullptr, file);
+  fputs("#include \"a.h\"\n", file);
+  fclose(file);
+  ASSERT_EQ(0, symlink("real", (root + "/alias").c_str()));
+  ASSERT_EQ(0, symlink("..", (root + "/real/loop").c_str()));
+  ASSERT_EQ(0, link((root + "/real/a.h").c_str(), (root + "/other/a.h").c_str()));
+  ASSERT_EQ(0, link((root + "/real/b.h").c_str(), (root + "/other/c.h").c_str()));
+
+  Graph graph, detailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+  EXPECT_EQ(0, ProjectParser::parse({root, root + "/alias"}, {}, graph, detailGraph, locationMap));
+  EXPECT_EQ(3, graph.size());
+  ASSERT_EQ(3, locationMap.size());
+  EXPECT_EQ(1, locationMap["a.h"].size());
+  EXPECT_EQ(1, locationMap["b.h"].size());
+  EXPECT_EQ(1, locationMap["c.h"].size());
+
+  // Reported under the canonical path, even when only reached via alias
+  const set<string> realPathB = {Common::getRealPath(root + "/real/b.h")};
+  EXPECT_EQ(realPathB, locationMap["b.h"]);
+  EXPECT_EQ(0, ProjectParser::parse({root + "/alias"}, {}, graph, detailGraph, locationMap));
+  EXPECT_EQ(realPathB, locationMap["b.h"]);
+  EXPECT_EQ(1, detailGraph.count(Node(*realPathB.begin())));
+
+  // Exclude lists keep every path, only the cycle through loop is cut
+  set<string> headerFiles;
+  EXPECT_EQ(0, ProjectParser::generateHeaderList({root}, headerFiles));
+  EXPECT_EQ(set<string>({"alias/a.h", "alias/b.h", "other/a.h", "other/c.h", "real/a.h",
+                         "real/b.h"}), headerFiles);
+
+  for (const char* path : {"/other/c.h", "/other/a.h", "/real/loop", "/alias", "/real/b.h",
+                           "/real/a.h", "/other", "/real", ""})
+  {
+    remove((root + path).c_str());
+  }
+}
+
+TEST_F(ProjParserTest, testNestedCanonicalPaths)
+{
+  // Plain subdirs extend the parent's canonical path, a link below the
+  // root is resolved on its own
+  const string root = "test/_nested_canonical";
+  ASSERT_EQ(0, mkdir(root.c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/real").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/real/sub").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/proj").c_str(), 0755));
+  FILE* file = fopen((root + "/real/sub/x.h").c_str(), "w");
+  ASSERT_NE(nullptr, file);
+  fclose(file);
+  ASSERT_EQ(0, symlink("../real", (root + "/proj/link").c_str()));
+
+  const set<string> realPathX = {Common::getRealPath(root + "/real/sub/x.h")};
+  Graph graph, detailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+  EXPECT_EQ(0, ProjectParser::parse({root + "/./real"}, {}, graph, detailGraph, locationMap));
+  EXPECT_EQ(realPathX, locationMap["x.h"]);
+  EXPECT_EQ(0, ProjectParser::parse({root + "/proj"}, {}, graph, detailGraph, locationMap));
+  EXPECT_EQ(realPathX, locationMap["x.h"]);
+  EXPECT_EQ(1, detailGraph.count(Node(*realPathX.begin())));
+
+  for (const char* path : {"/proj/link", "/proj", "/real/sub/x.h", "/real/sub", "/real", ""})
+  {
+    remove((root + path).c_str());
+  }
+}
+
+TEST_F(ProjParserTest, testAliasedExcludeDir)
+{
+  // sys/alias -> sys/real, a project header includes real/foo.h while
+  // another project header is named foo.h
+  const string root = "test/_aliased_exclude";
+  ASSERT_EQ(0, mkdir(root.c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/sys").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/sys/real").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/proj").c_str(), 0755));
+  ASSERT_EQ(0, symlink("real", (root + "/sys/alias").c_str()));
+  const std::pair<const char*, const char*> files[] =
+  {
+    {"/sys/real/foo.h", ""},
+    {"/proj/a.h", "#include \"real/foo.h\"\n"},
+    {"/proj/b.h", "#include \"alias/foo.h\"\n"},
+    {"/proj/foo.h", "#include \"a.h\"\n#include \"b.h\"\n"}
+  };
+  for (const auto& item : files)
+  {
+    FILE* file = fopen((root + item.first).c_str(), "w");
+    ASSERT_NE(nullptr, file);
+    fputs(item.second, file);
+    fclose(file);
+  }
+
+  set<string> excludedFiles;
+  EXPECT_EQ(0, ProjectParser::generateHeaderList({root + "/sys"}, excludedFiles));
+  EXPECT_EQ(set<string>({"alias/foo.h", "real/foo.h"}), excludedFiles);
+
+  // Neither spelling makes an edge to the project foo.h
+  Graph graph, detailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+  EXPECT_EQ(0, ProjectParser::parse({root + "/proj"}, excludedFiles, graph, detailGraph,
+                                    locationMap));
+  for (const Node& node : graph)
+  {
+    EXPECT_EQ(node.id == "foo.h" ? 2u : 0u, node.childNodes.size()) << node.id;
+  }
+
+  for (const char* path : {"/proj/foo.h", "/proj/b.h", "/proj/a.h", "/sys/real/foo.h",
+                           "/sys/alias", "/proj", "/sys/real", "/sys", ""})
+  {
+    remove((root + path).c_str());
+  }
+}
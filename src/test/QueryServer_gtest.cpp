@@ -0,0 +1,199 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "QueryServer.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <thread>
+
+class QueryServerTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    // a -> b -> c -> a, d -> a
+    const vector<std::pair<string, set<string> > > edges = {
+      {"a.h", {"b.h"}}, {"b.h", {"c.h"}}, {"c.h", {"a.h"}}, {"d.h", {"a.h"}}};
+    Graph input;
+    for (const auto& edge : edges)
+    {
+      Node node(edge.first);
+      node.childNodes = edge.second;
+      input.insert(node);
+    }
+    mGraph.assign(input);
+  }
+
+  void TearDown()
+  {
+    unlink(SOCKET_PATH);
+  }
+
+  QueryServer::Response ask(QueryServer::Op op, const vector<string>& args)
+  {
+    string request;
+    QueryServer::encodeRequest(op, args, request);
+    QueryServer::Response response;
+    mServer->answer(request, response);
+    return response;
+  }
+
+  static constexpr const char* SOCKET_PATH = "test/_query_server.sock";
+  CompactGraph mGraph;
+  std::unique_ptr<QueryServer> mServer;
+};
+
+TEST_F(QueryServerTest, TestAnswer)
+{
+  mServer.reset(new QueryServer(mGraph));
+  ASSERT_TRUE(mServer->prepare());
+
+  QueryServer::Response response = ask(QueryServer::OP_CYCLES, {});
+  EXPECT_EQ(QueryServer::STATUS_OK, response.status);
+  ASSERT_EQ(1, response.records.size());
+  EXPECT_EQ(vector<string>({"a.h", "b.h", "c.h"}), response.records[0]);
+
+  response = ask(QueryServer::OP_IMPACT, {"c.h"});
+  ASSERT_EQ(1, response.records.size());
+  EXPECT_EQ(4, response.records[0].size());
+
+  response = ask(QueryServer::OP_CLOSURE, {"d.h"});
+  ASSERT_EQ(1, response.records.size());
+  EXPECT_EQ(3, response.records[0].size());
+
+  response = ask(QueryServer::OP_CHAIN, {"d.h", "c.h"});
+  ASSERT_EQ(1, response.records.size());
+  EXPECT_EQ(vector<string>({"d.h", "a.h", "b.h", "c.h"}), response.records[0]);
+  EXPECT_EQ(QueryServer::STATUS_NOT_FOUND, ask(QueryServer::OP_CHAIN, {"a.h", "d.h"}).status);
+  EXPECT_EQ(QueryServer::STATUS_NOT_FOUND, ask(QueryServer::OP_CLOSURE, {"x.h"}).status);
+  EXPECT_EQ(QueryServer::STATUS_BAD_REQUEST, ask(QueryServer::OP_CHAIN, {"a.h"}).status);
+  EXPECT_EQ(QueryServer::STATUS_BAD_REQUEST, ask((QueryServer::Op)99, {}).status);
+
+  QueryServer::Response badResponse;
+  mServer->answer(string("\x03" "a.h", 4), badResponse);
+  EXPECT_EQ(QueryServer::STATUS_BAD_REQUEST, badResponse.status);
+
+  response = ask(QueryServer::OP_STATS, {});
+  ASSERT_EQ(1, response.records.size());
+  EXPECT_EQ("headers=4", response.records[0][0]);
+}
+
+TEST_F(QueryServerTest, TestEncoding)
+{
+  QueryServer::Response response, decoded;
+  response.status = QueryServer::STATUS_NOT_FOUND;
+  response.records = {{"a", ""}, {}, {"bc"}};
+  string payload;
+  QueryServer::encodeResponse(response, payload);
+  ASSERT_TRUE(QueryServer::decodeResponse(payload, decoded));
+  EXPECT_EQ(response.status, decoded.status);
+  EXPECT_EQ(response.records, decoded.records);
+
+  EXPECT_FALSE(QueryServer::decodeResponse(payload.substr(0, payload.size() - 1), decoded));
+  EXPECT_FALSE(QueryServer::decodeResponse(payload + "x", decoded));
+  EXPECT_FALSE(QueryServer::decodeResponse("", decoded));
+}
+
+TEST_F(QueryServerTest, TestSocket)
+{
+  mServer.reset(new QueryServer(mGraph));
+  ASSERT_TRUE(mServer->prepare());
+  ASSERT_TRUE(mServer->listen(SOCKET_PATH));
+  std::thread serveThread([this]() { mServer->serve(); });
+
+  // Clients in parallel, each on its own connection
+  vector<std::thread> clients;
+  std::atomic<int> answerCount(0);
+  for (int i = 0; i < 4; ++i)
+  {
+    clients.push_back(std::thread([&answerCount]()
+    {
+      QueryServer::Response response;
+      if (QueryServer::ask(SOCKET_PATH, QueryServer::OP_CHAIN, {"d.h", "c.h"}, response)
+          && response.records.size() == 1 && response.records[0].size() == 4)
+      {
+        ++answerCount;
+      }
+    }));
+  }
+  for (auto& client : clients)
+  {
+    client.join();
+  }
+  EXPECT_EQ(4, answerCount);
+
+  // A second server doesn't take over a live socket
+  QueryServer other(mGraph);
+  EXPECT_FALSE(other.listen(SOCKET_PATH));
+
+  mServer->stop();
+  serveThread.join();
+  mServer.reset();
+  QueryServer::Response response;
+  EXPECT_FALSE(QueryServer::ask(SOCKET_PATH, QueryServer::OP_STATS, {}, response));
+}
+
+TEST_F(QueryServerTest, TestStopWithChurn)
+{
+  mServer.reset(new QueryServer(mGraph));
+  ASSERT_TRUE(mServer->prepare());
+  ASSERT_TRUE(mServer->listen(SOCKET_PATH));
+  std::thread serveThread([this]() { mServer->serve(); });
+
+  // An idle connection blocks its thread on read until stop shuts it down
+  const int idleFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_LE(0, idleFd);
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, SOCKET_PATH, sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, connect(idleFd, (const struct sockaddr*) &address, sizeof(address)));
+
+  // Short connections reuse fd numbers while others close
+  std::atomic<int> answerCount(0);
+  vector<std::thread> clients;
+  for (int i = 0; i < 4; ++i)
+  {
+    clients.push_back(std::thread([&answerCount]()
+    {
+      for (int j = 0; j < 50; ++j)
+      {
+        QueryServer::Response response;
+        answerCount += QueryServer::ask(SOCKET_PATH, QueryServer::OP_STATS, {}, response);
+      }
+    }));
+  }
+  for (auto& client : clients)
+  {
+    client.join();
+  }
+  EXPECT_EQ(200, answerCount);
+
+  mServer->stop();
+  serveThread.join();
+  mServer.reset();
+  char byte;
+  EXPECT_EQ(0, read(idleFd, &byte, 1));
+  close(idleFd);
+}
@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "ReachabilityIndex.h"
+
+class ReachabilityTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    // a->b->c->a  c->d->e  f->e
+    addEdge("a", "b");
+    addEdge("b", "c");
+    addEdge("c", "a");
+    addEdge("c", "d");
+    addEdge("d", "e");
+    addEdge("f", "e");
+  }
+
+  void TearDown()
+  {
+    Common::setDebugMode(false);
+  }
+
+  void addEdge(const string& from, const string& to)
+  {
+    Node node(from);
+    auto found = mGraph.find(node);
+    if (found != mGraph.end())
+    {
+      node = *found;
+      mGraph.erase(found);
+    }
+    node.childNodes.insert(to);
+    mGraph.insert(node);
+  }
+
+  unsigned id(const CompactGraph& graph, const string& name)
+  {
+    unsigned retVal = 0;
+    EXPECT_TRUE(graph.findId(name, retVal));
+    return retVal;
+  }
+
+  Graph mGraph;
+};
+
+TEST_F(ReachabilityTest, TestCondensation)
+{
+  CompactGraph graph(mGraph);
+  ASSERT_EQ(6, graph.size());
+  ASSERT_EQ(6, graph.edgeCount());
+
+  Condensation dag(graph);
+  ASSERT_TRUE(dag.solve());
+  EXPECT_EQ(4, dag.componentCount());
+
+  const unsigned abc = dag.componentOf(id(graph, "a"));
+  EXPECT_TRUE(dag.isCyclic(abc));
+  EXPECT_EQ(3, dag.memberCount(abc));
+  EXPECT_EQ(abc, dag.componentOf(id(graph, "c")));
+  EXPECT_FALSE(dag.isCyclic(dag.componentOf(id(graph, "e"))));
+  EXPECT_EQ(2, dag.height(abc));
+}
+
+TEST_F(ReachabilityTest, TestReaches)
+{
+  CompactGraph graph(mGraph);
+  Condensation dag(graph);
+  ASSERT_TRUE(dag.solve());
+  ReachabilityIndex index(dag);
+  ASSERT_TRUE(index.build());
+
+  EXPECT_TRUE(index.reaches(id(graph, "a"), id(graph, "e")));
+  EXPECT_TRUE(index.reaches(id(graph, "a"), id(graph, "a")));
+  EXPECT_TRUE(index.reaches(id(graph, "c"), id(graph, "b")));
+  EXPECT_TRUE(index.reaches(id(graph, "f"), id(graph, "e")));
+  EXPECT_FALSE(index.reaches(id(graph, "e"), id(graph, "e")));
+  EXPECT_FALSE(index.reaches(id(graph, "d"), id(graph, "a")));
+  EXPECT_FALSE(index.reaches(id(graph, "f"), id(graph, "d")));
+
+  vector<unsigned> closure;
+  index.getClosure(id(graph, "b"), closure);
+  EXPECT_EQ(5, closure.size());
+  index.getClosure(id(graph, "e"), closure);
+  EXPECT_EQ(0, closure.size());
+}
+
+TEST_F(ReachabilityTest, TestNoMemoryBudget)
+{
+  // Chain of 2000 nodes with a back edge, nothing fits so all
+  // queries walk the DAG
+  mGraph.clear();
+  for (int i = 0; i < 2000; ++i)
+  {
+    addEdge(std::to_string(i), std::to_string(i + 1));
+  }
+  addEdge("10", "5");
+
+  CompactGraph graph(mGraph);
+  Condensation dag(graph);
+  ASSERT_TRUE(dag.solve());
+  ReachabilityIndex fullIndex(dag), emptyIndex(dag, 0);
+  ASSERT_TRUE(fullIndex.build());
+  ASSERT_TRUE(emptyIndex.build());
+  EXPECT_EQ(1, emptyIndex.storedRowCount()); // only the empty sink row fits
+  EXPECT_EQ(dag.componentCount(), fullIndex.storedRowCount());
+
+  for (const char* from : {"0", "5", "7", "1999"})
+  {
+    for (const char* to : {"0", "6", "10", "11", "2000"})
+    {
+      EXPECT_EQ(fullIndex.reaches(id(graph, from), id(graph, to)),
+                emptyIndex.reaches(id(graph, from), id(graph, to))) << from << "->" << to;
+    }
+  }
+
+  vector<unsigned> fullClosure, emptyClosure;
+  fullIndex.getClosure(id(graph, "7"), fullClosure);
+  emptyIndex.getClosure(id(graph, "7"), emptyClosure);
+  EXPECT_EQ(1996, fullClosure.size());
+  EXPECT_EQ(fullClosure, emptyClosure);
+}
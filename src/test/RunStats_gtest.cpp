@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "RunStats.h"
+#include "ProjectParser.h"
+#include <chrono>
+
+class RunStatsTest: public ::testing::Test
+{
+protected:
+  /**
+   * Keep the CPU busy for ms milliseconds of wall time
+   */
+  static void spin(unsigned ms)
+  {
+    const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    volatile unsigned sink = 0;
+    while (std::chrono::steady_clock::now() < end)
+    {
+      ++sink;
+    }
+  }
+};
+
+TEST_F(RunStatsTest, TestPhases)
+{
+  RunStats stats;
+  stats.enter(RunStats::PHASE_SCAN);
+  spin(20);
+  stats.enter(RunStats::PHASE_MERGE);
+  stats.enter(RunStats::PHASE_SCAN);
+  spin(10);
+  stats.stop();
+  spin(10);
+
+  EXPECT_GE(stats.getWallTime(RunStats::PHASE_SCAN), 0.03);
+  EXPECT_LT(stats.getWallTime(RunStats::PHASE_SCAN), 0.5);
+  EXPECT_GT(stats.getCpuTime(RunStats::PHASE_SCAN), 0.0);
+  EXPECT_LT(stats.getWallTime(RunStats::PHASE_MERGE), 0.01);
+  EXPECT_EQ(0.0, stats.getWallTime(RunStats::PHASE_SCC));
+  EXPECT_GT(RunStats::getPeakRssKb(), 0u);
+}
+
+TEST_F(RunStatsTest, TestOutput)
+{
+  RunStats stats;
+  stats.fileCount = 3;
+  stats.byteCount = 300;
+  stats.includeCount = 7;
+  stats.nodeCount = 4;
+  stats.edgeCount = 5;
+  stats.enter(RunStats::PHASE_SCC);
+
+  std::ostringstream json;
+  stats.printJson(json);
+  const string text = json.str();
+  EXPECT_EQ(0u, text.find("{\"phases\":{\"scc\":{\"wall_sec\":"));
+  EXPECT_EQ(string::npos, text.find("\"scan\""));
+  EXPECT_NE(string::npos, text.find(",\"files\":3,\"bytes\":300,\"includes\":7,"));
+  EXPECT_NE(string::npos, text.find(",\"nodes\":4,\"edges\":5,\"peak_rss_kb\":"));
+  EXPECT_EQ("}\n", text.substr(text.size() - 2));
+
+  std::ostringstream table;
+  stats.print(table);
+  EXPECT_NE(string::npos, table.str().find("scc"));
+  EXPECT_NE(string::npos, table.str().find("files:    3"));
+}
+
+TEST_F(RunStatsTest, TestParserCounts)
+{
+  const set<string> dirs = {"test/asset/has-source-with-include"};
+  Graph graph, detailGraph;
+  ProjectParser::HeaderLocationMap locationMap;
+  RunStats stats;
+  ASSERT_EQ(0, ProjectParser::parse(dirs, {"stdio.h"}, graph, detailGraph, locationMap, true, &stats));
+  stats.stop();
+
+  uint64_t bytes = 0, includes = 0;
+  for (const Node& node : detailGraph)
+  {
+    bytes += Common::getFileSize(node.id);
+    includes += node.childNodes.size();
+  }
+  EXPECT_EQ(detailGraph.size(), stats.fileCount);
+  EXPECT_EQ(bytes, stats.byteCount);
+  EXPECT_LE(includes, stats.includeCount);
+  EXPECT_GT(stats.getWallTime(RunStats::PHASE_TRAVERSAL), 0.0);
+  EXPECT_GT(stats.getWallTime(RunStats::PHASE_SCAN), 0.0);
+  EXPECT_GT(stats.getWallTime(RunStats::PHASE_MERGE), 0.0);
+}
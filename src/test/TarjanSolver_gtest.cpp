@@ -171,3 +171,30 @@ TEST_F(SolverTest, TestComprehensive2)
   auto solution = solver.getSolution();
   EXPECT_EQ(4, solution.size());
 }
+
+TEST_F(SolverTest, TestStreaming)
+{
+  // 1<->2->3<->4->4 5
+  Node node1("1"), node2("2"), node3("3"), node4("4"), node5("5");
+  node1.childNodes.insert(node2.id);
+  node2.childNodes.insert(node1.id);
+  node2.childNodes.insert(node3.id);
+  node3.childNodes.insert(node4.id);
+  node4.childNodes.insert(node3.id);
+  node4.childNodes.insert(node4.id);
+
+  Graph graph = {node1, node2, node3, node4, node5};
+  TarjanSolver solver(graph);
+
+  set<set<string> > allSets, circles;
+  SccNameCollector allCollector(solver, allSets), circleCollector(solver, circles);
+  ASSERT_TRUE(solver.solve(allCollector, false));
+  ASSERT_TRUE(solver.solve(circleCollector));
+
+  EXPECT_EQ(3, allSets.size());
+  EXPECT_EQ(set<set<string> >({{"1", "2"}, {"3", "4"}}), circles);
+
+  // Legacy solution agrees
+  ASSERT_TRUE(solver.solve());
+  EXPECT_EQ(allSets, solver.getSolution());
+}
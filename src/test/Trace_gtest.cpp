@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "Trace.h"
+#include "Common.h"
+#include <fstream>
+#include <thread>
+
+class TraceTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    char path[] = "/tmp/spinclude-trace-XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_LE(0, fd);
+    close(fd);
+    mPath = path;
+  }
+
+  void TearDown()
+  {
+    remove(mPath.c_str());
+  }
+
+  string read() const
+  {
+    std::ifstream file(mPath.c_str());
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  static size_t count(const string& text, const string& pattern)
+  {
+    size_t retVal = 0;
+    for (size_t pos = text.find(pattern); pos != string::npos; pos = text.find(pattern, pos + 1))
+    {
+      ++retVal;
+    }
+    return retVal;
+  }
+
+  string mPath;
+};
+
+TEST_F(TraceTest, TestDisabled)
+{
+  ASSERT_TRUE(Trace::write(mPath));
+  EXPECT_FALSE(Trace::isEnabled());
+  {
+    Trace::Scope scope("ignored", "test");
+  }
+  Trace::record("ignored", "test", 0, 10);
+  ASSERT_TRUE(Trace::write(mPath));
+  EXPECT_EQ(0u, count(read(), "ignored"));
+}
+
+TEST_F(TraceTest, TestThreads)
+{
+  Trace::start();
+  ASSERT_TRUE(Trace::isEnabled());
+  {
+    Trace::Scope scope("outer", "test", "a \"quoted\"\\path\n");
+    Common::parallelFor(4000, 1000, [](size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        Trace::Scope scope("inner", "test");
+      }
+    });
+  }
+  {
+    // Too short to be kept
+    Trace::Scope scope("short", "test", nullptr, 1000000000ull);
+  }
+  Trace::record("manual", "test", 2000, 5500);
+  ASSERT_TRUE(Trace::write(mPath));
+  EXPECT_FALSE(Trace::isEnabled());
+
+  const string text = read();
+  EXPECT_EQ(0u, text.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+  EXPECT_EQ("\n]}\n", text.substr(text.size() - 4));
+  EXPECT_EQ(1u, count(text, "\"name\":\"main\""));
+  EXPECT_EQ(1u, count(text, "\"name\":\"outer\""));
+  EXPECT_EQ(1u, count(text, "\"detail\":\"a \\\"quoted\\\"\\\\path\\u000a\""));
+  EXPECT_EQ(4000u, count(text, "\"name\":\"inner\""));
+  EXPECT_EQ(0u, count(text, "\"name\":\"short\""));
+  // parallelFor itself records nothing, callers add their own scopes
+  EXPECT_EQ(0u, count(text, "\"cat\":\"worker\""));
+  EXPECT_EQ(1u, count(text, "\"name\":\"manual\",\"cat\":\"test\",\"ph\":\"X\",\"ts\":2.000,\"dur\":3.500"));
+
+  // Workers get their own tid when chunks run on threads
+  if (std::thread::hardware_concurrency() > 1)
+  {
+    EXPECT_LE(1u, count(text, "\"name\":\"worker "));
+  }
+}
@@ -0,0 +1,3 @@
+#include "a.hpp"
+
+int main() { return 0; }
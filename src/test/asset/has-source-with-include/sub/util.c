@@ -0,0 +1 @@
+#include "b.hpp"
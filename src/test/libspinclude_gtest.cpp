@@ -0,0 +1,156 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 Dat
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gtest/gtest.h"
+#include "libspinclude.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+namespace
+{
+  struct AllocCount
+  {
+    int allocs;
+    int frees;
+  };
+
+  void* counting_alloc(void* context, size_t size)
+  {
+    ++static_cast<AllocCount*>(context)->allocs;
+    return malloc(size);
+  }
+
+  void counting_free(void* context, void* ptr)
+  {
+    ++static_cast<AllocCount*>(context)->frees;
+    free(ptr);
+  }
+}
+
+class LibSpincludeTest: public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    mCount = AllocCount{0, 0};
+    const spinclude_allocator allocator = {counting_alloc, counting_free, &mCount};
+    mSession = spinclude_session_new(&allocator);
+    ASSERT_NE(nullptr, mSession);
+    ASSERT_EQ(SPINCLUDE_OK, spinclude_config_add(mSession, SPINCLUDE_PROJECT_DIR,
+                                                 "test/asset/has-header-with-include"));
+  }
+
+  void TearDown()
+  {
+    spinclude_session_free(mSession);
+    EXPECT_EQ(mCount.allocs, mCount.frees);
+    remove(SNAPSHOT_PATH);
+  }
+
+  static constexpr const char* SNAPSHOT_PATH = "test/_libspinclude.snap";
+  AllocCount mCount;
+  spinclude_session* mSession;
+};
+
+TEST_F(LibSpincludeTest, TestScanSolve)
+{
+  EXPECT_EQ(SPINCLUDE_API_VERSION, spinclude_api_version());
+
+  spinclude_graph* graph = nullptr;
+  ASSERT_LE(0, spinclude_scan(mSession, &graph));
+  ASSERT_NE(nullptr, graph);
+  EXPECT_EQ(6, spinclude_graph_node_count(graph));
+
+  spinclude_cycles* cycles = nullptr;
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_solve(graph, &cycles));
+  ASSERT_EQ(1, cycles->count);
+  ASSERT_EQ(3, cycles->cycles[0].count);
+  EXPECT_STREQ("1file1.hpp", cycles->cycles[0].items[0]);
+  EXPECT_STREQ("file1.hpp", cycles->cycles[0].items[2]);
+  spinclude_result_free(mSession, cycles);
+  spinclude_graph_free(graph);
+
+  // Warm rescan with a new exclude breaks the circle
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_config_add(mSession, SPINCLUDE_EXCLUDE_FILE, "1file2.hpp"));
+  ASSERT_LE(0, spinclude_scan(mSession, &graph));
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_solve(graph, &cycles));
+  EXPECT_EQ(0, cycles->count);
+  spinclude_result_free(mSession, cycles);
+  spinclude_graph_free(graph);
+}
+
+TEST_F(LibSpincludeTest, TestQueries)
+{
+  spinclude_graph* graph = nullptr;
+  ASSERT_LE(0, spinclude_scan(mSession, &graph));
+
+  EXPECT_EQ(1, spinclude_query_includes(graph, "file1.hpp", "1file2.hpp"));
+  EXPECT_EQ(SPINCLUDE_ERR_NOT_FOUND, spinclude_query_includes(graph, "file1.hpp", "none.h"));
+
+  spinclude_list* list = nullptr;
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_query_closure(graph, "file1.hpp", &list));
+  EXPECT_LE(2, list->count);
+  spinclude_result_free(mSession, list);
+
+  const char* files[] = {"1file1.hpp", "not-exist.h"};
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_query_impact(graph, files, 2, &list));
+  EXPECT_LE(2, list->count);
+  spinclude_result_free(mSession, list);
+
+  spinclude_graph_free(graph);
+}
+
+TEST_F(LibSpincludeTest, TestSnapshot)
+{
+  spinclude_graph* graph = nullptr;
+  ASSERT_LE(0, spinclude_scan(mSession, &graph));
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_snapshot_save(graph, SNAPSHOT_PATH, 1));
+
+  spinclude_graph* loaded = nullptr;
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_snapshot_load(mSession, SNAPSHOT_PATH, &loaded));
+  EXPECT_EQ(spinclude_graph_node_count(graph), spinclude_graph_node_count(loaded));
+  EXPECT_EQ(spinclude_graph_edge_count(graph), spinclude_graph_edge_count(loaded));
+
+  spinclude_cycles* cycles = nullptr;
+  ASSERT_EQ(SPINCLUDE_OK, spinclude_solve(loaded, &cycles));
+  EXPECT_EQ(1, cycles->count);
+  spinclude_result_free(mSession, cycles);
+  spinclude_graph_free(loaded);
+  spinclude_graph_free(graph);
+
+  EXPECT_EQ(SPINCLUDE_ERR_IO, spinclude_snapshot_load(mSession, "test/_not_exist.snap", &loaded));
+  EXPECT_EQ(nullptr, loaded);
+}
+
+TEST_F(LibSpincludeTest, TestBadArgs)
+{
+  spinclude_graph* graph = nullptr;
+  EXPECT_EQ(SPINCLUDE_ERR_ARG, spinclude_scan(nullptr, &graph));
+  EXPECT_EQ(SPINCLUDE_ERR_ARG, spinclude_config_add(mSession, SPINCLUDE_PROJECT_DIR, nullptr));
+  EXPECT_EQ(SPINCLUDE_ERR_ARG, spinclude_config_add(mSession, (spinclude_key)42, "x"));
+  EXPECT_EQ(SPINCLUDE_ERR_PARSE, spinclude_config_load(mSession, "test/_not_exist.cfg"));
+  EXPECT_EQ(SPINCLUDE_ERR_ARG, spinclude_solve(nullptr, nullptr));
+
+  const spinclude_allocator noFree = {counting_alloc, nullptr, &mCount};
+  EXPECT_EQ(nullptr, spinclude_session_new(&noFree));
+}